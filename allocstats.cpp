@@ -0,0 +1,260 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        allocstats.cpp
+// Purpose:     Counting memory allocations for benchmarks
+// Author:      PB
+// Created:     2024-01-18
+// Copyright:   (c) 2024 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#if defined(_WIN32)
+    #include <malloc.h>
+#elif defined(__APPLE__)
+    #include <malloc/malloc.h>
+#else
+    #include <malloc.h>
+#endif
+
+#include <lunasvg.h>
+
+#include "allocstats.h"
+
+namespace {
+
+// the innermost collector in this thread, if any
+thread_local AllocStatsCollector* gs_currentCollector = nullptr;
+
+// the blocks are allocated without any header, as they can be freed
+// by the allocation functions of another module (e.g., a DLL on MSW);
+// the size of the block can be larger than the size requested
+std::size_t GetBlockSize(void* ptr)
+{
+#if defined(_WIN32)
+    return _msize(ptr);
+#elif defined(__APPLE__)
+    return malloc_size(ptr);
+#else
+    return malloc_usable_size(ptr);
+#endif
+}
+
+// LunaSVG rasterizer must use the counting functions from its very first allocation
+struct RenderMemoryFunctionsSetter
+{
+    RenderMemoryFunctionsSetter()
+    {
+        lunasvg::setRenderMemoryFunctions(AllocStatsCollector::Allocate,
+                                          AllocStatsCollector::Reallocate,
+                                          AllocStatsCollector::Free);
+    }
+} gs_renderMemoryFunctionsSetter;
+
+} // anonymous namespace
+
+// ============================================================================
+// AllocStatsCollector
+// ============================================================================
+
+AllocStatsCollector::AllocStatsCollector()
+    : m_previous(gs_currentCollector)
+{
+    gs_currentCollector = this;
+}
+
+AllocStatsCollector::~AllocStatsCollector()
+{
+    gs_currentCollector = m_previous;
+}
+
+AllocStats AllocStatsCollector::GetStats() const
+{
+    AllocStats stats;
+
+    stats.count = m_count;
+    stats.bytes = m_bytes;
+    stats.peakLive = static_cast<std::uint64_t>(std::max<std::int64_t>(m_peak - m_liveAtReset, 0));
+    return stats;
+}
+
+void AllocStatsCollector::Reset()
+{
+    m_count = 0;
+    m_bytes = 0;
+    m_peak = m_live;
+    m_liveAtReset = m_live;
+}
+
+AllocStatsCollector* AllocStatsCollector::GetCurrent()
+{
+    return gs_currentCollector;
+}
+
+void* AllocStatsCollector::Allocate(std::size_t size)
+{
+    // a zero-size allocation must still return a unique pointer
+    void* ptr = std::malloc(size ? size : 1);
+
+    if ( !ptr )
+        return nullptr;
+
+    if ( AllocStatsCollector* collector = gs_currentCollector )
+    {
+        collector->m_count++;
+        collector->m_bytes += size;
+        collector->m_live += static_cast<std::int64_t>(GetBlockSize(ptr));
+        collector->m_peak = std::max(collector->m_peak, collector->m_live);
+    }
+
+    return ptr;
+}
+
+void* AllocStatsCollector::Reallocate(void* ptr, std::size_t size)
+{
+    if ( !ptr )
+        return Allocate(size);
+
+    AllocStatsCollector* collector = gs_currentCollector;
+    const std::size_t    oldBlockSize = collector ? GetBlockSize(ptr) : 0;
+    void*                newPtr = std::realloc(ptr, size ? size : 1);
+
+    if ( !newPtr )
+        return nullptr;
+
+    if ( collector )
+    {
+        collector->m_count++;
+        collector->m_bytes += size;
+        collector->m_live += static_cast<std::int64_t>(GetBlockSize(newPtr)) - static_cast<std::int64_t>(oldBlockSize);
+        collector->m_peak = std::max(collector->m_peak, collector->m_live);
+    }
+
+    return newPtr;
+}
+
+void AllocStatsCollector::Free(void* ptr)
+{
+    if ( !ptr )
+        return;
+
+    if ( AllocStatsCollector* collector = gs_currentCollector )
+        collector->m_live -= static_cast<std::int64_t>(GetBlockSize(ptr));
+
+    std::free(ptr);
+}
+
+// ============================================================================
+// AllocStatsScope
+// ============================================================================
+
+AllocStatsScope::AllocStatsScope()
+    : m_collector(gs_currentCollector)
+{
+    if ( m_collector )
+    {
+        m_count = m_collector->m_count;
+        m_bytes = m_collector->m_bytes;
+        m_live = m_collector->m_live;
+        m_previousPeak = m_collector->m_peak;
+
+        m_collector->m_peak = m_collector->m_live;
+    }
+}
+
+AllocStatsScope::~AllocStatsScope()
+{
+    if ( m_collector )
+        m_collector->m_peak = std::max(m_collector->m_peak, m_previousPeak);
+}
+
+AllocStats AllocStatsScope::GetStats() const
+{
+    AllocStats stats;
+
+    if ( m_collector )
+    {
+        stats.count = m_collector->m_count - m_count;
+        stats.bytes = m_collector->m_bytes - m_bytes;
+        stats.peakLive = static_cast<std::uint64_t>(std::max<std::int64_t>(m_collector->m_peak - m_live, 0));
+    }
+
+    return stats;
+}
+
+// ============================================================================
+// replaced global allocation functions
+// ============================================================================
+
+// the sized deallocation functions are replaced too, as the compiler may call
+// them instead of the unsized ones; the aligned versions are not replaced, they
+// use their own matching allocation functions
+
+void* operator new(std::size_t size)
+{
+    for ( ;; )
+    {
+        if ( void* ptr = AllocStatsCollector::Allocate(size) )
+            return ptr;
+
+        std::new_handler handler = std::get_new_handler();
+
+        if ( !handler )
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    try
+    {
+        return operator new(size);
+    }
+    catch ( ... )
+    {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return operator new(size, std::nothrow);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    AllocStatsCollector::Free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    AllocStatsCollector::Free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    AllocStatsCollector::Free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    AllocStatsCollector::Free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    AllocStatsCollector::Free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    AllocStatsCollector::Free(ptr);
+}
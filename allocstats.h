@@ -0,0 +1,103 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        allocstats.h
+// Purpose:     Counting memory allocations for benchmarks
+// Author:      PB
+// Created:     2024-01-18
+// Copyright:   (c) 2024 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef ALLOCSTATS_H_DEFINED
+#define ALLOCSTATS_H_DEFINED
+
+#include <cstddef>
+#include <cstdint>
+
+// Does not depend on wxWidgets so that it can be used also by svgbenchcli
+
+struct AllocStats
+{
+    std::uint64_t count{0};    // number of allocations, including reallocations
+    std::uint64_t bytes{0};    // bytes requested by the allocations
+    std::uint64_t peakLive{0}; // maximum bytes allocated and not yet freed at the same time
+};
+
+/*
+    While an instance exists, the memory allocated in the thread which created
+    the instance is counted by it. When instances are nested, only the innermost
+    one counts.
+
+    Counted are allocations made by C++ operator new and by the LunaSVG
+    rasterizer (plutovg) with malloc and realloc. This is done by replacing
+    the global operator new and delete and setting the LunaSVG render memory
+    functions, just by linking allocstats.cpp to the executable. Memory
+    allocated by other C code (e.g., NanoSVG or native toolkit libraries)
+    is not counted.
+
+    The live bytes are the sizes of the heap blocks, which can be larger than
+    the sizes requested. Any memory freed in the thread while the instance
+    exists decreases them, including the memory allocated before, memory
+    freed in another thread is still considered live.
+
+    The blocks have no header, so that the memory allocated in one module
+    and freed in another (e.g., wxWidgets DLLs) is freed correctly. When no
+    instance exists, the cost is just checking a thread-local pointer.
+*/
+class AllocStatsCollector
+{
+public:
+    AllocStatsCollector();
+    ~AllocStatsCollector();
+
+    // peakLive is relative to the bytes live when the instance was created or reset
+    AllocStats GetStats() const;
+    void Reset();
+
+    // returns the innermost instance in the current thread or nullptr
+    static AllocStatsCollector* GetCurrent();
+
+    // used by the replaced allocation functions
+    static void* Allocate(std::size_t size);
+    static void* Reallocate(void* ptr, std::size_t size);
+    static void  Free(void* ptr);
+
+private:
+    std::uint64_t        m_count{0};
+    std::uint64_t        m_bytes{0};
+    std::int64_t         m_live{0};
+    std::int64_t         m_peak{0};
+    std::int64_t         m_liveAtReset{0};
+    AllocStatsCollector* m_previous;
+
+    friend class AllocStatsScope;
+
+    AllocStatsCollector(const AllocStatsCollector&) = delete;
+    AllocStatsCollector& operator=(const AllocStatsCollector&) = delete;
+};
+
+/*
+    Measures the allocations counted by the current thread's AllocStatsCollector
+    during its lifetime, peakLive is relative to the bytes live when the scope
+    was created. Scopes can be nested. When there is no collector, all stats
+    are zero.
+*/
+class AllocStatsScope
+{
+public:
+    AllocStatsScope();
+    ~AllocStatsScope();
+
+    AllocStats GetStats() const;
+
+private:
+    AllocStatsCollector* const m_collector;
+    std::uint64_t              m_count{0};
+    std::uint64_t              m_bytes{0};
+    std::int64_t               m_live{0};
+    std::int64_t               m_previousPeak{0};
+
+    AllocStatsScope(const AllocStatsScope&) = delete;
+    AllocStatsScope& operator=(const AllocStatsScope&) = delete;
+};
+
+#endif // #ifndef ALLOCSTATS_H_DEFINED
@@ -0,0 +1,272 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        benchhistory.cpp
+// Purpose:     History of benchmark results stored in a local file
+// Author:      PB
+// Created:     2024-01-18
+// Copyright:   (c) 2024 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+#include <wx/stdpaths.h>
+#include <wx/textfile.h>
+#include <wx/utils.h>
+
+#if defined(__WINDOWS__)
+    #include <wx/msw/registry.h>
+#elif defined(__DARWIN__)
+    #include <sys/sysctl.h>
+#endif
+
+#include <fstream>
+#include <string>
+
+#include <lunasvg.h>
+
+#include "benchhistory.h"
+
+// the first line of the file, version 1 had NanoSVG and LunaSVG
+// results on one line and its files are not read
+static const char HistorySignature[] = "wxTestSVG2 benchmark history 2";
+
+// the first field of the line with a run, the lines with its results follow
+static const char RunLineType[] = "run";
+static const char ResultLineType[] = "result";
+
+static const size_t RunFieldCount = 10;
+static const size_t ResultFieldCount = 7;
+
+// the values must not break the tab-separated lines
+static wxString SanitizeField(const wxString& value)
+{
+    wxString result(value);
+
+    result.Replace("\t", " ");
+    result.Replace("\r", " ");
+    result.Replace("\n", " ");
+
+    return result;
+}
+
+static wxString GetCPUModel()
+{
+#if defined(__WINDOWS__)
+    wxRegKey key(wxRegKey::HKLM, "HARDWARE\\DESCRIPTION\\System\\CentralProcessor\\0");
+    wxString name;
+
+    if ( key.Exists() && key.QueryValue("ProcessorNameString", name) && !name.Strip(wxString::both).empty() )
+        return name.Strip(wxString::both);
+#elif defined(__LINUX__)
+    // /proc files do not report their size, so wxTextFile cannot read them
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string   line;
+
+    while ( std::getline(cpuinfo, line) )
+    {
+        const size_t colon = line.find(':');
+
+        if ( line.compare(0, 10, "model name") == 0 && colon != std::string::npos )
+            return wxString::FromUTF8(line.substr(colon + 1).c_str()).Strip(wxString::both);
+    }
+#elif defined(__DARWIN__)
+    char   name[256];
+    size_t length = sizeof(name);
+
+    if ( sysctlbyname("machdep.cpu.brand_string", name, &length, nullptr, 0) == 0 )
+        return wxString::FromUTF8(name);
+#endif
+
+    return wxGetCpuArchitectureName();
+}
+
+// ============================================================================
+// wxTestSVGBenchmarkHistory
+// ============================================================================
+
+wxTestSVGBenchmarkHistory::Environment wxTestSVGBenchmarkHistory::Environment::GetCurrent()
+{
+    Environment environment;
+
+    environment.lunasvgVersion.Printf("%d.%d.%d", LUNASVG_VERSION_MAJOR, LUNASVG_VERSION_MINOR, LUNASVG_VERSION_MICRO);
+    environment.wxWidgetsVersion = wxVERSION_NUM_DOT_STRING;
+
+#if defined(__clang__)
+    environment.compiler = "clang " __clang_version__;
+#elif defined(_MSC_FULL_VER)
+    environment.compiler.Printf("MSVC %d", _MSC_FULL_VER);
+#elif defined(__GNUC__)
+    environment.compiler = "GCC " __VERSION__;
+#else
+    environment.compiler = "unknown";
+#endif
+
+    // both are set by CMake
+#ifdef WXTESTSVG2_BUILD_FLAGS
+    environment.buildFlags = wxString(WXTESTSVG2_BUILD_FLAGS).Strip(wxString::both);
+#elif defined(NDEBUG)
+    environment.buildFlags = "NDEBUG";
+#else
+    environment.buildFlags = "debug";
+#endif
+
+#ifdef WXTESTSVG2_GIT_COMMIT
+    environment.gitCommit = WXTESTSVG2_GIT_COMMIT;
+#endif
+
+    environment.cpu = GetCPUModel();
+
+    return environment;
+}
+
+wxString wxTestSVGBenchmarkHistory::GetDefaultFileName()
+{
+    const wxString dir = wxStandardPaths::Get().GetUserDataDir();
+
+    if ( !wxDirExists(dir) )
+        wxFileName::Mkdir(dir, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+
+    return wxFileName(dir, "benchmark-history.txt").GetFullPath();
+}
+
+bool wxTestSVGBenchmarkHistory::Load(const wxString& fileName, const wxString& dirName)
+{
+    m_runs.clear();
+
+    if ( !wxFileExists(fileName) )
+        return true;
+
+    wxTextFile file;
+
+    if ( !file.Open(fileName, wxConvUTF8) )
+        return false;
+
+    if ( file.GetLineCount() == 0 )
+        return true;
+
+    // e.g., written by an older version, which is kept for the user
+    if ( file.GetFirstLine() != HistorySignature )
+    {
+        file.Close();
+        return MoveAside(fileName);
+    }
+
+    // the results of the runs of the other folders are skipped
+    bool isRunLoaded = false;
+
+    for ( size_t i = 1; i < file.GetLineCount(); ++i )
+    {
+        const wxArrayString fields = wxSplit(file[i], '\t', '\0');
+
+        if ( fields.empty() )
+            continue;
+
+        if ( fields[0] == RunLineType && fields.size() == RunFieldCount )
+        {
+            Run           run;
+            unsigned long runCount = 0;
+
+            isRunLoaded = false;
+            if ( !fields[2].IsSameAs(dirName, wxFileName::IsCaseSensitive()) )
+                continue;
+
+            if ( !run.time.ParseISOCombined(fields[1], ' ') || !fields[3].ToULong(&runCount) )
+                return false;
+
+            run.dirName                      = fields[2];
+            run.runCount                     = runCount;
+            run.environment.lunasvgVersion   = fields[4];
+            run.environment.wxWidgetsVersion = fields[5];
+            run.environment.compiler         = fields[6];
+            run.environment.buildFlags       = fields[7];
+            run.environment.cpu              = fields[8];
+            run.environment.gitCommit        = fields[9];
+
+            m_runs.push_back(run);
+            isRunLoaded = true;
+        }
+        else if ( fields[0] == ResultLineType && fields.size() == ResultFieldCount )
+        {
+            if ( !isRunLoaded )
+                continue;
+
+            Result result;
+            long   width = 0, height = 0;
+
+            result.mode = fields[1];
+            result.backend = fields[2];
+            result.fileName = fields[3];
+            if ( !fields[4].ToLong(&width) || !fields[5].ToLong(&height)
+                 || !fields[6].ToCDouble(&result.median) )
+            {
+                return false;
+            }
+            result.size.Set(width, height);
+
+            m_runs.back().results.push_back(result);
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool wxTestSVGBenchmarkHistory::MoveAside(const wxString& fileName)
+{
+    const wxString newFileName = wxString::Format("%s.%s.old", fileName, wxDateTime::Now().Format("%Y%m%d-%H%M%S"));
+
+    if ( !wxRenameFile(fileName, newFileName, false) )
+        return false;
+
+    wxLogWarning("The benchmark history file '%s' has an unsupported format, it was renamed to '%s' and a new one will be started.",
+                 fileName, newFileName);
+    return true;
+}
+
+bool wxTestSVGBenchmarkHistory::Append(const wxString& fileName, const Run& run)
+{
+    const bool isNew = !wxFileExists(fileName) || wxFileName::GetSize(fileName) == 0;
+    wxFFile    file(fileName, "a");
+    wxString   lines;
+
+    if ( !file.IsOpened() )
+        return false;
+
+    if ( isNew )
+        lines << HistorySignature << "\n";
+
+    lines << RunLineType
+          << "\t" << run.time.FormatISOCombined(' ')
+          << "\t" << SanitizeField(run.dirName)
+          << "\t" << run.runCount
+          << "\t" << SanitizeField(run.environment.lunasvgVersion)
+          << "\t" << SanitizeField(run.environment.wxWidgetsVersion)
+          << "\t" << SanitizeField(run.environment.compiler)
+          << "\t" << SanitizeField(run.environment.buildFlags)
+          << "\t" << SanitizeField(run.environment.cpu)
+          << "\t" << SanitizeField(run.environment.gitCommit)
+          << "\n";
+
+    // the numbers must not depend on the locale
+    for ( const auto& r : run.results )
+    {
+        lines << ResultLineType
+              << "\t" << r.mode
+              << "\t" << SanitizeField(r.backend)
+              << "\t" << SanitizeField(r.fileName)
+              << "\t" << r.size.x
+              << "\t" << r.size.y
+              << "\t" << wxString::FromCDouble(r.median, 1)
+              << "\n";
+    }
+
+    if ( !file.Write(lines, wxConvUTF8) || !file.Close() )
+        return false;
+
+    m_runs.push_back(run);
+
+    return true;
+}
@@ -0,0 +1,83 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        benchhistory.h
+// Purpose:     History of benchmark results stored in a local file
+// Author:      PB
+// Created:     2024-01-18
+// Copyright:   (c) 2024 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TEST_SVG_BENCH_HISTORY_H_DEFINED
+#define TEST_SVG_BENCH_HISTORY_H_DEFINED
+
+#include <vector>
+
+#include <wx/wx.h>
+#include <wx/datetime.h>
+
+// ============================================================================
+// wxTestSVGBenchmarkHistory
+// ============================================================================
+
+/*
+    Every benchmark run which was not stopped is appended to a tab-separated
+    text file, with the medians of all its files and sizes and the information
+    about the build and machine it ran on, so that the results of many runs
+    can be compared to find slow regressions.
+*/
+class wxTestSVGBenchmarkHistory
+{
+public:
+    // the build and the machine a run was benchmarked with
+    struct Environment
+    {
+        wxString lunasvgVersion;
+        wxString wxWidgetsVersion;
+        wxString compiler;
+        wxString buildFlags;
+        wxString cpu;
+        wxString gitCommit; // of the source tree when CMake was run, may be empty
+
+        static Environment GetCurrent();
+    };
+
+    // median in nanoseconds for one file and size in one mode with one backend
+    struct Result
+    {
+        wxString mode;     // not localized, see wxTestSVGRasterizationBenchmark::GetModeKey()
+        wxString backend;  // wxTestSVGRasterizationBenchmark::Backend::name
+        wxString fileName;
+        wxSize   size;
+        double   median{0};
+    };
+
+    struct Run
+    {
+        wxDateTime          time;
+        wxString            dirName;
+        size_t              runCount{0};
+        Environment         environment;
+        std::vector<Result> results;
+    };
+
+    // in the user data folder, which is created if needed
+    static wxString GetDefaultFileName();
+
+    // loads the runs of the folder in the order they were appended,
+    // returns true also when the file does not exist yet; a file in
+    // another format is renamed, so that Append() starts a new one
+    bool Load(const wxString& fileName, const wxString& dirName);
+
+    const std::vector<Run>& GetRuns() const { return m_runs; }
+
+    // appends the run to the file and the loaded runs, creates the file
+    // if it does not exist yet
+    bool Append(const wxString& fileName, const Run& run);
+
+private:
+    std::vector<Run> m_runs;
+
+    static bool MoveAside(const wxString& fileName);
+};
+
+#endif // #ifndef TEST_SVG_BENCH_HISTORY_H_DEFINED
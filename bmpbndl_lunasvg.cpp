@@ -8,8 +8,11 @@
 /////////////////////////////////////////////////////////////////////////////
 
 
+#include <wx/app.h>
 #include <wx/bmpbndl.h>
 #include <wx/buffer.h>
+#include <wx/display.h>
+#include <wx/image.h>
 #if wxUSE_FFILE
     #include <wx/ffile.h>
 #elif wxUSE_FILE
@@ -18,18 +21,426 @@
 #include <wx/log.h>
 #include <wx/rawbmp.h>
 #include <wx/utils.h>
+#include <wx/weakref.h>
 
-#ifdef __WXMSW__
-    #include <wx/msw/wrapwin.h>
-#endif
-
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <list>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <lunasvg.h>
 
 #include "bmpbndl_lunasvg.h"
+#include "rastercache_lunasvg.h"
 
+wxDEFINE_EVENT(wxEVT_LUNASVG_BITMAP_READY, wxLunaSVGBitmapEvent);
+
+// ============================================================================
+// phase timing
+// ============================================================================
+
+// the innermost wxLunaSVGPhaseTimesCollector in this thread, if any
+static thread_local wxLunaSVGPhaseTimesCollector* gs_phaseCollector = nullptr;
+
+wxLunaSVGPhaseTimesCollector::wxLunaSVGPhaseTimesCollector()
+    : m_previous(gs_phaseCollector)
+{
+    gs_phaseCollector = this;
+}
+
+wxLunaSVGPhaseTimesCollector::~wxLunaSVGPhaseTimesCollector()
+{
+    gs_phaseCollector = m_previous;
+}
+
+/*
+    Adds the time elapsed and the memory allocated between its creation
+    and destruction to the phase collected in the current thread, if any.
+*/
+
+class wxLunaSVGPhaseTimer
+{
+public:
+    wxLunaSVGPhaseTimer(wxLongLong_t wxLunaSVGPhaseTimes::* phase,
+                        AllocStats wxLunaSVGPhaseAllocs::* phaseAllocs)
+        : m_collector(gs_phaseCollector), m_phase(phase), m_phaseAllocs(phaseAllocs)
+    {
+        if ( m_collector )
+            m_start = std::chrono::steady_clock::now();
+    }
+
+    ~wxLunaSVGPhaseTimer()
+    {
+        if ( m_collector )
+        {
+            m_collector->m_times.*m_phase += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                std::chrono::steady_clock::now() - m_start).count();
+
+            const AllocStats allocs = m_allocScope.GetStats();
+            AllocStats&      phaseAllocs = m_collector->m_allocs.*m_phaseAllocs;
+
+            phaseAllocs.count += allocs.count;
+            phaseAllocs.bytes += allocs.bytes;
+            phaseAllocs.peakLive = wxMax(phaseAllocs.peakLive, allocs.peakLive);
+        }
+    }
+private:
+    wxLunaSVGPhaseTimesCollector* const         m_collector;
+    wxLongLong_t wxLunaSVGPhaseTimes::* const   m_phase;
+    AllocStats wxLunaSVGPhaseAllocs::* const    m_phaseAllocs;
+    std::chrono::steady_clock::time_point       m_start;
+    AllocStatsScope                             m_allocScope;
+
+    wxDECLARE_NO_COPY_CLASS(wxLunaSVGPhaseTimer);
+};
+
+// ============================================================================
+// wxLunaSVGDocumentCache
+// ============================================================================
+
+/*
+    Process-wide cache of parsed SVG documents, so that the same SVG data used
+    by several bundles is parsed only once. The documents are never modified
+    after they are loaded and are shared by all the bundles created from the
+    same data, a document is freed when the last bundle using it is destroyed.
+
+    The documents are keyed by the hash of the data, the data are compared
+    as well so that a hash collision cannot result in a wrong document.
+*/
+
+class wxLunaSVGDocumentCache
+{
+public:
+    using DocumentPtr = std::shared_ptr<const lunasvg::Document>;
+
+    // data can be SVG or compiled LunaSVG document, returns nullptr
+    // if data could not be parsed, len is data length in bytes
+    static DocumentPtr Get(const char* data, size_t len);
+
+private:
+    struct Entry
+    {
+        std::string                             data;
+        const lunasvg::Document*                document;
+        std::weak_ptr<const lunasvg::Document>  documentRef;
+    };
+    using EntryMap = std::unordered_multimap<std::uint64_t, Entry>;
+
+    static std::mutex& GetMutex();
+    static EntryMap&   GetEntries();
+
+    static std::uint64_t HashData(const char* data, size_t len);
+
+    static std::unique_ptr<lunasvg::Document> Load(const char* data, size_t len);
+
+    // must be called with the mutex locked
+    static DocumentPtr FindLocked(std::uint64_t hash, const char* data, size_t len);
+
+    static void Remove(std::uint64_t hash, const lunasvg::Document* document);
+};
+
+wxLunaSVGDocumentCache::DocumentPtr wxLunaSVGDocumentCache::Get(const char* data, size_t len)
+{
+    const std::uint64_t hash = HashData(data, len);
+
+    {
+        std::lock_guard<std::mutex> lock(GetMutex());
+        DocumentPtr document = FindLocked(hash, data, len);
+
+        if ( document )
+            return document;
+    }
+
+    // parse without holding the lock, so that other threads are not blocked
+    std::unique_ptr<lunasvg::Document> parsed = Load(data, len);
+
+    if ( !parsed )
+        return DocumentPtr();
+
+    const lunasvg::Document* rawDocument = parsed.get();
+    DocumentPtr document(parsed.release(),
+        [hash](const lunasvg::Document* doc)
+        {
+            Remove(hash, doc);
+            delete doc;
+        });
+
+    std::lock_guard<std::mutex> lock(GetMutex());
+
+    // another thread may have parsed the same data in the meantime,
+    // use its document and let ours be destroyed (after the lock
+    // is released, as its deleter needs to lock the mutex too)
+    DocumentPtr existing = FindLocked(hash, data, len);
+
+    if ( existing )
+        return existing;
+
+    GetEntries().emplace(hash, Entry{std::string(data, len), rawDocument, document});
+    return document;
+}
+
+std::unique_ptr<lunasvg::Document> wxLunaSVGDocumentCache::Load(const char* data, size_t len)
+{
+    if ( lunasvg::Document::isCompiled(data, len) )
+    {
+        wxLunaSVGPhaseTimer timer(&wxLunaSVGPhaseTimes::parse, &wxLunaSVGPhaseAllocs::parse);
+        return lunasvg::Document::loadFromCompiled(data, len);
+    }
+
+    std::unique_ptr<lunasvg::Document> document;
+
+    {
+        wxLunaSVGPhaseTimer timer(&wxLunaSVGPhaseTimes::parse, &wxLunaSVGPhaseAllocs::parse);
+        document = lunasvg::Document::parseFromData(data, len);
+    }
+
+    if ( document )
+    {
+        wxLunaSVGPhaseTimer timer(&wxLunaSVGPhaseTimes::layout, &wxLunaSVGPhaseAllocs::layout);
+        document->updateLayout();
+    }
+
+    return document;
+}
+
+wxLunaSVGDocumentCache::DocumentPtr wxLunaSVGDocumentCache::FindLocked(std::uint64_t hash,
+                                                                       const char* data, size_t len)
+{
+    const auto range = GetEntries().equal_range(hash);
+
+    for ( auto it = range.first; it != range.second; ++it )
+    {
+        const Entry& entry = it->second;
+
+        if ( entry.data.size() == len && memcmp(entry.data.data(), data, len) == 0 )
+        {
+            // the document may be just being destroyed, then it is skipped
+            DocumentPtr document = entry.documentRef.lock();
+
+            if ( document )
+                return document;
+        }
+    }
+
+    return DocumentPtr();
+}
+
+std::mutex& wxLunaSVGDocumentCache::GetMutex()
+{
+    // intentionally leaked, bundles may be destroyed during static destruction
+    static std::mutex* mutex = new std::mutex;
+    return *mutex;
+}
+
+wxLunaSVGDocumentCache::EntryMap& wxLunaSVGDocumentCache::GetEntries()
+{
+    // intentionally leaked, see GetMutex()
+    static EntryMap* entries = new EntryMap;
+    return *entries;
+}
+
+// 64-bit FNV-1a
+std::uint64_t wxLunaSVGDocumentCache::HashData(const char* data, size_t len)
+{
+    std::uint64_t hash = 14695981039346656037ULL;
+
+    for ( size_t i = 0; i < len; ++i )
+    {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+void wxLunaSVGDocumentCache::Remove(std::uint64_t hash, const lunasvg::Document* document)
+{
+    std::lock_guard<std::mutex> lock(GetMutex());
+    const auto range = GetEntries().equal_range(hash);
+
+    // an expired entry for the same data may have already been
+    // replaced with a new one, so the document must be compared
+    for ( auto it = range.first; it != range.second; ++it )
+    {
+        if ( it->second.document == document )
+        {
+            GetEntries().erase(it);
+            return;
+        }
+    }
+}
 
+// ============================================================================
+// helper functions
+// ============================================================================
+
+// Returns the matrix for rendering document at given size
+static lunasvg::Matrix GetRenderMatrix(const lunasvg::Document& document, const wxSize& size)
+{
+    const auto scale = wxMin(size.x/document.width(), size.y/document.height());
+
+    return lunasvg::Matrix::scaled(scale, scale);
+}
+
+// Copies pixels between bitmaps of the same size
+static void CopyPixels(const lunasvg::Bitmap& source, lunasvg::Bitmap& target)
+{
+    const size_t rowLen = static_cast<size_t>(target.width()) * 4;
+
+    for ( std::uint32_t y = 0; y < target.height(); ++y )
+    {
+        memcpy(target.data() + static_cast<size_t>(y) * target.stride(),
+               source.data() + static_cast<size_t>(y) * source.stride(), rowLen);
+    }
+}
+
+// Creates wxBitmap of given size and calls render to draw the premultiplied
+// BGRA pixels into its storage, which are then converted to wxBitmap format
+static wxBitmap CreateBitmap(const wxSize& size, const std::function<void(lunasvg::Bitmap&)>& render)
+{
+    wxBitmap bmp(size.x, size.y, 32);
+
+    {
+        wxAlphaPixelData bmpdata(bmp);
+
+        if ( !bmpdata )
+        {
+            wxLogDebug("Couldn't access raw data of wxBitmap");
+            return wxBitmap();
+        }
+
+        // LunaSVG renders directly into the wxBitmap pixel storage. The rows
+        // may be stored bottom-up (e.g., DIBs on MSW), i.e., with a negative
+        // stride. Then the memory is rendered into as if it were top-down,
+        // starting with the bottom row, and the rows are swapped afterwards.
+        const int  rowStride = bmpdata.GetRowStride();
+        const bool bottomUp  = rowStride < 0;
+        const auto width     = static_cast<std::uint32_t>(size.x);
+        const auto height    = static_cast<std::uint32_t>(size.y);
+        const auto stride    = static_cast<std::uint32_t>(bottomUp ? -rowStride : rowStride);
+        std::uint8_t* data   = bmpdata.GetPixels().m_ptr;
+
+        if ( bottomUp )
+            data -= static_cast<size_t>(stride) * (height - 1);
+
+        lunasvg::Bitmap lbmp(data, width, height, stride);
+
+        render(lbmp);
+
+        wxLunaSVGPhaseTimer timer(&wxLunaSVGPhaseTimes::convert, &wxLunaSVGPhaseAllocs::convert);
+
+        if ( bottomUp )
+        {
+            for ( std::uint32_t y = 0; y < height / 2; ++y )
+            {
+                std::uint8_t* top    = data + static_cast<size_t>(stride) * y;
+                std::uint8_t* bottom = data + static_cast<size_t>(stride) * (height - 1 - y);
+
+                std::swap_ranges(top, top + width * 4, bottom);
+            }
+        }
+
+        // LunaSVG renders premultiplied BGRA, convert it in place to the pixel
+        // format and alpha used by wxBitmap, using SIMD where available;
+        // nothing is done when wxBitmap uses premultiplied BGRA too
+#ifdef wxHAS_PREMULTIPLIED_ALPHA
+        const bool unpremultiply = false;
+#else
+        const bool unpremultiply = true;
+#endif
+        lbmp.convert(wxAlphaPixelFormat::RED, wxAlphaPixelFormat::GREEN,
+                     wxAlphaPixelFormat::BLUE, wxAlphaPixelFormat::ALPHA, unpremultiply);
+    }
+
+    return bmp;
+}
+
+// ============================================================================
+// wxLunaSVGRasterPool
+// ============================================================================
+
+/*
+    Process-wide pool of threads rasterizing LunaSVG documents in the background.
+
+    The tasks must not use any wxWidgets GDI objects, as these can be used
+    only from the main thread.
+*/
+
+class wxLunaSVGRasterPool
+{
+public:
+    using Task = std::function<void()>;
+
+    static wxLunaSVGRasterPool& Get();
+
+    void Queue(Task task);
+
+private:
+    std::mutex              m_mutex;
+    std::condition_variable m_condition;
+    std::deque<Task>        m_tasks;
+
+    wxLunaSVGRasterPool();
+
+    void WorkerLoop();
+};
+
+wxLunaSVGRasterPool& wxLunaSVGRasterPool::Get()
+{
+    // intentionally leaked, the worker threads wait for tasks until the process ends
+    static wxLunaSVGRasterPool* pool = new wxLunaSVGRasterPool;
+    return *pool;
+}
+
+wxLunaSVGRasterPool::wxLunaSVGRasterPool()
+{
+    // leave some cores for the main thread and other work
+    const unsigned threadCount = wxMax(1u, wxMin(4u, std::thread::hardware_concurrency() / 2));
+
+    for ( unsigned i = 0; i < threadCount; ++i )
+        std::thread(&wxLunaSVGRasterPool::WorkerLoop, this).detach();
+}
+
+void wxLunaSVGRasterPool::Queue(Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_condition.notify_one();
+}
+
+void wxLunaSVGRasterPool::WorkerLoop()
+{
+    for ( ;; )
+    {
+        Task task;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            m_condition.wait(lock, [this] { return !m_tasks.empty(); });
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+
+        task();
+    }
+}
+
 // ============================================================================
 // wxBitmapBundleImplLunaSVG declaration
 // ============================================================================
@@ -45,11 +456,15 @@ class wxBitmapBundleImplLunaSVG : public wxBitmapBundleImpl
 public:
     // data must be 0 terminated, wxBitmapBundleImplLunaSVG doesn't
     // take its ownership and it can be deleted after the ctor was called.
-    wxBitmapBundleImplLunaSVG(const char* data, const wxSize& sizeDef);
+    wxBitmapBundleImplLunaSVG(const char* data, const wxSize& sizeDef,
+                              const wxLunaSVGBundleOptions& options);
 
     // wxBitmapBundleImplLunaSVG doesn't take ownership of data and it
     // can be deleted after the ctor was called. len is data length in bytes.
-    wxBitmapBundleImplLunaSVG(const wxByte* data, size_t len, const wxSize& sizeDef);
+    wxBitmapBundleImplLunaSVG(const wxByte* data, size_t len, const wxSize& sizeDef,
+                              const wxLunaSVGBundleOptions& options);
+
+    ~wxBitmapBundleImplLunaSVG();
 
     virtual wxSize GetDefaultSize() const override;
     virtual wxSize GetPreferredBitmapSizeAtScale(double scale) const override;
@@ -57,25 +472,85 @@ public:
     virtual wxBitmap GetBitmap(const wxSize& size) override;
 
     bool IsOk() const;
+
+    wxLunaSVGCacheStats GetCacheStats() const;
 private:
-    std::unique_ptr<lunasvg::Document> m_svgDocument;
+    struct CacheEntry
+    {
+        wxBitmap bitmap;
+        size_t   bytes;
+    };
+    // the most recently used bitmap is at the front
+    using CacheList = std::list<CacheEntry>;
+
+    // bitmaps rasterized in the background, shared with the raster pool tasks
+    struct AsyncState
+    {
+        std::mutex mutex;
+        std::vector<std::pair<wxSize, lunasvg::Bitmap>> results; // guarded by mutex
+
+        // used only from the main thread, nullptr after the bundle was destroyed
+        wxBitmapBundleImplLunaSVG* owner{nullptr};
+    };
+
+    // shared with other bundles created from the same data
+    wxLunaSVGDocumentCache::DocumentPtr m_svgDocument;
     const wxSize m_sizeDef;
-    wxBitmap m_cachedBitmap;
+    const wxLunaSVGBundleOptions m_options;
+
+    // with the disk cache, the data are kept only until the document is parsed
+    std::shared_ptr<wxLunaSVGDiskCache> m_diskCache;
+    std::string         m_svgData;
+    wxLunaSVGDataDigest m_svgDataDigest{};
+    size_t              m_svgDataLen{0};
+    bool                m_svgDataInvalid{false}; // the postponed parsing failed
+
+    CacheList m_cache;
+    size_t    m_cacheBytes{0};
+    size_t    m_cacheHits{0};
+    size_t    m_cacheMisses{0};
+
+    std::shared_ptr<AsyncState> m_asyncState;
+    std::vector<wxSize>         m_asyncPending;
+    wxWeakRef<wxEvtHandler>     m_asyncHandler;
+
+    // returned until the bitmap of the pending size is rasterized
+    std::vector<std::pair<wxSize, wxBitmap>> m_asyncPlaceholders;
+
+    void Init(const char* data, size_t len);
+
+    // parses the document if it was not parsed yet, returns false
+    // if it could not be parsed
+    bool LoadDocument();
+
+    wxLunaSVGDiskCacheKey GetDiskCacheKey(const wxSize& size) const;
+    wxBitmap LoadFromDiskCache(const wxSize& size) const;
 
     wxBitmap DoRasterize(const wxSize& size);
 
+    void AddToCache(const wxBitmap& bitmap);
+
+    void StartAsync();
+    // returns false if the bitmap cannot be rasterized
+    bool QueueAsyncRasterize(const wxSize& size);
+    void ProcessAsyncResults();
+    wxBitmap GetPlaceholder(const wxSize& size);
+    wxBitmap CreatePlaceholder(const wxSize& size) const;
+
     wxDECLARE_NO_COPY_CLASS(wxBitmapBundleImplLunaSVG);
 };
 
 
 // Creates wxBitmapBundle from in-memory SVG using wxBitmapBundleImplLunaSVG
-wxBitmapBundle CreateWithLunaSVGFromMemory(const wxByte* data, size_t len, const wxSize& sizeDef)
+wxBitmapBundle CreateWithLunaSVGFromMemory(const wxByte* data, size_t len, const wxSize& sizeDef,
+                                           const wxLunaSVGBundleOptions& options)
 {
-    return wxBitmapBundle::FromImpl(new wxBitmapBundleImplLunaSVG(data, len, sizeDef));
+    return wxBitmapBundle::FromImpl(new wxBitmapBundleImplLunaSVG(data, len, sizeDef, options));
 }
 
 // Creates wxBitmapBundle from SVG file using wxBitmapBundleImplLunaSVG
-wxBitmapBundle CreateWithLunaSVGFromFile(const wxString& path, const wxSize& sizeDef)
+wxBitmapBundle CreateWithLunaSVGFromFile(const wxString& path, const wxSize& sizeDef,
+                                         const wxLunaSVGBundleOptions& options)
 {
 #if wxUSE_FFILE
     wxFFile file(path, "rb");
@@ -96,36 +571,95 @@ wxBitmapBundle CreateWithLunaSVGFromFile(const wxString& path, const wxSize& siz
             if ( file.Read(static_cast<char*>(buf.GetWriteBuf(len)), len) == len )
             {
                 buf.UngetWriteBuf(len);
-                return CreateWithLunaSVGFromMemory(static_cast<wxByte*>(buf.GetData()), len, sizeDef);
+                return CreateWithLunaSVGFromMemory(static_cast<wxByte*>(buf.GetData()), len, sizeDef, options);
             }
         }
     }
 
     return wxBitmapBundle();
+}
+
+// Converts SVG to the compiled LunaSVG format
+wxMemoryBuffer CompileLunaSVG(const wxByte* data, size_t len)
+{
+    wxMemoryBuffer buf;
+
+    wxCHECK(data != nullptr && len > 0, buf);
+
+    const std::unique_ptr<lunasvg::Document> document =
+        lunasvg::Document::loadFromData(reinterpret_cast<const char*>(data), len);
+
+    if ( !document )
+        return buf;
+
+    const std::string compiled = document->compile();
+
+    buf.AppendData(compiled.data(), compiled.size());
+    return buf;
 }
 
+// Retrieves cache statistics of a bundle created by CreateWithLunaSVGFrom*()
+bool GetLunaSVGCacheStats(const wxBitmapBundle& bundle, wxLunaSVGCacheStats& stats)
+{
+    const wxBitmapBundleImplLunaSVG* impl = dynamic_cast<const wxBitmapBundleImplLunaSVG*>(bundle.GetImpl());
+
+    if ( !impl )
+        return false;
+
+    stats = impl->GetCacheStats();
+    return true;
+}
+
 
 // ============================================================================
 // wxBitmapBundleImplLunaSVG implementation
 // ============================================================================
 
-wxBitmapBundleImplLunaSVG::wxBitmapBundleImplLunaSVG(const char* data, const wxSize& sizeDef)
-    : m_sizeDef(sizeDef)
+wxBitmapBundleImplLunaSVG::wxBitmapBundleImplLunaSVG(const char* data, const wxSize& sizeDef,
+                                                     const wxLunaSVGBundleOptions& options)
+    : m_sizeDef(sizeDef), m_options(options)
 {
     wxCHECK_RET(data != nullptr, "null data");
     wxCHECK_RET(sizeDef.GetWidth() > 0 && sizeDef.GetHeight() > 0, "invalid default size");
 
-    m_svgDocument = lunasvg::Document::loadFromData(data);
+    Init(data, strlen(data));
 }
 
-wxBitmapBundleImplLunaSVG::wxBitmapBundleImplLunaSVG(const wxByte* data, size_t len, const wxSize& sizeDef)
-    : m_sizeDef(sizeDef)
+wxBitmapBundleImplLunaSVG::wxBitmapBundleImplLunaSVG(const wxByte* data, size_t len, const wxSize& sizeDef,
+                                                     const wxLunaSVGBundleOptions& options)
+    : m_sizeDef(sizeDef), m_options(options)
 {
     wxCHECK_RET(data != nullptr, "null data");
     wxCHECK_RET(len > 0, "zero length");
     wxCHECK_RET(sizeDef.GetWidth() > 0 && sizeDef.GetHeight() > 0, "invalid default size");
 
-    m_svgDocument = lunasvg::Document::loadFromData(reinterpret_cast<const char*>(data), len);
+    Init(reinterpret_cast<const char*>(data), len);
+}
+
+wxBitmapBundleImplLunaSVG::~wxBitmapBundleImplLunaSVG()
+{
+    // the tasks still queued or running will find out the bundle is gone
+    if ( m_asyncState )
+        m_asyncState->owner = nullptr;
+}
+
+void wxBitmapBundleImplLunaSVG::Init(const char* data, size_t len)
+{
+    if ( m_options.diskCache && m_options.diskCache->IsOk() )
+    {
+        // postpone parsing until a bitmap not in the disk cache is needed
+        m_diskCache = m_options.diskCache;
+        m_svgData.assign(data, len);
+        m_svgDataDigest = wxLunaSVGDiskCache::DigestData(data, len);
+        m_svgDataLen = len;
+    }
+    else
+    {
+        m_svgDocument = wxLunaSVGDocumentCache::Get(data, len);
+    }
+
+    if ( m_options.async && IsOk() )
+        StartAsync();
 }
 
 wxSize wxBitmapBundleImplLunaSVG::GetDefaultSize() const
@@ -140,99 +674,388 @@ wxSize wxBitmapBundleImplLunaSVG::GetPreferredBitmapSizeAtScale(double scale) co
 
 wxBitmap wxBitmapBundleImplLunaSVG::GetBitmap(const wxSize& size)
 {
-    if ( !m_cachedBitmap.IsOk() || m_cachedBitmap.GetSize() != size )
-        m_cachedBitmap = DoRasterize(size);
+    for ( CacheList::iterator it = m_cache.begin(); it != m_cache.end(); ++it )
+    {
+        if ( it->bitmap.GetSize() == size )
+        {
+            ++m_cacheHits;
+            m_cache.splice(m_cache.begin(), m_cache, it);
+            return m_cache.front().bitmap;
+        }
+    }
 
-    return m_cachedBitmap;
+    ++m_cacheMisses;
+
+    if ( m_diskCache )
+    {
+        const wxBitmap bitmap = LoadFromDiskCache(size);
+
+        if ( bitmap.IsOk() )
+        {
+            AddToCache(bitmap);
+            return bitmap;
+        }
+    }
+
+    if ( m_asyncState )
+    {
+        // the placeholder would never be replaced
+        if ( !QueueAsyncRasterize(size) )
+            return wxBitmap();
+
+        return GetPlaceholder(size);
+    }
+
+    const wxBitmap bitmap = DoRasterize(size);
+
+    if ( bitmap.IsOk() )
+        AddToCache(bitmap);
+
+    return bitmap;
 }
 
+// with the disk cache, invalid data are found out only when the first
+// bitmap not in the cache is rasterized
 bool wxBitmapBundleImplLunaSVG::IsOk() const
 {
-    return m_svgDocument != nullptr;
+    return m_svgDocument != nullptr || (m_diskCache && !m_svgDataInvalid);
 }
 
-wxBitmap wxBitmapBundleImplLunaSVG::DoRasterize(const wxSize& size)
+wxLunaSVGCacheStats wxBitmapBundleImplLunaSVG::GetCacheStats() const
+{
+    wxLunaSVGCacheStats stats;
+
+    stats.entries = m_cache.size();
+    stats.bytes   = m_cacheBytes;
+    stats.hits    = m_cacheHits;
+    stats.misses  = m_cacheMisses;
+
+    return stats;
+}
+
+void wxBitmapBundleImplLunaSVG::AddToCache(const wxBitmap& bitmap)
+{
+    const size_t bytes = static_cast<size_t>(bitmap.GetWidth()) * bitmap.GetHeight() * 4;
+
+    m_cache.push_front({bitmap, bytes});
+    m_cacheBytes += bytes;
+
+    // the bitmap just added is never discarded, even if it alone exceeds the limits
+    while ( m_cache.size() > 1
+            && ( (m_options.cacheMaxEntries && m_cache.size() > m_options.cacheMaxEntries)
+                 || (m_options.cacheMaxBytes && m_cacheBytes > m_options.cacheMaxBytes) ) )
+    {
+        m_cacheBytes -= m_cache.back().bytes;
+        m_cache.pop_back();
+    }
+}
+
+void wxBitmapBundleImplLunaSVG::StartAsync()
 {
-    if ( IsOk() )
+    m_asyncState = std::make_shared<AsyncState>();
+    m_asyncState->owner = this;
+    m_asyncHandler = m_options.asyncHandler;
+
+    // rasterize in advance the sizes likely to be needed,
+    // except those which can be just loaded from the disk cache
+    for ( unsigned i = 0; i < wxDisplay::GetCount(); ++i )
     {
-        const auto scale = wxMin(size.x/m_svgDocument->width(), size.y/m_svgDocument->height());
-        const auto scaleMatrix = lunasvg::Matrix::scaled(scale, scale);
-        lunasvg::Bitmap lbmp(size.x, size.y);
+        const wxSize size = GetPreferredBitmapSizeAtScale(wxDisplay(i).GetScaleFactor());
+
+        if ( !m_diskCache || !m_diskCache->Contains(GetDiskCacheKey(size)) )
+            QueueAsyncRasterize(size);
+    }
+}
+
+bool wxBitmapBundleImplLunaSVG::QueueAsyncRasterize(const wxSize& size)
+{
+    if ( size.x <= 0 || size.y <= 0 )
+        return false;
+
+    if ( std::find(m_asyncPending.begin(), m_asyncPending.end(), size) != m_asyncPending.end() )
+        return true;
+
+    for ( const auto& entry : m_cache )
+    {
+        if ( entry.bitmap.GetSize() == size )
+            return true;
+    }
+
+    if ( !LoadDocument() )
+        return false;
+
+    m_asyncPending.push_back(size);
+
+    const wxLunaSVGDocumentCache::DocumentPtr document = m_svgDocument;
+    const std::weak_ptr<AsyncState> weakState = m_asyncState;
+    const std::shared_ptr<wxLunaSVGDiskCache> diskCache = m_diskCache;
+    const wxLunaSVGDiskCacheKey diskCacheKey = GetDiskCacheKey(size);
+
+    wxLunaSVGRasterPool::Get().Queue([document, weakState, diskCache, diskCacheKey, size]()
+    {
+        if ( weakState.expired() )
+            return; // the bundle was destroyed while the task was queued
+
+        lunasvg::Bitmap lbmp(size.x, size.y);
 
         lbmp.clear(0);
-        m_svgDocument->render(lbmp, scaleMatrix);
-
-        // conversion to wxBitmap is based on the code in lunasvg::Bitmap::convert()
-        if ( lbmp.valid() )
-        {
-            const auto width = lbmp.width();
-            const auto height = lbmp.height();
-            const auto stride = lbmp.stride();
-            auto rowData = lbmp.data();
-            wxBitmap bmp(width, height, 32);
-
-// Using SetDIBits() is much slower than wxAlphaPixelData loops?!
-//#ifdef __WXMSW__
-//            if ( bmp.IsDIB() && stride % sizeof(LONG) == 0 )
-//            {
-//                const HDC  hScreenDC = ::GetDC(nullptr);
-//                BITMAPINFO bitmapInfo = {0};
-//                bool       success;
-//
-//                bitmapInfo.bmiHeader.biSize        = sizeof(BITMAPINFO) - sizeof(RGBQUAD);
-//                bitmapInfo.bmiHeader.biWidth       = size.x;
-//                bitmapInfo.bmiHeader.biHeight      = 0 - size.y;
-//                bitmapInfo.bmiHeader.biPlanes      = 1;
-//                bitmapInfo.bmiHeader.biBitCount    = 32;
-//                bitmapInfo.bmiHeader.biCompression = BI_RGB;
-//
-//                success = ::SetDIBits(hScreenDC, bmp.GetHBITMAP(), 0, bmp.GetHeight(), rowData, &bitmapInfo, DIB_RGB_COLORS) > 0;
-//                ::ReleaseDC(nullptr, hScreenDC);
-//                if ( success  )
-//                {
-//                    bmp.UseAlpha();
-//                    return bmp;
-//                }
-//            }
-//#endif
-            wxAlphaPixelData bmpdata(bmp);
-            wxAlphaPixelData::Iterator dst(bmpdata);
-
-            for ( std::uint32_t y = 0; y < height; ++y )
+        document->render(lbmp, GetRenderMatrix(*document, size));
+
+        if ( diskCache )
+            diskCache->Store(diskCacheKey, lbmp);
+
+        const std::shared_ptr<AsyncState> state = weakState.lock();
+
+        if ( !state )
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->results.emplace_back(size, lbmp);
+        }
+
+        // wxBitmap can be created only in the main thread
+        if ( wxTheApp )
+        {
+            wxTheApp->CallAfter([weakState]()
             {
-                auto data = rowData;
-                dst.MoveTo(bmpdata, 0, y);
+                const std::shared_ptr<AsyncState> mainState = weakState.lock();
+
+                if ( mainState && mainState->owner )
+                    mainState->owner->ProcessAsyncResults();
+            });
+        }
+    });
+
+    return true;
+}
+
+void wxBitmapBundleImplLunaSVG::ProcessAsyncResults()
+{
+    std::vector<std::pair<wxSize, lunasvg::Bitmap>> results;
 
-                for ( std::uint32_t x = 0; x < width; ++x, ++dst )
+    {
+        std::lock_guard<std::mutex> lock(m_asyncState->mutex);
+        results.swap(m_asyncState->results);
+    }
+
+    for ( const auto& result : results )
+    {
+        const wxSize&          size = result.first;
+        const lunasvg::Bitmap& lbmpSource = result.second;
+
+        m_asyncPending.erase(std::remove(m_asyncPending.begin(), m_asyncPending.end(), size),
+                             m_asyncPending.end());
+        m_asyncPlaceholders.erase(std::remove_if(m_asyncPlaceholders.begin(), m_asyncPlaceholders.end(),
+                                                 [&size](const std::pair<wxSize, wxBitmap>& placeholder)
+                                                 {
+                                                     return placeholder.first == size;
+                                                 }),
+                                  m_asyncPlaceholders.end());
+
+        const wxBitmap bitmap = CreateBitmap(size, [&lbmpSource](lunasvg::Bitmap& lbmp)
+            {
+                CopyPixels(lbmpSource, lbmp);
+            });
+
+        if ( !bitmap.IsOk() )
+            continue;
+
+        AddToCache(bitmap);
+
+        if ( m_asyncHandler )
+            wxQueueEvent(m_asyncHandler.get(), new wxLunaSVGBitmapEvent(wxEVT_LUNASVG_BITMAP_READY, size));
+    }
+}
+
+wxBitmap wxBitmapBundleImplLunaSVG::GetPlaceholder(const wxSize& size)
+{
+    // the size may be requested on every repaint until it is rasterized
+    for ( const auto& placeholder : m_asyncPlaceholders )
+    {
+        if ( placeholder.first == size )
+            return placeholder.second;
+    }
+
+    const wxBitmap placeholder = CreatePlaceholder(size);
+
+    m_asyncPlaceholders.emplace_back(size, placeholder);
+    return placeholder;
+}
+
+wxBitmap wxBitmapBundleImplLunaSVG::CreatePlaceholder(const wxSize& size) const
+{
+    const wxBitmap* nearest = nullptr;
+    long            nearestDiff = 0;
+
+    for ( const auto& entry : m_cache )
+    {
+        const wxSize entrySize = entry.bitmap.GetSize();
+        const long   diff = std::labs(static_cast<long>(entrySize.x) * entrySize.y - static_cast<long>(size.x) * size.y);
+
+        if ( !nearest || diff < nearestDiff )
+        {
+            nearest = &entry.bitmap;
+            nearestDiff = diff;
+        }
+    }
+
+    if ( nearest )
+    {
+        wxImage image = nearest->ConvertToImage();
+
+        image.Rescale(size.x, size.y, wxIMAGE_QUALITY_BILINEAR);
+        return wxBitmap(image);
+    }
+
+    wxImage image(size);
+
+    image.SetAlpha();
+    memset(image.GetAlpha(), 0, static_cast<size_t>(size.x) * size.y);
+    return wxBitmap(image);
+}
+
+bool wxBitmapBundleImplLunaSVG::LoadDocument()
+{
+    if ( !m_svgDocument && !m_svgData.empty() )
+    {
+        m_svgDocument = wxLunaSVGDocumentCache::Get(m_svgData.data(), m_svgData.size());
+        m_svgDataInvalid = m_svgDocument == nullptr;
+        // not needed anymore, even when the data could not be parsed
+        std::string().swap(m_svgData);
+    }
+
+    return m_svgDocument != nullptr;
+}
+
+wxLunaSVGDiskCacheKey wxBitmapBundleImplLunaSVG::GetDiskCacheKey(const wxSize& size) const
+{
+    wxLunaSVGDiskCacheKey key;
+
+    key.dataDigest = m_svgDataDigest;
+    key.dataLen    = m_svgDataLen;
+    key.size       = size;
+    return key;
+}
+
+wxBitmap wxBitmapBundleImplLunaSVG::LoadFromDiskCache(const wxSize& size) const
+{
+    wxBitmap bitmap;
+
+    m_diskCache->Load(GetDiskCacheKey(size), [&bitmap, &size](const lunasvg::Bitmap& cached)
+        {
+            bitmap = CreateBitmap(size, [&cached](lunasvg::Bitmap& lbmp)
                 {
-                    auto b = data[0];
-                    auto g = data[1];
-                    auto r = data[2];
-                    auto a = data[3];
-#ifndef wxHAS_PREMULTIPLIED_ALPHA
-                    if (a != 0 )
-                    {
-                        r = (r * 255) / a;
-                        g = (g * 255) / a;
-                        b = (b * 255) / a;
-                    }
-#endif
-                    dst.Red()   = r;
-                    dst.Green() = g;
-                    dst.Blue()  = b;
-                    dst.Alpha() = a;
+                    CopyPixels(cached, lbmp);
+                });
+        });
+
+    return bitmap;
+}
+
+wxBitmap wxBitmapBundleImplLunaSVG::DoRasterize(const wxSize& size)
+{
+    if ( !LoadDocument() )
+        return wxBitmap();
+
+    const auto scaleMatrix = GetRenderMatrix(*m_svgDocument, size);
+
+    return CreateBitmap(size, [this, &scaleMatrix, &size](lunasvg::Bitmap& lbmp)
+        {
+            {
+                wxLunaSVGPhaseTimer timer(&wxLunaSVGPhaseTimes::render, &wxLunaSVGPhaseAllocs::render);
+
+                lbmp.clear(0);
+                m_svgDocument->render(lbmp, scaleMatrix);
+            }
+
+            // store the pixels before they are converted to wxBitmap format
+            if ( m_diskCache )
+                m_diskCache->Store(GetDiskCacheKey(size), lbmp);
+        });
+}
+
+// ============================================================================
+// wxLunaSVGAtlas implementation
+// ============================================================================
 
-                    data += 4;
-                }
+wxRect wxLunaSVGAtlas::GetRect(size_t index) const
+{
+    wxCHECK(index < m_rects.size(), wxRect());
+
+    return m_rects[index];
+}
 
-                rowData += stride;
-            }
+wxBitmap wxLunaSVGAtlas::GetSubBitmap(size_t index) const
+{
+    const wxRect rect = GetRect(index);
+
+    if ( !IsOk() || rect.IsEmpty() )
+        return wxBitmap();
 
-            return bmp;
+    return m_bitmap.GetSubBitmap(rect);
+}
+
+// Rasterizes all SVGs at given size into a single wxLunaSVGAtlas
+wxLunaSVGAtlas CreateLunaSVGAtlas(const std::vector<wxLunaSVGAtlasSource>& sources, const wxSize& size)
+{
+    wxLunaSVGAtlas atlas;
+
+    wxCHECK(!sources.empty(), atlas);
+    wxCHECK(size.x > 0 && size.y > 0, atlas);
+
+    // arrange the icons in a grid as close to a square as possible
+    const size_t columns = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(sources.size()))));
+    const size_t rows    = (sources.size() + columns - 1) / columns;
+
+    std::vector<wxLunaSVGDocumentCache::DocumentPtr> documents;
+
+    documents.reserve(sources.size());
+    atlas.m_rects.reserve(sources.size());
+
+    for ( size_t i = 0; i < sources.size(); ++i )
+    {
+        const wxLunaSVGAtlasSource& source = sources[i];
+        wxLunaSVGDocumentCache::DocumentPtr document;
+
+        if ( source.data && source.len )
+            document = wxLunaSVGDocumentCache::Get(reinterpret_cast<const char*>(source.data), source.len);
+
+        if ( document )
+        {
+            atlas.m_rects.push_back(wxRect(static_cast<int>(i % columns) * size.x,
+                                           static_cast<int>(i / columns) * size.y,
+                                           size.x, size.y));
         }
         else
-            wxLogDebug("invalid lunasvg::Bitmap");
+        {
+            wxLogDebug("Couldn't parse SVG at index %zu", i);
+            atlas.m_rects.push_back(wxRect());
+        }
+
+        documents.push_back(document);
     }
 
-    return wxBitmap();
-}
\ No newline at end of file
+    const wxSize atlasSize(static_cast<int>(columns) * size.x, static_cast<int>(rows) * size.y);
+
+    // all the icons are rendered into subrectangles of the same surface,
+    // which is then converted to wxBitmap format in a single pass
+    atlas.m_bitmap = CreateBitmap(atlasSize, [&](lunasvg::Bitmap& lbmp)
+        {
+            lbmp.clear(0);
+
+            for ( size_t i = 0; i < documents.size(); ++i )
+            {
+                if ( !documents[i] )
+                    continue;
+
+                const wxRect& rect = atlas.m_rects[i];
+                lunasvg::Bitmap cell(lbmp.data() + static_cast<size_t>(rect.y) * lbmp.stride() + rect.x * 4,
+                                     rect.width, rect.height, lbmp.stride());
+
+                documents[i]->render(cell, GetRenderMatrix(*documents[i], size));
+            }
+        });
+
+    return atlas;
+}
@@ -11,16 +11,187 @@
 #define BMPBNDL_LUNASVG_H_DEFINED
 
 #include <wx/types.h>
+#include <wx/bitmap.h>
+#include <wx/event.h>
+#include <wx/gdicmn.h>
 #include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "allocstats.h"
 
 class wxBitmapBundle;
-class wxSize;
+class wxMemoryBuffer;
 class wxString;
+class wxLunaSVGDiskCache;
+
+// Options affecting wxBitmapBundleImplLunaSVG created by CreateWithLunaSVGFrom*()
+struct wxLunaSVGBundleOptions
+{
+    // Maximum number of rasterized bitmaps and their total size in bytes
+    // kept by the bundle, 0 means no limit. When either limit is exceeded,
+    // the least recently used bitmaps are discarded, but the bitmap
+    // returned last is always kept.
+    size_t cacheMaxEntries{8};
+    size_t cacheMaxBytes{8 * 1024 * 1024};
+
+    // If true, bitmaps are rasterized by background threads: the sizes
+    // preferred for the scales of all displays are rasterized right after
+    // the bundle is created and GetBitmap() for a size not rasterized yet
+    // returns a placeholder (the nearest rasterized bitmap rescaled, or
+    // a transparent bitmap) and queues the rasterization. When a bitmap
+    // is ready, wxEVT_LUNASVG_BITMAP_READY is sent to asyncHandler.
+    bool          async{false};
+    wxEvtHandler* asyncHandler{nullptr};
+
+    // If set, the bitmaps are looked up in this persistent cache before they
+    // are rasterized and the rasterized ones are stored there. The SVG is
+    // then parsed only when a bitmap not in the disk cache is requested.
+    // The cache can be shared by any number of bundles.
+    std::shared_ptr<wxLunaSVGDiskCache> diskCache;
+};
+
+// Event sent when a bitmap rasterized in the background is ready,
+// a repaint will obtain the bitmap from the bundle
+class wxLunaSVGBitmapEvent : public wxEvent
+{
+public:
+    wxLunaSVGBitmapEvent(wxEventType eventType = wxEVT_NULL, const wxSize& size = wxDefaultSize)
+        : wxEvent(wxID_ANY, eventType), m_size(size)
+    {}
+
+    // size of the bitmap which is ready
+    wxSize GetSize() const { return m_size; }
+
+    wxEvent* Clone() const override { return new wxLunaSVGBitmapEvent(*this); }
+private:
+    wxSize m_size;
+};
+
+wxDECLARE_EVENT(wxEVT_LUNASVG_BITMAP_READY, wxLunaSVGBitmapEvent);
+
+// Statistics of the rasterized bitmap cache of a single bundle
+struct wxLunaSVGCacheStats
+{
+    size_t entries{0};
+    size_t bytes{0};
+    size_t hits{0};
+    size_t misses{0};
+};
+
+// Time spent in the phases of creating bitmaps with LunaSVG, in nanoseconds
+struct wxLunaSVGPhaseTimes
+{
+    wxLongLong_t parse{0};   // parsing SVG or loading compiled document
+    wxLongLong_t layout{0};  // computing the document layout
+    wxLongLong_t render{0};  // rendering the document
+    wxLongLong_t convert{0}; // converting the pixels to wxBitmap format
+};
+
+// Memory allocated in the phases of creating bitmaps with LunaSVG,
+// counted only while an AllocStatsCollector exists
+struct wxLunaSVGPhaseAllocs
+{
+    AllocStats parse;
+    AllocStats layout;
+    AllocStats render;
+    AllocStats convert;
+};
+
+/*
+    While an instance exists, the time spent in the phases of loading and
+    rasterizing SVGs by the bundles created by CreateWithLunaSVGFrom*() in the
+    thread which created the instance is added to its times. When instances
+    are nested, only the innermost one collects the times.
+
+    If an AllocStatsCollector exists in the thread too, the allocations made
+    in each phase are added to the allocations as well, with peakLive being
+    the highest peak of all the times the phase was entered.
+
+    Meant for benchmarking, when no instance exists, the cost is just checking
+    a thread-local pointer.
+*/
+class wxLunaSVGPhaseTimesCollector
+{
+public:
+    wxLunaSVGPhaseTimesCollector();
+    ~wxLunaSVGPhaseTimesCollector();
+
+    const wxLunaSVGPhaseTimes&  GetTimes() const { return m_times; }
+    const wxLunaSVGPhaseAllocs& GetAllocs() const { return m_allocs; }
 
-// Creates wxBitmapBundle from in-memory SVG using wxBitmapBundleImplLunaSVG
-wxBitmapBundle CreateWithLunaSVGFromMemory(const wxByte* data, size_t len, const wxSize& sizeDef);
+    void Reset()
+    {
+        m_times = wxLunaSVGPhaseTimes();
+        m_allocs = wxLunaSVGPhaseAllocs();
+    }
+private:
+    wxLunaSVGPhaseTimes           m_times;
+    wxLunaSVGPhaseAllocs          m_allocs;
+    wxLunaSVGPhaseTimesCollector* m_previous;
+
+    friend class wxLunaSVGPhaseTimer;
+
+    wxDECLARE_NO_COPY_CLASS(wxLunaSVGPhaseTimesCollector);
+};
+
+// Creates wxBitmapBundle from in-memory SVG using wxBitmapBundleImplLunaSVG,
+// data can also be compiled by CompileLunaSVG(), which is loaded without parsing
+wxBitmapBundle CreateWithLunaSVGFromMemory(const wxByte* data, size_t len, const wxSize& sizeDef,
+                                           const wxLunaSVGBundleOptions& options = wxLunaSVGBundleOptions());
 
 // Creates wxBitmapBundle from SVG file using wxBitmapBundleImplLunaSVG
-wxBitmapBundle CreateWithLunaSVGFromFile(const wxString& path, const wxSize& sizeDef);
+wxBitmapBundle CreateWithLunaSVGFromFile(const wxString& path, const wxSize& sizeDef,
+                                         const wxLunaSVGBundleOptions& options = wxLunaSVGBundleOptions());
+
+// Converts SVG to the compiled LunaSVG format containing the resolved
+// document layout, returns an empty buffer if data could not be parsed
+wxMemoryBuffer CompileLunaSVG(const wxByte* data, size_t len);
+
+// Retrieves cache statistics of a bundle created by CreateWithLunaSVGFrom*(),
+// returns false if the bundle was not created by them
+bool GetLunaSVGCacheStats(const wxBitmapBundle& bundle, wxLunaSVGCacheStats& stats);
+
+// In-memory SVG to be rasterized into wxLunaSVGAtlas
+struct wxLunaSVGAtlasSource
+{
+    const wxByte* data;
+    size_t        len;
+};
+
+/*
+    Many SVGs rasterized at the same size into a single bitmap, in a grid
+    in the order the SVGs were passed to CreateLunaSVGAtlas(). It is meant
+    for large sets of icons, e.g., for toolbars: there is just one bitmap
+    allocation for all of them and the icons can be drawn by blitting their
+    rectangles from the atlas bitmap.
+*/
+class wxLunaSVGAtlas
+{
+public:
+    bool IsOk() const { return m_bitmap.IsOk(); }
+
+    // bitmap with all the icons
+    const wxBitmap& GetBitmap() const { return m_bitmap; }
+
+    size_t GetCount() const { return m_rects.size(); }
+
+    // returns an empty rectangle if the SVG at index could not be parsed
+    wxRect GetRect(size_t index) const;
+
+    // returns a copy of the icon at index or an invalid bitmap
+    // if the SVG at index could not be parsed
+    wxBitmap GetSubBitmap(size_t index) const;
+
+private:
+    wxBitmap            m_bitmap;
+    std::vector<wxRect> m_rects;
+
+    friend wxLunaSVGAtlas CreateLunaSVGAtlas(const std::vector<wxLunaSVGAtlasSource>& sources,
+                                             const wxSize& size);
+};
+
+// Rasterizes all SVGs at given size into a single wxLunaSVGAtlas
+wxLunaSVGAtlas CreateLunaSVGAtlas(const std::vector<wxLunaSVGAtlasSource>& sources, const wxSize& size);
 
 #endif // #ifndef BMPBNDL_LUNASVG_H_DEFINED
\ No newline at end of file
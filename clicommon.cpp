@@ -0,0 +1,101 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        clicommon.cpp
+// Purpose:     Code shared by the command line tools
+// Author:      PB
+// Created:     2024-01-18
+// Copyright:   (c) 2024 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include <lunasvg.h>
+
+#include "clicommon.h"
+
+namespace fs = std::filesystem;
+
+bool ParseSizes(const std::string& text, std::vector<Size>& sizes)
+{
+    std::istringstream stream(text);
+    std::string        item;
+
+    sizes.clear();
+    while ( std::getline(stream, item, ',') )
+    {
+        unsigned width = 0, height = 0;
+        char     extra = 0;
+        const int count = std::sscanf(item.c_str(), "%ux%u%c", &width, &height, &extra);
+
+        if ( count == 1 )
+            height = width;
+        else if ( count != 2 )
+            return false;
+
+        if ( width == 0 || height == 0 )
+            return false;
+
+        sizes.push_back({width, height});
+    }
+
+    return !sizes.empty();
+}
+
+std::vector<fs::path> FindSVGFiles(const fs::path& dir, bool recursive)
+{
+    std::vector<fs::path> files;
+    std::error_code       ec;
+
+    const auto addFile = [&](const fs::directory_entry& entry)
+    {
+        if ( entry.is_regular_file(ec) && entry.path().extension() == ".svg" )
+            files.push_back(entry.path());
+    };
+
+    if ( recursive )
+    {
+        for ( const auto& entry : fs::recursive_directory_iterator(dir, ec) )
+            addFile(entry);
+    }
+    else
+    {
+        for ( const auto& entry : fs::directory_iterator(dir, ec) )
+            addFile(entry);
+    }
+
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+bool LoadFile(const fs::path& path, std::string& data)
+{
+    std::ifstream file(path, std::ios::binary);
+
+    if ( !file )
+        return false;
+
+    std::ostringstream stream;
+
+    stream << file.rdbuf();
+    data = stream.str();
+    return !data.empty();
+}
+
+lunasvg::Bitmap Rasterize(const lunasvg::Document& document, const Size& size)
+{
+    lunasvg::Bitmap bitmap(size.width, size.height);
+
+    if ( !bitmap.valid() )
+        return bitmap;
+
+    const double scale = std::min(size.width / document.width(), size.height / document.height());
+
+    bitmap.clear(0);
+    document.render(bitmap, lunasvg::Matrix::scaled(scale, scale));
+    bitmap.convertToRGBA();
+
+    return bitmap;
+}
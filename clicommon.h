@@ -0,0 +1,46 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        clicommon.h
+// Purpose:     Code shared by the command line tools
+// Author:      PB
+// Created:     2024-01-18
+// Copyright:   (c) 2024 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef CLICOMMON_H_DEFINED
+#define CLICOMMON_H_DEFINED
+
+// Does not depend on wxWidgets, requires C++17
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace lunasvg
+{
+    class Bitmap;
+    class Document;
+}
+
+struct Size
+{
+    std::uint32_t width{0};
+    std::uint32_t height{0};
+};
+
+// parses comma separated sizes, such as "16,24,32x16"
+bool ParseSizes(const std::string& text, std::vector<Size>& sizes);
+
+// returns the sorted paths to the files with .svg extension in dir
+std::vector<std::filesystem::path> FindSVGFiles(const std::filesystem::path& dir, bool recursive);
+
+// returns false if the file could not be read or is empty
+bool LoadFile(const std::filesystem::path& path, std::string& data);
+
+// renders document to a bitmap of the given size the same as
+// wxBitmapBundleImplLunaSVG does it, the pixels are converted
+// to straight RGBA, returns an invalid bitmap on failure
+lunasvg::Bitmap Rasterize(const lunasvg::Document& document, const Size& size);
+
+#endif // #ifndef CLICOMMON_H_DEFINED
@@ -0,0 +1,127 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        featurecosts.cpp
+// Purpose:     Attributing LunaSVG rendering time to SVG features
+// Author:      PB
+// Created:     2024-01-18
+// Copyright:   (c) 2024 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+
+#include "featurecosts.h"
+
+const char* GetFeatureName(Feature feature)
+{
+    switch ( feature )
+    {
+        case Feature_SolidFill:    return "solidFill";
+        case Feature_GradientFill: return "gradientFill";
+        case Feature_Stroke:       return "stroke";
+        case Feature_DashedStroke: return "dashedStroke";
+        case Feature_ClipPath:     return "clipPath";
+        case Feature_Mask:         return "mask";
+        case Feature_Layer:        return "layer";
+        case Feature_Pattern:      return "pattern";
+        case Feature_Marker:       return "marker";
+        case Feature_CSS:          return "css";
+        case Feature_Count:        break;
+    }
+
+    return "";
+}
+
+// returns Feature_Count if the part does not belong to any feature
+static Feature GetEventFeature(const lunasvg::RenderTraceEvent& event)
+{
+    const auto is = [&event](const char* name) { return std::strcmp(event.name, name) == 0; };
+
+    if ( is("fill") || is("stroke") )
+    {
+        if ( std::strcmp(event.paint, "pattern") == 0 )
+            return Feature_Pattern;
+        if ( is("stroke") )
+            return event.dashed ? Feature_DashedStroke : Feature_Stroke;
+        if ( std::strcmp(event.paint, "linearGradient") == 0 || std::strcmp(event.paint, "radialGradient") == 0 )
+            return Feature_GradientFill;
+        return Feature_SolidFill;
+    }
+
+    if ( is("clipPath") )
+        return Feature_ClipPath;
+    if ( is("mask") )
+        return Feature_Mask;
+    if ( is("marker") )
+        return Feature_Marker;
+    if ( is("beginGroup") || is("endGroup") )
+        return Feature_Layer;
+    if ( is("css") )
+        return Feature_CSS;
+
+    return Feature_Count;
+}
+
+FeatureCostRecorder::~FeatureCostRecorder()
+{
+    Stop();
+}
+
+bool FeatureCostRecorder::Start()
+{
+    m_stack.clear();
+    m_stack.push_back({Feature_Count, false});
+    m_last = Clock::now();
+    m_started = lunasvg::setRenderTraceFunction(OnRenderTrace, this);
+
+    return m_started;
+}
+
+void FeatureCostRecorder::Stop()
+{
+    if ( !m_started )
+        return;
+
+    lunasvg::setRenderTraceFunction(nullptr);
+    m_started = false;
+}
+
+void FeatureCostRecorder::OnEvent(const lunasvg::RenderTraceEvent& event)
+{
+    const Clock::time_point now = Clock::now();
+    const Frame&            current = m_stack.back();
+
+    if ( current.feature != Feature_Count )
+        m_times[current.feature] += std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_last).count();
+    m_last = now;
+
+    if ( !event.begin )
+    {
+        // the base frame is never removed
+        if ( m_stack.size() > 1 )
+            m_stack.pop_back();
+        return;
+    }
+
+    if ( current.container )
+    {
+        m_stack.push_back(current);
+        return;
+    }
+
+    const Feature feature = GetEventFeature(event);
+
+    if ( feature == Feature_Count )
+        m_stack.push_back({current.feature, false});
+    else
+    {
+        const bool container = feature == Feature_ClipPath || feature == Feature_Mask
+                               || feature == Feature_Pattern || feature == Feature_Marker;
+
+        m_stack.push_back({feature, container});
+    }
+}
+
+void FeatureCostRecorder::OnRenderTrace(const lunasvg::RenderTraceEvent& event, void* userData)
+{
+    static_cast<FeatureCostRecorder*>(userData)->OnEvent(event);
+}
@@ -0,0 +1,94 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        featurecosts.h
+// Purpose:     Attributing LunaSVG rendering time to SVG features
+// Author:      PB
+// Created:     2024-01-18
+// Copyright:   (c) 2024 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef FEATURECOSTS_H_DEFINED
+#define FEATURECOSTS_H_DEFINED
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include <lunasvg.h>
+
+// Does not depend on wxWidgets
+
+enum Feature
+{
+    Feature_SolidFill,    // filling with a color
+    Feature_GradientFill, // filling with a linear or radial gradient
+    Feature_Stroke,
+    Feature_DashedStroke,
+    Feature_ClipPath,     // rendering and applying clip paths
+    Feature_Mask,         // rendering and applying masks
+    Feature_Layer,        // creating and compositing group layers, e.g., for group opacity
+    Feature_Pattern,      // filling or stroking with a pattern, including rendering its tile
+    Feature_Marker,
+    Feature_CSS,          // parsing style sheets and style attributes, applying style sheet rules
+
+    Feature_Count
+};
+
+// returns a name of the feature suitable for JSON and CSV, e.g., "gradientFill"
+const char* GetFeatureName(Feature feature);
+
+// nanoseconds for each feature
+using FeatureTimes = std::array<std::int64_t, Feature_Count>;
+
+/*
+    Attributes the time LunaSVG spends loading and rendering documents
+    between Start() and Stop() to features, using the render trace hooks.
+
+    The time is attributed to the innermost traced part which belongs to
+    a feature, except that everything done for a clip path, mask, pattern
+    or marker is attributed to it, e.g., filling the shapes of a clip path
+    is counted as the clip path and not as a solid fill. The time which
+    does not belong to any feature (parsing, layout, traversing elements,
+    converting pixels) is not attributed.
+
+    Only one instance can be started at a time and it must not be started
+    while documents are loaded or rendered from other threads.
+*/
+class FeatureCostRecorder
+{
+public:
+    FeatureCostRecorder() = default;
+    ~FeatureCostRecorder();
+
+    // returns false if LunaSVG was built without the trace hooks
+    bool Start();
+    void Stop();
+
+    // the times are accumulated until reset
+    void Reset() { m_times = FeatureTimes(); }
+    const FeatureTimes& GetTimes() const { return m_times; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Frame
+    {
+        Feature feature;   // Feature_Count if none
+        bool    container; // the nested parts belong to the feature as well
+    };
+
+    std::vector<Frame> m_stack;
+    FeatureTimes       m_times{};
+    Clock::time_point  m_last;
+    bool               m_started{false};
+
+    void OnEvent(const lunasvg::RenderTraceEvent& event);
+
+    static void OnRenderTrace(const lunasvg::RenderTraceEvent& event, void* userData);
+
+    FeatureCostRecorder(const FeatureCostRecorder&) = delete;
+    FeatureCostRecorder& operator=(const FeatureCostRecorder&) = delete;
+};
+
+#endif // #ifndef FEATURECOSTS_H_DEFINED
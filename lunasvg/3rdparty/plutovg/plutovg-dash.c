@@ -7,9 +7,9 @@ plutovg_dash_t* plutovg_dash_create(double offset, const double* data, int size)
     if(data==NULL || size==0)
         return NULL;
 
-    plutovg_dash_t* dash = malloc(sizeof(plutovg_dash_t));
+    plutovg_dash_t* dash = plutovg_malloc(sizeof(plutovg_dash_t));
     dash->offset = offset;
-    dash->data = malloc((size_t)size * sizeof(double));
+    dash->data = plutovg_malloc((size_t)size * sizeof(double));
     dash->size = size;
     memcpy(dash->data, data, (size_t)size * sizeof(double));
     return dash;
@@ -28,8 +28,8 @@ void plutovg_dash_destroy(plutovg_dash_t* dash)
     if(dash==NULL)
         return;
 
-    free(dash->data);
-    free(dash);
+    plutovg_free(dash->data);
+    plutovg_free(dash);
 }
 
 plutovg_path_t* plutovg_dash_path(const plutovg_dash_t* dash, const plutovg_path_t* path)
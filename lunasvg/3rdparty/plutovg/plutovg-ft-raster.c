@@ -57,6 +57,7 @@
 
 #include "plutovg-ft-raster.h"
 #include "plutovg-ft-math.h"
+#include "plutovg.h"
 
 #define PVG_FT_BEGIN_STMNT  do {
 #define PVG_FT_END_STMNT    } while ( 0 )
@@ -1623,9 +1624,9 @@ PVG_FT_END_STMNT
               rendered_spans += -worker.skip_spans;
           worker.skip_spans = rendered_spans;
           length *= 2;
-          void* heap = malloc((size_t)(length));
+          void* heap = plutovg_malloc((size_t)(length));
           error = gray_raster_render(&worker, heap, length, params);
-          free(heap);
+          plutovg_free(heap);
       }
   }
 
@@ -165,7 +165,7 @@ void plutovg_matrix_map_rect(const plutovg_matrix_t* matrix, const plutovg_rect_
 
 plutovg_path_t* plutovg_path_create(void)
 {
-    plutovg_path_t* path = malloc(sizeof(plutovg_path_t));
+    plutovg_path_t* path = plutovg_malloc(sizeof(plutovg_path_t));
     path->ref = 1;
     path->contours = 0;
     path->start.x = 0.0;
@@ -188,9 +188,9 @@ void plutovg_path_destroy(plutovg_path_t* path)
 
     if(--path->ref==0)
     {
-        free(path->elements.data);
-        free(path->points.data);
-        free(path);
+        plutovg_free(path->elements.data);
+        plutovg_free(path->points.data);
+        plutovg_free(path);
     }
 }
 
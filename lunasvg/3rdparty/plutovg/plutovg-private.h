@@ -187,12 +187,12 @@ do { \
             int capacity = array.size + count; \
             int newcapacity = array.capacity == 0 ? 8 : array.capacity; \
             while(newcapacity < capacity) { newcapacity *= 2; } \
-            array.data = realloc(array.data, newcapacity * sizeof(array.data[0])); \
+            array.data = plutovg_realloc(array.data, newcapacity * sizeof(array.data[0])); \
             array.capacity = newcapacity; \
     } \
 } while(0)
 
 #define plutovg_array_clear(array) (array.size = 0)
-#define plutovg_array_destroy(array) free(array.data)
+#define plutovg_array_destroy(array) plutovg_free(array.data)
 
 #endif // PLUTOVG_PRIVATE_H
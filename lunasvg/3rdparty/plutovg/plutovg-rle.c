@@ -15,7 +15,7 @@ static void ft_outline_init(PVG_FT_Outline* outline, plutovg_t* pluto, int point
     size_t size_d = ALIGN_SIZE(contours * sizeof(char));
     size_t size_n = size_a + size_b + size_c + size_d;
     if(size_n > pluto->outline_size) {
-        pluto->outline_data = realloc(pluto->outline_data, size_n);
+        pluto->outline_data = plutovg_realloc(pluto->outline_data, size_n);
         pluto->outline_size = size_n;
     }
 
@@ -148,7 +148,7 @@ static void generation_callback(int count, const PVG_FT_Span* spans, void* user)
 
 plutovg_rle_t* plutovg_rle_create(void)
 {
-    plutovg_rle_t* rle = malloc(sizeof(plutovg_rle_t));
+    plutovg_rle_t* rle = plutovg_malloc(sizeof(plutovg_rle_t));
     plutovg_array_init(rle->spans);
     rle->x = 0;
     rle->y = 0;
@@ -162,8 +162,8 @@ void plutovg_rle_destroy(plutovg_rle_t* rle)
     if(rle==NULL)
         return;
 
-    free(rle->spans.data);
-    free(rle);
+    plutovg_free(rle->spans.data);
+    plutovg_free(rle);
 }
 
 void plutovg_rle_rasterize(plutovg_t* pluto, plutovg_rle_t* rle, const plutovg_path_t* path, const plutovg_matrix_t* matrix, const plutovg_rect_t* clip, const plutovg_stroke_data_t* stroke, plutovg_fill_rule_t winding)
@@ -290,7 +290,7 @@ void plutovg_rle_rasterize(plutovg_t* pluto, plutovg_rle_t* rle, const plutovg_p
 plutovg_rle_t* plutovg_rle_intersection(const plutovg_rle_t* a, const plutovg_rle_t* b)
 {
     int count = plutovg_max(a->spans.size, b->spans.size);
-    plutovg_rle_t* result = malloc(sizeof(plutovg_rle_t));
+    plutovg_rle_t* result = plutovg_malloc(sizeof(plutovg_rle_t));
     plutovg_array_init(result->spans);
     plutovg_array_ensure(result->spans, count);
 
@@ -401,7 +401,7 @@ plutovg_rle_t* plutovg_rle_clone(const plutovg_rle_t* rle)
     if(rle==NULL)
         return NULL;
 
-    plutovg_rle_t* result = malloc(sizeof(plutovg_rle_t));
+    plutovg_rle_t* result = plutovg_malloc(sizeof(plutovg_rle_t));
     plutovg_array_init(result->spans);
     plutovg_array_ensure(result->spans, rle->spans.size);
 
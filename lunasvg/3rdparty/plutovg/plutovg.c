@@ -1,11 +1,47 @@
 #include "plutovg-private.h"
 
+static plutovg_malloc_func_t plutovg_malloc_func = malloc;
+static plutovg_realloc_func_t plutovg_realloc_func = realloc;
+static plutovg_free_func_t plutovg_free_func = free;
+
+void plutovg_set_memory_functions(plutovg_malloc_func_t malloc_func, plutovg_realloc_func_t realloc_func, plutovg_free_func_t free_func)
+{
+    plutovg_malloc_func = malloc_func ? malloc_func : malloc;
+    plutovg_realloc_func = realloc_func ? realloc_func : realloc;
+    plutovg_free_func = free_func ? free_func : free;
+}
+
+void* plutovg_malloc(size_t size)
+{
+    return plutovg_malloc_func(size);
+}
+
+void* plutovg_calloc(size_t count, size_t size)
+{
+    if(size && count > (size_t)-1 / size)
+        return NULL;
+    void* ptr = plutovg_malloc_func(count * size);
+    if(ptr)
+        memset(ptr, 0, count * size);
+    return ptr;
+}
+
+void* plutovg_realloc(void* ptr, size_t size)
+{
+    return plutovg_realloc_func(ptr, size);
+}
+
+void plutovg_free(void* ptr)
+{
+    plutovg_free_func(ptr);
+}
+
 plutovg_surface_t* plutovg_surface_create(int width, int height)
 {
-    plutovg_surface_t* surface = malloc(sizeof(plutovg_surface_t));
+    plutovg_surface_t* surface = plutovg_malloc(sizeof(plutovg_surface_t));
     surface->ref = 1;
     surface->owndata = 1;
-    surface->data = calloc(1, (size_t)(width * height * 4));
+    surface->data = plutovg_calloc(1, (size_t)(width * height * 4));
     surface->width = width;
     surface->height = height;
     surface->stride = width * 4;
@@ -14,7 +50,7 @@ plutovg_surface_t* plutovg_surface_create(int width, int height)
 
 plutovg_surface_t* plutovg_surface_create_for_data(unsigned char* data, int width, int height, int stride)
 {
-    plutovg_surface_t* surface = malloc(sizeof(plutovg_surface_t));
+    plutovg_surface_t* surface = plutovg_malloc(sizeof(plutovg_surface_t));
     surface->ref = 1;
     surface->owndata = 0;
     surface->data = data;
@@ -38,8 +74,8 @@ void plutovg_surface_destroy(plutovg_surface_t* surface)
     if(--surface->ref==0)
     {
         if(surface->owndata)
-            free(surface->data);
-        free(surface);
+            plutovg_free(surface->data);
+        plutovg_free(surface);
     }
 }
 
@@ -70,7 +106,7 @@ int plutovg_surface_get_stride(const plutovg_surface_t* surface)
 
 plutovg_state_t* plutovg_state_create(void)
 {
-    plutovg_state_t* state = malloc(sizeof(plutovg_state_t));
+    plutovg_state_t* state = plutovg_malloc(sizeof(plutovg_state_t));
     state->clippath = NULL;
     plutovg_paint_init(&state->paint);
     plutovg_matrix_init_identity(&state->matrix);
@@ -109,12 +145,12 @@ void plutovg_state_destroy(plutovg_state_t* state)
     plutovg_rle_destroy(state->clippath);
     plutovg_paint_destroy(&state->paint);
     plutovg_dash_destroy(state->stroke.dash);
-    free(state);
+    plutovg_free(state);
 }
 
 plutovg_t* plutovg_create(plutovg_surface_t* surface)
 {
-    plutovg_t* pluto = malloc(sizeof(plutovg_t));
+    plutovg_t* pluto = plutovg_malloc(sizeof(plutovg_t));
     pluto->ref = 1;
     pluto->surface = plutovg_surface_reference(surface);
     pluto->state = plutovg_state_create();
@@ -154,8 +190,8 @@ void plutovg_destroy(plutovg_t* pluto)
         plutovg_path_destroy(pluto->path);
         plutovg_rle_destroy(pluto->rle);
         plutovg_rle_destroy(pluto->clippath);
-        free(pluto->outline_data);
-        free(pluto);
+        plutovg_free(pluto->outline_data);
+        plutovg_free(pluto);
     }
 }
 
@@ -1,6 +1,8 @@
 #ifndef PLUTOVG_H
 #define PLUTOVG_H
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -253,6 +255,21 @@ void plutovg_stroke_preserve(plutovg_t* pluto);
 void plutovg_clip_preserve(plutovg_t* pluto);
 void plutovg_reset_clip(plutovg_t* pluto);
 
+typedef void* (*plutovg_malloc_func_t)(size_t size);
+typedef void* (*plutovg_realloc_func_t)(void* ptr, size_t size);
+typedef void (*plutovg_free_func_t)(void* ptr);
+
+/*
+ * Sets the functions used for all the memory allocated by plutovg, nullptr restores the C library ones.
+ * Must be called before any other plutovg function, memory allocated by one set of functions cannot be freed by another.
+ */
+void plutovg_set_memory_functions(plutovg_malloc_func_t malloc_func, plutovg_realloc_func_t realloc_func, plutovg_free_func_t free_func);
+
+void* plutovg_malloc(size_t size);
+void* plutovg_calloc(size_t count, size_t size);
+void* plutovg_realloc(void* ptr, size_t size);
+void plutovg_free(void* ptr);
+
 #ifdef __cplusplus
 }
 #endif
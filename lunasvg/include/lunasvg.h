@@ -38,6 +38,13 @@
 #define LUNASVG_API
 #endif
 
+#define LUNASVG_VERSION_MAJOR 2
+#define LUNASVG_VERSION_MINOR 3
+#define LUNASVG_VERSION_MICRO 9
+
+#define LUNASVG_VERSION_ENCODE(major, minor, micro) (((major) * 10000) + ((minor) * 100) + ((micro) * 1))
+#define LUNASVG_VERSION LUNASVG_VERSION_ENCODE(LUNASVG_VERSION_MAJOR, LUNASVG_VERSION_MINOR, LUNASVG_VERSION_MICRO)
+
 namespace lunasvg {
 
 class Rect;
@@ -236,6 +243,32 @@ public:
      */
     static std::unique_ptr<Document> loadFromData(const char* data);
 
+    /**
+     * @brief Creates a document from a string data and size, without computing its layout
+     * @param data - string data to parse
+     * @param size - size of the data to parse, in bytes
+     * @return pointer to document on success, otherwise nullptr
+     * @note Document::updateLayout must be called before the document can be rendered
+     */
+    static std::unique_ptr<Document> parseFromData(const char* data, std::size_t size);
+
+    /**
+     * @brief Creates a document from data created by Document::compile, without any parsing
+     * @param data - compiled data to load
+     * @param size - size of the data to load, in bytes
+     * @return pointer to document on success, otherwise nullptr
+     * @note The loaded document has no elements, only its layout, so it can be rendered but not modified
+     */
+    static std::unique_ptr<Document> loadFromCompiled(const char* data, std::size_t size);
+
+    /**
+     * @brief Checks whether data are in the format created by Document::compile
+     * @param data - data to check
+     * @param size - size of the data, in bytes
+     * @return true if data start with the compiled format signature
+     */
+    static bool isCompiled(const char* data, std::size_t size);
+
     /**
      * @brief Sets the current transformation matrix of the document
      * @param matrix - current transformation matrix
@@ -270,6 +303,7 @@ public:
      * @brief Renders the document to a bitmap
      * @param matrix - the current transformation matrix
      * @param bitmap - target image on which the content will be drawn
+     * @note Rendering does not modify the document, so it can be done from several threads at once
      */
     void render(Bitmap bitmap, const Matrix& matrix = Matrix{}) const;
 
@@ -282,8 +316,15 @@ public:
      */
     Bitmap renderToBitmap(std::uint32_t width = 0, std::uint32_t height = 0, std::uint32_t backgroundColor = 0x00000000) const;
 
+    /**
+     * @brief Serializes the resolved layout of the document to a compact versioned binary format
+     * @return the compiled data, empty if the document has no layout
+     */
+    std::string compile() const;
+
     /**
      * @brief updateLayout
+     * @note Does nothing for a document loaded with Document::loadFromCompiled
      */
     void updateLayout();
 
@@ -301,6 +342,43 @@ private:
     std::unique_ptr<LayoutSymbol> m_rootBox;
 };
 
+/**
+ * @brief Sets the functions used for the memory allocated by the rasterizer while rendering
+ * @param mallocFunc - allocates memory like malloc
+ * @param reallocFunc - reallocates memory like realloc
+ * @param freeFunc - frees memory like free
+ * @note nullptr restores the C library function. Must be called before any document is rendered,
+ * memory allocated by one set of functions cannot be freed by another.
+ */
+LUNASVG_API void setRenderMemoryFunctions(void* (*mallocFunc)(std::size_t),
+                                          void* (*reallocFunc)(void*, std::size_t),
+                                          void (*freeFunc)(void*));
+
+/**
+ * @brief Part of rendering reported to the function set by setRenderTraceFunction
+ */
+struct RenderTraceEvent {
+    const char* name; ///< "render", "beginGroup", "endGroup", "clipPath", "mask", "marker", "fill", "stroke" or "css"
+    const char* tag; ///< tag of the element, e.g. "path", empty for a document loaded with Document::loadFromCompiled
+    const char* id; ///< id attribute of the element, empty if it has none
+    const char* paint; ///< for "fill" and "stroke", "color", "solidColor", "linearGradient", "radialGradient" or "pattern", otherwise empty
+    bool dashed; ///< for "stroke", true if the stroke is dashed
+    bool begin; ///< true when the part starts, false when it ends
+};
+
+using RenderTraceFunction = void (*)(const RenderTraceEvent& event, void* userData);
+
+/**
+ * @brief Sets the function called when rendering of an element, its group, clipping, masking, filling or stroking starts and ends
+ * @param traceFunc - function to call, nullptr disables tracing
+ * @param userData - passed to traceFunc
+ * @return false if tracing was disabled when building the library with LUNASVG_DISABLE_TRACE
+ * @note The parts are nested and ended in reverse order. The event strings are valid only during the call.
+ * "css" is reported while loading a document, for parsing style sheets and style attributes and for applying the style sheet rules.
+ * Must not be called while any document is being rendered, the function is called from all rendering threads.
+ */
+LUNASVG_API bool setRenderTraceFunction(RenderTraceFunction traceFunc, void* userData = nullptr);
+
 } //namespace lunasvg
 
 #endif // LUNASVG_H
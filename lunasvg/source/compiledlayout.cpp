@@ -0,0 +1,835 @@
+#include "compiledlayout.h"
+#include "layoutcontext.h"
+#include "element.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <vector>
+
+namespace lunasvg {
+
+// The data start with the signature and the format version, followed by the
+// total object count and the object tree in preorder. Each object is stored
+// as its LayoutId and fields, containers are followed by their child count
+// and children. References to other objects are stored as their preorder
+// index plus one, zero means no reference. All values are little endian.
+
+static const char compiledSignature[8] = {'L', 'S', 'V', 'G', 'C', 'M', 'P', 'L'};
+static const std::uint32_t compiledVersion = 1;
+static const std::uint32_t compiledMaxDepth = 1024;
+
+class CompiledWriter {
+public:
+    bool write(const LayoutSymbol* root);
+    const std::string& data() const { return m_data; }
+
+private:
+    void index(const LayoutObject* object);
+    bool writeObject(const LayoutObject* object);
+
+    void writeU8(std::uint8_t value) { m_data.push_back(static_cast<char>(value)); }
+    void writeU32(std::uint32_t value);
+    void writeU64(std::uint64_t value);
+    void writeDouble(double value);
+    void writeColor(const Color& color) { writeU32(color.value()); }
+    void writeRect(const Rect& rect);
+    void writeTransform(const Transform& transform);
+    void writePath(const Path& path);
+    template<typename T>
+    void writeEnum(T value) { writeU8(static_cast<std::uint8_t>(value)); }
+    bool writeRef(const LayoutObject* object);
+
+    std::string m_data;
+    std::map<const LayoutObject*, std::uint32_t> m_indices;
+};
+
+void CompiledWriter::writeU32(std::uint32_t value)
+{
+    for(int i = 0; i < 4; i++)
+        writeU8(static_cast<std::uint8_t>(value >> (i * 8)));
+}
+
+void CompiledWriter::writeU64(std::uint64_t value)
+{
+    for(int i = 0; i < 8; i++)
+        writeU8(static_cast<std::uint8_t>(value >> (i * 8)));
+}
+
+void CompiledWriter::writeDouble(double value)
+{
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    writeU64(bits);
+}
+
+void CompiledWriter::writeRect(const Rect& rect)
+{
+    writeDouble(rect.x);
+    writeDouble(rect.y);
+    writeDouble(rect.w);
+    writeDouble(rect.h);
+}
+
+void CompiledWriter::writeTransform(const Transform& transform)
+{
+    writeDouble(transform.m00);
+    writeDouble(transform.m10);
+    writeDouble(transform.m01);
+    writeDouble(transform.m11);
+    writeDouble(transform.m02);
+    writeDouble(transform.m12);
+}
+
+void CompiledWriter::writePath(const Path& path)
+{
+    writeU32(static_cast<std::uint32_t>(path.commands().size()));
+    for(auto command : path.commands())
+        writeEnum(command);
+    writeU32(static_cast<std::uint32_t>(path.points().size()));
+    for(const auto& point : path.points()) {
+        writeDouble(point.x);
+        writeDouble(point.y);
+    }
+}
+
+bool CompiledWriter::writeRef(const LayoutObject* object)
+{
+    if(object == nullptr) {
+        writeU32(0);
+        return true;
+    }
+
+    auto it = m_indices.find(object);
+    if(it == m_indices.end())
+        return false;
+    writeU32(it->second + 1);
+    return true;
+}
+
+void CompiledWriter::index(const LayoutObject* object)
+{
+    m_indices.emplace(object, static_cast<std::uint32_t>(m_indices.size()));
+    switch(object->id()) {
+    case LayoutId::Symbol:
+    case LayoutId::Group:
+    case LayoutId::Mask:
+    case LayoutId::ClipPath:
+    case LayoutId::Marker:
+    case LayoutId::Pattern:
+        for(const auto& child : static_cast<const LayoutContainer*>(object)->children())
+            index(child.get());
+        break;
+    default:
+        break;
+    }
+}
+
+bool CompiledWriter::write(const LayoutSymbol* root)
+{
+    m_data.assign(compiledSignature, sizeof(compiledSignature));
+    writeU32(compiledVersion);
+    index(root);
+    writeU32(static_cast<std::uint32_t>(m_indices.size()));
+    return writeObject(root);
+}
+
+bool CompiledWriter::writeObject(const LayoutObject* object)
+{
+    writeEnum(object->id());
+    switch(object->id()) {
+    case LayoutId::Symbol: {
+        auto symbol = static_cast<const LayoutSymbol*>(object);
+        writeDouble(symbol->width);
+        writeDouble(symbol->height);
+        writeTransform(symbol->transform);
+        writeRect(symbol->clip);
+        writeDouble(symbol->opacity);
+        if(!writeRef(symbol->masker) || !writeRef(symbol->clipper))
+            return false;
+        break;
+    }
+    case LayoutId::Group: {
+        auto group = static_cast<const LayoutGroup*>(object);
+        writeTransform(group->transform);
+        writeDouble(group->opacity);
+        if(!writeRef(group->masker) || !writeRef(group->clipper))
+            return false;
+        break;
+    }
+    case LayoutId::Shape: {
+        auto shape = static_cast<const LayoutShape*>(object);
+        writePath(shape->path);
+        writeTransform(shape->transform);
+
+        const auto& fill = shape->fillData;
+        if(!writeRef(fill.painter))
+            return false;
+        writeColor(fill.color);
+        writeDouble(fill.opacity);
+        writeEnum(fill.fillRule);
+
+        const auto& stroke = shape->strokeData;
+        if(!writeRef(stroke.painter))
+            return false;
+        writeColor(stroke.color);
+        writeDouble(stroke.opacity);
+        writeDouble(stroke.width);
+        writeDouble(stroke.miterlimit);
+        writeEnum(stroke.cap);
+        writeEnum(stroke.join);
+        writeU32(static_cast<std::uint32_t>(stroke.dash.array.size()));
+        for(auto dash : stroke.dash.array)
+            writeDouble(dash);
+        writeDouble(stroke.dash.offset);
+
+        const auto& markers = shape->markerData;
+        writeU32(static_cast<std::uint32_t>(markers.positions.size()));
+        for(const auto& position : markers.positions) {
+            if(!writeRef(position.marker))
+                return false;
+            writeDouble(position.origin.x);
+            writeDouble(position.origin.y);
+            writeDouble(position.angle);
+        }
+        writeDouble(markers.strokeWidth);
+
+        writeEnum(shape->visibility);
+        writeEnum(shape->clipRule);
+        writeDouble(shape->opacity);
+        if(!writeRef(shape->masker) || !writeRef(shape->clipper))
+            return false;
+        return true;
+    }
+    case LayoutId::Mask: {
+        auto mask = static_cast<const LayoutMask*>(object);
+        writeDouble(mask->x);
+        writeDouble(mask->y);
+        writeDouble(mask->width);
+        writeDouble(mask->height);
+        writeEnum(mask->units);
+        writeEnum(mask->contentUnits);
+        writeDouble(mask->opacity);
+        if(!writeRef(mask->masker) || !writeRef(mask->clipper))
+            return false;
+        break;
+    }
+    case LayoutId::ClipPath: {
+        auto clipPath = static_cast<const LayoutClipPath*>(object);
+        writeEnum(clipPath->units);
+        writeTransform(clipPath->transform);
+        if(!writeRef(clipPath->clipper))
+            return false;
+        break;
+    }
+    case LayoutId::Marker: {
+        auto marker = static_cast<const LayoutMarker*>(object);
+        writeDouble(marker->refX);
+        writeDouble(marker->refY);
+        writeTransform(marker->transform);
+        writeDouble(marker->orient.value());
+        writeEnum(marker->orient.type());
+        writeEnum(marker->units);
+        writeRect(marker->clip);
+        writeDouble(marker->opacity);
+        if(!writeRef(marker->masker) || !writeRef(marker->clipper))
+            return false;
+        break;
+    }
+    case LayoutId::LinearGradient:
+    case LayoutId::RadialGradient: {
+        auto gradient = static_cast<const LayoutGradient*>(object);
+        writeTransform(gradient->transform);
+        writeEnum(gradient->spreadMethod);
+        writeEnum(gradient->units);
+        writeU32(static_cast<std::uint32_t>(gradient->stops.size()));
+        for(const auto& stop : gradient->stops) {
+            writeDouble(stop.first);
+            writeColor(stop.second);
+        }
+
+        if(object->id() == LayoutId::LinearGradient) {
+            auto linear = static_cast<const LayoutLinearGradient*>(object);
+            writeDouble(linear->x1);
+            writeDouble(linear->y1);
+            writeDouble(linear->x2);
+            writeDouble(linear->y2);
+        } else {
+            auto radial = static_cast<const LayoutRadialGradient*>(object);
+            writeDouble(radial->cx);
+            writeDouble(radial->cy);
+            writeDouble(radial->r);
+            writeDouble(radial->fx);
+            writeDouble(radial->fy);
+        }
+        return true;
+    }
+    case LayoutId::Pattern: {
+        auto pattern = static_cast<const LayoutPattern*>(object);
+        writeDouble(pattern->x);
+        writeDouble(pattern->y);
+        writeDouble(pattern->width);
+        writeDouble(pattern->height);
+        writeTransform(pattern->transform);
+        writeEnum(pattern->units);
+        writeEnum(pattern->contentUnits);
+        writeRect(pattern->viewBox);
+        writeEnum(pattern->preserveAspectRatio.align());
+        writeEnum(pattern->preserveAspectRatio.scale());
+        break;
+    }
+    case LayoutId::SolidColor:
+        writeColor(static_cast<const LayoutSolidColor*>(object)->color);
+        return true;
+    }
+
+    auto container = static_cast<const LayoutContainer*>(object);
+    writeU32(static_cast<std::uint32_t>(container->children().size()));
+    for(const auto& child : container->children()) {
+        if(!writeObject(child.get()))
+            return false;
+    }
+
+    return true;
+}
+
+class CompiledReader {
+public:
+    CompiledReader(const char* data, std::size_t size);
+
+    std::unique_ptr<LayoutSymbol> read();
+
+private:
+    std::unique_ptr<LayoutObject> readObject(std::uint32_t depth);
+    bool readChildren(LayoutContainer* container, std::uint32_t depth);
+
+    bool readU8(std::uint8_t& value);
+    bool readU32(std::uint32_t& value);
+    bool readU64(std::uint64_t& value);
+    bool readDouble(double& value);
+    bool readColor(Color& color);
+    bool readRect(Rect& rect);
+    bool readTransform(Transform& transform);
+    bool readPath(Path& path);
+    bool readCount(std::uint32_t& count, std::size_t minItemSize);
+    template<typename T>
+    bool readEnum(T& value, T last);
+    template<typename T>
+    bool readRef(const T*& ref, std::function<bool(const LayoutObject*)> accept);
+    bool readMasker(const LayoutMask*& masker);
+    bool readClipper(const LayoutClipPath*& clipper);
+    bool readPainter(const LayoutObject*& painter);
+    std::uint32_t renderHeight(const LayoutObject* object, std::uint32_t depth);
+
+    const char* m_data;
+    std::size_t m_size;
+    std::size_t m_position{0};
+    std::vector<LayoutObject*> m_objects;
+    std::vector<std::function<bool()>> m_fixups;
+    std::map<const LayoutObject*, std::uint32_t> m_heights;
+};
+
+CompiledReader::CompiledReader(const char* data, std::size_t size)
+    : m_data(data), m_size(size)
+{
+}
+
+bool CompiledReader::readU8(std::uint8_t& value)
+{
+    if(m_position >= m_size)
+        return false;
+    value = static_cast<std::uint8_t>(m_data[m_position++]);
+    return true;
+}
+
+bool CompiledReader::readU32(std::uint32_t& value)
+{
+    if(m_size - m_position < 4)
+        return false;
+    value = 0;
+    for(int i = 0; i < 4; i++)
+        value |= static_cast<std::uint32_t>(static_cast<std::uint8_t>(m_data[m_position++])) << (i * 8);
+    return true;
+}
+
+bool CompiledReader::readU64(std::uint64_t& value)
+{
+    if(m_size - m_position < 8)
+        return false;
+    value = 0;
+    for(int i = 0; i < 8; i++)
+        value |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(m_data[m_position++])) << (i * 8);
+    return true;
+}
+
+bool CompiledReader::readDouble(double& value)
+{
+    std::uint64_t bits;
+    if(!readU64(bits))
+        return false;
+    std::memcpy(&value, &bits, sizeof(value));
+    return true;
+}
+
+bool CompiledReader::readColor(Color& color)
+{
+    std::uint32_t value;
+    if(!readU32(value))
+        return false;
+    color = Color(value);
+    return true;
+}
+
+bool CompiledReader::readRect(Rect& rect)
+{
+    return readDouble(rect.x) && readDouble(rect.y) && readDouble(rect.w) && readDouble(rect.h);
+}
+
+bool CompiledReader::readTransform(Transform& transform)
+{
+    return readDouble(transform.m00) && readDouble(transform.m10)
+        && readDouble(transform.m01) && readDouble(transform.m11)
+        && readDouble(transform.m02) && readDouble(transform.m12);
+}
+
+bool CompiledReader::readCount(std::uint32_t& count, std::size_t minItemSize)
+{
+    // the count cannot exceed what the remaining data can hold
+    return readU32(count) && count <= (m_size - m_position) / minItemSize;
+}
+
+template<typename T>
+bool CompiledReader::readEnum(T& value, T last)
+{
+    std::uint8_t raw;
+    if(!readU8(raw) || raw > static_cast<std::uint8_t>(last))
+        return false;
+    value = static_cast<T>(raw);
+    return true;
+}
+
+bool CompiledReader::readPath(Path& path)
+{
+    std::uint32_t commandCount;
+    if(!readCount(commandCount, 1))
+        return false;
+
+    std::vector<PathCommand> commands(commandCount);
+    for(auto& command : commands) {
+        if(!readEnum(command, PathCommand::Close))
+            return false;
+    }
+
+    std::uint32_t pointCount;
+    if(!readCount(pointCount, 16))
+        return false;
+
+    std::uint32_t pointIndex = 0;
+    auto readPoint = [&](double& x, double& y) {
+        if(pointIndex++ >= pointCount)
+            return false;
+        return readDouble(x) && readDouble(y);
+    };
+
+    double x1, y1, x2, y2, x3, y3;
+    for(auto command : commands) {
+        switch(command) {
+        case PathCommand::MoveTo:
+            if(!readPoint(x1, y1))
+                return false;
+            path.moveTo(x1, y1);
+            break;
+        case PathCommand::LineTo:
+            if(!readPoint(x1, y1))
+                return false;
+            path.lineTo(x1, y1);
+            break;
+        case PathCommand::CubicTo:
+            if(!readPoint(x1, y1) || !readPoint(x2, y2) || !readPoint(x3, y3))
+                return false;
+            path.cubicTo(x1, y1, x2, y2, x3, y3);
+            break;
+        case PathCommand::Close:
+            path.close();
+            break;
+        }
+    }
+
+    return pointIndex == pointCount && path.commands().size() == commands.size();
+}
+
+template<typename T>
+bool CompiledReader::readRef(const T*& ref, std::function<bool(const LayoutObject*)> accept)
+{
+    std::uint32_t index;
+    if(!readU32(index))
+        return false;
+
+    ref = nullptr;
+    if(index == 0)
+        return true;
+
+    // the object may come later in the data, resolve once all are read
+    m_fixups.push_back([this, &ref, index, accept]() {
+        if(index > m_objects.size())
+            return false;
+        auto object = m_objects[index - 1];
+        if(!accept(object))
+            return false;
+        ref = static_cast<const T*>(object);
+        return true;
+    });
+
+    return true;
+}
+
+bool CompiledReader::readMasker(const LayoutMask*& masker)
+{
+    return readRef(masker, [](const LayoutObject* object) { return object->id() == LayoutId::Mask; });
+}
+
+bool CompiledReader::readClipper(const LayoutClipPath*& clipper)
+{
+    return readRef(clipper, [](const LayoutObject* object) { return object->id() == LayoutId::ClipPath; });
+}
+
+bool CompiledReader::readPainter(const LayoutObject*& painter)
+{
+    return readRef(painter, [](const LayoutObject* object) { return object->isPaint(); });
+}
+
+std::unique_ptr<LayoutSymbol> CompiledReader::read()
+{
+    if(m_size < sizeof(compiledSignature) || std::memcmp(m_data, compiledSignature, sizeof(compiledSignature)) != 0)
+        return nullptr;
+    m_position = sizeof(compiledSignature);
+
+    std::uint32_t version;
+    std::uint32_t objectCount;
+    if(!readU32(version) || version != compiledVersion || !readCount(objectCount, 1))
+        return nullptr;
+
+    m_objects.reserve(objectCount);
+    auto root = readObject(0);
+    if(root == nullptr || root->id() != LayoutId::Symbol || m_objects.size() != objectCount || m_position != m_size)
+        return nullptr;
+
+    for(const auto& fixup : m_fixups) {
+        if(!fixup())
+            return nullptr;
+    }
+
+    // the references were checked only for the type of the objects,
+    // unlike LayoutContext, the data may contain cyclic references
+    auto height = renderHeight(root.get(), 0);
+    if(height == 0 || height > compiledMaxDepth)
+        return nullptr;
+
+    return std::unique_ptr<LayoutSymbol>(static_cast<LayoutSymbol*>(root.release()));
+}
+
+// Returns how deeply rendering the object nests, including the objects it
+// references, or zero if it references itself or the nesting is too deep.
+std::uint32_t CompiledReader::renderHeight(const LayoutObject* object, std::uint32_t depth)
+{
+    if(depth > compiledMaxDepth)
+        return 0;
+
+    // the referenced objects are shared, each is checked only once
+    if(object->isHidden()) {
+        auto it = m_heights.find(object);
+        if(it != m_heights.end())
+            return it->second; // zero while the object is being checked
+        m_heights.emplace(object, 0);
+    }
+
+    std::uint32_t height = 1;
+    bool failed = false;
+    auto visit = [&](const LayoutObject* child) {
+        if(child == nullptr || failed)
+            return;
+        auto childHeight = renderHeight(child, depth + 1);
+        if(childHeight == 0)
+            failed = true;
+        height = std::max(height, childHeight + 1);
+    };
+
+    switch(object->id()) {
+    case LayoutId::Symbol: {
+        auto symbol = static_cast<const LayoutSymbol*>(object);
+        visit(symbol->masker);
+        visit(symbol->clipper);
+        break;
+    }
+    case LayoutId::Group: {
+        auto group = static_cast<const LayoutGroup*>(object);
+        visit(group->masker);
+        visit(group->clipper);
+        break;
+    }
+    case LayoutId::Shape: {
+        auto shape = static_cast<const LayoutShape*>(object);
+        visit(shape->fillData.painter);
+        visit(shape->strokeData.painter);
+        for(const auto& position : shape->markerData.positions)
+            visit(position.marker);
+        visit(shape->masker);
+        visit(shape->clipper);
+        return failed ? 0 : height;
+    }
+    case LayoutId::Mask: {
+        auto mask = static_cast<const LayoutMask*>(object);
+        visit(mask->masker);
+        visit(mask->clipper);
+        break;
+    }
+    case LayoutId::ClipPath:
+        visit(static_cast<const LayoutClipPath*>(object)->clipper);
+        break;
+    case LayoutId::Marker: {
+        auto marker = static_cast<const LayoutMarker*>(object);
+        visit(marker->masker);
+        visit(marker->clipper);
+        break;
+    }
+    case LayoutId::Pattern:
+        break;
+    case LayoutId::LinearGradient:
+    case LayoutId::RadialGradient:
+    case LayoutId::SolidColor:
+        m_heights[object] = height;
+        return height;
+    }
+
+    // the hidden children are rendered only when referenced
+    for(const auto& child : static_cast<const LayoutContainer*>(object)->children()) {
+        if(!child->isHidden())
+            visit(child.get());
+    }
+
+    if(failed)
+        return 0;
+    if(object->isHidden())
+        m_heights[object] = height;
+    return height;
+}
+
+bool CompiledReader::readChildren(LayoutContainer* container, std::uint32_t depth)
+{
+    std::uint32_t childCount;
+    if(!readCount(childCount, 1))
+        return false;
+
+    for(std::uint32_t i = 0; i < childCount; i++) {
+        auto child = readObject(depth + 1);
+        if(child == nullptr)
+            return false;
+        container->addChild(std::move(child));
+    }
+
+    return true;
+}
+
+std::unique_ptr<LayoutObject> CompiledReader::readObject(std::uint32_t depth)
+{
+    LayoutId id;
+    if(depth > compiledMaxDepth || !readEnum(id, LayoutId::SolidColor))
+        return nullptr;
+
+    switch(id) {
+    case LayoutId::Symbol: {
+        auto symbol = makeUnique<LayoutSymbol>(nullptr);
+        m_objects.push_back(symbol.get());
+        if(!readDouble(symbol->width) || !readDouble(symbol->height)
+            || !readTransform(symbol->transform) || !readRect(symbol->clip) || !readDouble(symbol->opacity)
+            || !readMasker(symbol->masker) || !readClipper(symbol->clipper)
+            || !readChildren(symbol.get(), depth)) {
+            return nullptr;
+        }
+        return std::unique_ptr<LayoutObject>(std::move(symbol));
+    }
+    case LayoutId::Group: {
+        auto group = makeUnique<LayoutGroup>(nullptr);
+        m_objects.push_back(group.get());
+        if(!readTransform(group->transform) || !readDouble(group->opacity)
+            || !readMasker(group->masker) || !readClipper(group->clipper)
+            || !readChildren(group.get(), depth)) {
+            return nullptr;
+        }
+        return std::unique_ptr<LayoutObject>(std::move(group));
+    }
+    case LayoutId::Shape: {
+        auto shape = makeUnique<LayoutShape>(nullptr);
+        m_objects.push_back(shape.get());
+        if(!readPath(shape->path) || !readTransform(shape->transform))
+            return nullptr;
+
+        auto& fill = shape->fillData;
+        if(!readPainter(fill.painter) || !readColor(fill.color) || !readDouble(fill.opacity)
+            || !readEnum(fill.fillRule, WindRule::EvenOdd)) {
+            return nullptr;
+        }
+
+        auto& stroke = shape->strokeData;
+        std::uint32_t dashCount;
+        if(!readPainter(stroke.painter) || !readColor(stroke.color) || !readDouble(stroke.opacity)
+            || !readDouble(stroke.width) || !readDouble(stroke.miterlimit)
+            || !readEnum(stroke.cap, LineCap::Square) || !readEnum(stroke.join, LineJoin::Bevel)
+            || !readCount(dashCount, 8)) {
+            return nullptr;
+        }
+
+        stroke.dash.array.resize(dashCount);
+        for(auto& dash : stroke.dash.array) {
+            if(!readDouble(dash))
+                return nullptr;
+        }
+
+        auto& markers = shape->markerData;
+        std::uint32_t positionCount;
+        if(!readDouble(stroke.dash.offset) || !readCount(positionCount, 28))
+            return nullptr;
+
+        // reserved up front, the fixups refer to the elements
+        markers.positions.reserve(positionCount);
+        for(std::uint32_t i = 0; i < positionCount; i++) {
+            markers.positions.emplace_back(nullptr, Point(), 0.0);
+            auto& position = markers.positions.back();
+            auto accept = [](const LayoutObject* object) { return object->id() == LayoutId::Marker; };
+            if(!readRef(position.marker, accept) || !readDouble(position.origin.x)
+                || !readDouble(position.origin.y) || !readDouble(position.angle)) {
+                return nullptr;
+            }
+        }
+
+        if(!readDouble(markers.strokeWidth)
+            || !readEnum(shape->visibility, Visibility::Hidden) || !readEnum(shape->clipRule, WindRule::EvenOdd)
+            || !readDouble(shape->opacity) || !readMasker(shape->masker) || !readClipper(shape->clipper)) {
+            return nullptr;
+        }
+        return std::unique_ptr<LayoutObject>(std::move(shape));
+    }
+    case LayoutId::Mask: {
+        auto mask = makeUnique<LayoutMask>(nullptr);
+        m_objects.push_back(mask.get());
+        if(!readDouble(mask->x) || !readDouble(mask->y) || !readDouble(mask->width) || !readDouble(mask->height)
+            || !readEnum(mask->units, Units::ObjectBoundingBox) || !readEnum(mask->contentUnits, Units::ObjectBoundingBox)
+            || !readDouble(mask->opacity) || !readMasker(mask->masker) || !readClipper(mask->clipper)
+            || !readChildren(mask.get(), depth)) {
+            return nullptr;
+        }
+        return std::unique_ptr<LayoutObject>(std::move(mask));
+    }
+    case LayoutId::ClipPath: {
+        auto clipPath = makeUnique<LayoutClipPath>(nullptr);
+        m_objects.push_back(clipPath.get());
+        if(!readEnum(clipPath->units, Units::ObjectBoundingBox) || !readTransform(clipPath->transform)
+            || !readClipper(clipPath->clipper) || !readChildren(clipPath.get(), depth)) {
+            return nullptr;
+        }
+        return std::unique_ptr<LayoutObject>(std::move(clipPath));
+    }
+    case LayoutId::Marker: {
+        auto marker = makeUnique<LayoutMarker>(nullptr);
+        m_objects.push_back(marker.get());
+        double orientValue;
+        MarkerOrient orientType;
+        if(!readDouble(marker->refX) || !readDouble(marker->refY) || !readTransform(marker->transform)
+            || !readDouble(orientValue) || !readEnum(orientType, MarkerOrient::Angle)
+            || !readEnum(marker->units, MarkerUnits::UserSpaceOnUse) || !readRect(marker->clip)
+            || !readDouble(marker->opacity) || !readMasker(marker->masker) || !readClipper(marker->clipper)) {
+            return nullptr;
+        }
+
+        marker->orient = Angle(orientValue, orientType);
+        if(!readChildren(marker.get(), depth))
+            return nullptr;
+        return std::unique_ptr<LayoutObject>(std::move(marker));
+    }
+    case LayoutId::LinearGradient:
+    case LayoutId::RadialGradient: {
+        std::unique_ptr<LayoutGradient> gradient;
+        if(id == LayoutId::LinearGradient)
+            gradient = makeUnique<LayoutLinearGradient>(nullptr);
+        else
+            gradient = makeUnique<LayoutRadialGradient>(nullptr);
+        m_objects.push_back(gradient.get());
+
+        std::uint32_t stopCount;
+        if(!readTransform(gradient->transform) || !readEnum(gradient->spreadMethod, SpreadMethod::Repeat)
+            || !readEnum(gradient->units, Units::ObjectBoundingBox) || !readCount(stopCount, 12)) {
+            return nullptr;
+        }
+
+        gradient->stops.resize(stopCount);
+        for(auto& stop : gradient->stops) {
+            if(!readDouble(stop.first) || !readColor(stop.second))
+                return nullptr;
+        }
+
+        if(id == LayoutId::LinearGradient) {
+            auto linear = static_cast<LayoutLinearGradient*>(gradient.get());
+            if(!readDouble(linear->x1) || !readDouble(linear->y1) || !readDouble(linear->x2) || !readDouble(linear->y2))
+                return nullptr;
+        } else {
+            auto radial = static_cast<LayoutRadialGradient*>(gradient.get());
+            if(!readDouble(radial->cx) || !readDouble(radial->cy) || !readDouble(radial->r)
+                || !readDouble(radial->fx) || !readDouble(radial->fy)) {
+                return nullptr;
+            }
+        }
+        return std::unique_ptr<LayoutObject>(std::move(gradient));
+    }
+    case LayoutId::Pattern: {
+        auto pattern = makeUnique<LayoutPattern>(nullptr);
+        m_objects.push_back(pattern.get());
+        Align align;
+        MeetOrSlice scale;
+        if(!readDouble(pattern->x) || !readDouble(pattern->y) || !readDouble(pattern->width) || !readDouble(pattern->height)
+            || !readTransform(pattern->transform) || !readEnum(pattern->units, Units::ObjectBoundingBox)
+            || !readEnum(pattern->contentUnits, Units::ObjectBoundingBox) || !readRect(pattern->viewBox)
+            || !readEnum(align, Align::xMaxYMax) || !readEnum(scale, MeetOrSlice::Slice)) {
+            return nullptr;
+        }
+
+        pattern->preserveAspectRatio = PreserveAspectRatio(align, scale);
+        if(!readChildren(pattern.get(), depth))
+            return nullptr;
+        return std::unique_ptr<LayoutObject>(std::move(pattern));
+    }
+    case LayoutId::SolidColor: {
+        auto solidColor = makeUnique<LayoutSolidColor>(nullptr);
+        m_objects.push_back(solidColor.get());
+        if(!readColor(solidColor->color))
+            return nullptr;
+        return std::unique_ptr<LayoutObject>(std::move(solidColor));
+    }
+    }
+
+    return nullptr;
+}
+
+std::string compileLayout(const LayoutSymbol* root)
+{
+    if(root == nullptr)
+        return std::string();
+
+    CompiledWriter writer;
+    if(!writer.write(root))
+        return std::string();
+    return writer.data();
+}
+
+std::unique_ptr<LayoutSymbol> loadCompiledLayout(const char* data, std::size_t size)
+{
+    CompiledReader reader(data, size);
+    return reader.read();
+}
+
+bool isCompiledLayout(const char* data, std::size_t size)
+{
+    return size >= sizeof(compiledSignature) && std::memcmp(data, compiledSignature, sizeof(compiledSignature)) == 0;
+}
+
+} // namespace lunasvg
@@ -0,0 +1,34 @@
+#ifndef COMPILEDLAYOUT_H
+#define COMPILEDLAYOUT_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace lunasvg {
+
+class LayoutSymbol;
+
+/**
+ * @brief Serializes a layout tree to the compiled binary format
+ * @param root - root of the layout tree
+ * @return the compiled data, empty on failure
+ * @note Paths, transforms and all the other values are stored at full precision,
+ * so a loaded layout renders exactly the same as the one it was compiled from.
+ */
+std::string compileLayout(const LayoutSymbol* root);
+
+/**
+ * @brief Rebuilds a layout tree from data created by compileLayout
+ * @return the root of the layout tree, nullptr if the data are not valid
+ */
+std::unique_ptr<LayoutSymbol> loadCompiledLayout(const char* data, std::size_t size);
+
+/**
+ * @brief Returns true if data start with the signature of the compiled binary format
+ */
+bool isCompiledLayout(const char* data, std::size_t size);
+
+} // namespace lunasvg
+
+#endif // COMPILEDLAYOUT_H
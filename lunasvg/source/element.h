@@ -109,6 +109,7 @@ enum class PropertyID {
 };
 
 ElementID elementid(const std::string& name);
+const char* elementname(ElementID id);
 PropertyID csspropertyid(const std::string& name);
 PropertyID propertyid(const std::string& name);
 
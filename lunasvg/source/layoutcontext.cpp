@@ -14,7 +14,9 @@ namespace lunasvg {
 LayoutObject::LayoutObject(Node* node, LayoutId id)
     : m_node(node), m_id(id)
 {
-    node->setBox(this);
+    // objects loaded from a compiled document have no node
+    if(node)
+        node->setBox(this);
 }
 
 LayoutContainer::LayoutContainer(Node* node, LayoutId id)
@@ -75,6 +77,7 @@ LayoutClipPath::LayoutClipPath(Node* node)
 
 void LayoutClipPath::apply(RenderState& state) const
 {
+    RenderTrace trace("clipPath", this);
     RenderState newState(this, RenderMode::Clipping);
     newState.canvas = Canvas::create(state.canvas->rect());
     newState.transform = transform * state.transform;
@@ -96,6 +99,7 @@ LayoutMask::LayoutMask(Node* node)
 
 void LayoutMask::apply(RenderState& state) const
 {
+    RenderTrace trace("mask", this);
     Rect rect{x, y, width, height};
     if(units == Units::ObjectBoundingBox) {
         const auto& box = state.objectBoundingBox();
@@ -129,6 +133,7 @@ LayoutSymbol::LayoutSymbol(Node* node)
 
 void LayoutSymbol::render(RenderState& state) const
 {
+    RenderTrace trace("render", this);
     BlendInfo info{clipper, masker, opacity, clip};
     RenderState newState(this, state.mode());
     newState.transform = transform * state.transform;
@@ -144,6 +149,7 @@ LayoutGroup::LayoutGroup(Node* node)
 
 void LayoutGroup::render(RenderState& state) const
 {
+    RenderTrace trace("render", this);
     BlendInfo info{clipper, masker, opacity, Rect::Invalid};
     RenderState newState(this, state.mode());
     newState.transform = transform * state.transform;
@@ -179,6 +185,7 @@ Rect LayoutMarker::markerBoundingBox(const Point& origin, double angle, double s
 
 void LayoutMarker::renderMarker(RenderState& state, const Point& origin, double angle, double strokeWidth) const
 {
+    RenderTrace trace("marker", this);
     BlendInfo info{clipper, masker, opacity, clip};
     RenderState newState(this, state.mode());
     newState.transform = transform * markerTransform(origin, angle, strokeWidth) * state.transform;
@@ -279,6 +286,7 @@ void FillData::fill(RenderState& state, const Path& path) const
     if(opacity == 0.0 || (painter == nullptr && color.isNone()))
         return;
 
+    RenderTrace trace("fill", state.object(), painter, false);
     if(painter == nullptr)
         state.canvas->setColor(color);
     else
@@ -292,6 +300,7 @@ void StrokeData::stroke(RenderState& state, const Path& path) const
     if(opacity == 0.0 || (painter == nullptr && color.isNone()))
         return;
 
+    RenderTrace trace("stroke", state.object(), painter, !dash.array.empty());
     if(painter == nullptr)
         state.canvas->setColor(color);
     else
@@ -356,6 +365,7 @@ void LayoutShape::render(RenderState& state) const
     if(visibility == Visibility::Hidden)
         return;
 
+    RenderTrace trace("render", this);
     BlendInfo info{clipper, masker, opacity, Rect::Invalid};
     RenderState newState(this, state.mode());
     newState.transform = transform * state.transform;
@@ -366,6 +376,7 @@ void LayoutShape::render(RenderState& state) const
         strokeData.stroke(newState, path);
         markerData.render(newState);
     } else {
+        RenderTrace fillTrace("fill", this, nullptr, false);
         newState.canvas->setColor(Color::Black);
         newState.canvas->fill(path, newState.transform, clipRule, BlendMode::Src, 1.0);
     }
@@ -400,6 +411,7 @@ RenderState::RenderState(const LayoutObject* object, RenderMode mode)
 
 void RenderState::beginGroup(RenderState& state, const BlendInfo& info)
 {
+    RenderTrace trace("beginGroup", m_object);
     if(!info.clipper && !info.clip.valid()
         && (m_mode == RenderMode::Display && !(info.masker || info.opacity < 1.0))) {
         canvas = state.canvas;
@@ -414,6 +426,7 @@ void RenderState::beginGroup(RenderState& state, const BlendInfo& info)
 
 void RenderState::endGroup(RenderState& state, const BlendInfo& info)
 {
+    RenderTrace trace("endGroup", m_object);
     if(state.canvas == canvas)
         return;
 
@@ -429,6 +442,45 @@ void RenderState::endGroup(RenderState& state, const BlendInfo& info)
     state.canvas->blend(canvas.get(), BlendMode::Src_Over, m_mode == RenderMode::Display ? info.opacity : 1.0);
 }
 
+#ifndef LUNASVG_DISABLE_TRACE
+
+RenderTraceFunction RenderTrace::m_function = nullptr;
+void* RenderTrace::m_userData = nullptr;
+
+bool RenderTrace::setFunction(RenderTraceFunction function, void* userData)
+{
+    m_function = function;
+    m_userData = userData;
+    return true;
+}
+
+static const char* paintname(const LayoutObject* painter)
+{
+    if(painter == nullptr)
+        return "color";
+
+    switch(painter->id()) {
+    case LayoutId::SolidColor: return "solidColor";
+    case LayoutId::LinearGradient: return "linearGradient";
+    case LayoutId::RadialGradient: return "radialGradient";
+    case LayoutId::Pattern: return "pattern";
+    default: return "";
+    }
+}
+
+void RenderTrace::report(bool begin) const
+{
+    RenderTraceEvent event{m_name, "", "", m_painted ? paintname(m_painter) : "", m_dashed, begin};
+    if(auto element = static_cast<const Element*>(m_node)) {
+        event.tag = elementname(element->id());
+        event.id = element->get(PropertyID::Id).c_str();
+    }
+
+    m_function(event, m_userData);
+}
+
+#endif
+
 LayoutContext::LayoutContext(const Document* document, LayoutSymbol* root)
     : m_document(document), m_root(root)
 {
@@ -3,6 +3,7 @@
 
 #include "property.h"
 #include "canvas.h"
+#include "lunasvg.h"
 
 #include <list>
 #include <map>
@@ -300,6 +301,56 @@ private:
     mutable Rect m_strokeBoundingBox{Rect::Invalid};
 };
 
+class RenderTrace {
+public:
+#ifdef LUNASVG_DISABLE_TRACE
+    RenderTrace(const char*, const LayoutObject*) {}
+    RenderTrace(const char*, const LayoutObject*, const LayoutObject*, bool) {}
+    RenderTrace(const char*, const Node*) {}
+
+    static bool setFunction(RenderTraceFunction, void*) { return false; }
+#else
+    RenderTrace(const char* name, const LayoutObject* object)
+        : RenderTrace(name, object->node(), false, nullptr, false)
+    {}
+
+    // filling or stroking with the painter, nullptr for a color
+    RenderTrace(const char* name, const LayoutObject* object, const LayoutObject* painter, bool dashed)
+        : RenderTrace(name, object->node(), true, painter, dashed)
+    {}
+
+    RenderTrace(const char* name, const Node* node)
+        : RenderTrace(name, node, false, nullptr, false)
+    {}
+
+    ~RenderTrace()
+    {
+        if(m_enabled) report(false);
+    }
+
+    static bool setFunction(RenderTraceFunction function, void* userData);
+
+private:
+    RenderTrace(const char* name, const Node* node, bool painted, const LayoutObject* painter, bool dashed)
+        : m_name(name), m_node(node), m_painter(painter), m_painted(painted), m_dashed(dashed), m_enabled(m_function != nullptr)
+    {
+        if(m_enabled) report(true);
+    }
+
+    void report(bool begin) const;
+
+    const char* m_name;
+    const Node* m_node;
+    const LayoutObject* m_painter;
+    bool m_painted;
+    bool m_dashed;
+    bool m_enabled;
+
+    static RenderTraceFunction m_function;
+    static void* m_userData;
+#endif
+};
+
 enum class RenderMode {
     Display,
     Clipping
@@ -2,6 +2,9 @@
 #include "layoutcontext.h"
 #include "parser.h"
 #include "svgelement.h"
+#include "pixelconvert.h"
+#include "compiledlayout.h"
+#include "plutovg.h"
 
 #include <fstream>
 #include <cstring>
@@ -242,34 +245,7 @@ void Bitmap::clear(std::uint32_t color)
 
 void Bitmap::convert(int ri, int gi, int bi, int ai, bool unpremultiply)
 {
-    auto width = this->width();
-    auto height = this->height();
-    auto stride = this->stride();
-    auto rowData = this->data();
-
-    for(std::uint32_t y = 0; y < height; y++) {
-        auto data = rowData;
-        for(std::uint32_t x = 0; x < width; x++) {
-            auto b = data[0];
-            auto g = data[1];
-            auto r = data[2];
-            auto a = data[3];
-
-            if(unpremultiply && a != 0) {
-                r = (r * 255) / a;
-                g = (g * 255) / a;
-                b = (b * 255) / a;
-            }
-
-            data[ri] = r;
-            data[gi] = g;
-            data[bi] = b;
-            data[ai] = a;
-            data += 4;
-        }
-
-        rowData += stride;
-    }
+    convertPixels(data(), width(), height(), stride(), ri, gi, bi, ai, unpremultiply);
 }
 
 DomElement::DomElement(Element* element)
@@ -335,6 +311,25 @@ Matrix DomElement::getAbsoluteTransform() const
     return getLocalTransform();
 }
 
+static void updateBoundingBoxes(const LayoutObject* object)
+{
+    object->fillBoundingBox();
+    object->strokeBoundingBox();
+    switch(object->id()) {
+    case LayoutId::Symbol:
+    case LayoutId::Group:
+    case LayoutId::Mask:
+    case LayoutId::ClipPath:
+    case LayoutId::Marker:
+    case LayoutId::Pattern:
+        for(const auto& child : static_cast<const LayoutContainer*>(object)->children())
+            updateBoundingBoxes(child.get());
+        break;
+    default:
+        break;
+    }
+}
+
 std::unique_ptr<Document> Document::loadFromFile(const std::string& filename)
 {
     std::ifstream fs;
@@ -356,8 +351,8 @@ std::unique_ptr<Document> Document::loadFromData(const std::string& string)
 
 std::unique_ptr<Document> Document::loadFromData(const char* data, std::size_t size)
 {
-    std::unique_ptr<Document> document(new Document);
-    if(!document->parse(data, size))
+    auto document = parseFromData(data, size);
+    if(document == nullptr)
         return nullptr;
     document->updateLayout();
     return document;
@@ -368,6 +363,36 @@ std::unique_ptr<Document> Document::loadFromData(const char* data)
     return loadFromData(data, std::strlen(data));
 }
 
+std::unique_ptr<Document> Document::parseFromData(const char* data, std::size_t size)
+{
+    std::unique_ptr<Document> document(new Document);
+    if(!document->parse(data, size))
+        return nullptr;
+    return document;
+}
+
+std::unique_ptr<Document> Document::loadFromCompiled(const char* data, std::size_t size)
+{
+    auto root = loadCompiledLayout(data, size);
+    if(root == nullptr)
+        return nullptr;
+
+    std::unique_ptr<Document> document(new Document);
+    document->m_rootBox = std::move(root);
+    updateBoundingBoxes(document->m_rootBox.get());
+    return document;
+}
+
+bool Document::isCompiled(const char* data, std::size_t size)
+{
+    return isCompiledLayout(data, size);
+}
+
+std::string Document::compile() const
+{
+    return compileLayout(m_rootBox.get());
+}
+
 void Document::setMatrix(const Matrix& matrix)
 {
     if(m_rootBox) {
@@ -435,7 +460,15 @@ Bitmap Document::renderToBitmap(std::uint32_t width, std::uint32_t height, std::
 
 void Document::updateLayout()
 {
+    // a compiled document has only the layout
+    if(m_rootElement == nullptr)
+        return;
     m_rootBox = m_rootElement->layoutTree(this);
+    if(m_rootBox) {
+        // bounding boxes are computed lazily, computing them all here makes
+        // render() read only, so a document can be rendered from several threads
+        updateBoundingBoxes(m_rootBox.get());
+    }
 }
 
 DomElement Document::getElementById(const std::string& id) const
@@ -455,4 +488,14 @@ Document::Document(Document&&) = default;
 Document::~Document() = default;
 Document::Document() = default;
 
+void setRenderMemoryFunctions(void* (*mallocFunc)(std::size_t), void* (*reallocFunc)(void*, std::size_t), void (*freeFunc)(void*))
+{
+    plutovg_set_memory_functions(mallocFunc, reallocFunc, freeFunc);
+}
+
+bool setRenderTraceFunction(RenderTraceFunction traceFunc, void* userData)
+{
+    return RenderTrace::setFunction(traceFunc, userData);
+}
+
 } // namespace lunasvg
@@ -999,6 +999,34 @@ ElementID elementid(const std::string& name)
     return it->second;
 }
 
+const char* elementname(ElementID id)
+{
+    switch(id) {
+    case ElementID::Circle: return "circle";
+    case ElementID::ClipPath: return "clipPath";
+    case ElementID::Defs: return "defs";
+    case ElementID::Ellipse: return "ellipse";
+    case ElementID::G: return "g";
+    case ElementID::Line: return "line";
+    case ElementID::LinearGradient: return "linearGradient";
+    case ElementID::Marker: return "marker";
+    case ElementID::Mask: return "mask";
+    case ElementID::Path: return "path";
+    case ElementID::Pattern: return "pattern";
+    case ElementID::Polygon: return "polygon";
+    case ElementID::Polyline: return "polyline";
+    case ElementID::RadialGradient: return "radialGradient";
+    case ElementID::Rect: return "rect";
+    case ElementID::Stop: return "stop";
+    case ElementID::Style: return "style";
+    case ElementID::SolidColor: return "solidColor";
+    case ElementID::Svg: return "svg";
+    case ElementID::Symbol: return "symbol";
+    case ElementID::Use: return "use";
+    default: return "";
+    }
+}
+
 PropertyID csspropertyid(const std::string& name)
 {
     static const std::map<std::string, PropertyID> csspropertymap = {
@@ -1684,6 +1712,7 @@ bool Document::parse(const char* data, std::size_t size)
         else
             decodeText(start, end, value);
 
+        RenderTrace trace("css", current);
         removeComments(value);
         styleSheet.parse(value);
     };
@@ -1828,6 +1857,7 @@ bool Document::parse(const char* data, std::size_t size)
             if(attrId != PropertyID::Unknown) {
                 decodeText(start, Utils::rtrim(start, ptr), value);
                 if(attrId == PropertyID::Style) {
+                    RenderTrace trace("css", element);
                     removeComments(value);
                     parseStyle(value, element);
                 } else {
@@ -1867,6 +1897,7 @@ bool Document::parse(const char* data, std::size_t size)
     if(!m_rootElement || ptr < end || ignoring > 0)
         return false;
     if(!styleSheet.empty()) {
+        RenderTrace trace("css", m_rootElement.get());
         m_rootElement->transverse([&styleSheet](Node* node) {
             if(node->isText())
                 return true;
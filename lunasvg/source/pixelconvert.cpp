@@ -0,0 +1,199 @@
+#include "pixelconvert.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LUNASVG_HAS_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(LUNASVG_HAS_SSE2) && (defined(_MSC_VER) || defined(__GNUC__) || defined(__clang__))
+#define LUNASVG_HAS_AVX2
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define LUNASVG_TARGET_AVX2
+#else
+#define LUNASVG_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace lunasvg {
+
+using ConvertRowFunc = void (*)(std::uint8_t* data, std::uint32_t count, int ri, int gi, int bi, int ai, bool unpremultiply);
+
+static void convertRowScalar(std::uint8_t* data, std::uint32_t count, int ri, int gi, int bi, int ai, bool unpremultiply)
+{
+    for(std::uint32_t x = 0; x < count; x++) {
+        auto b = data[0];
+        auto g = data[1];
+        auto r = data[2];
+        auto a = data[3];
+
+        if(unpremultiply && a != 0) {
+            r = (r * 255) / a;
+            g = (g * 255) / a;
+            b = (b * 255) / a;
+        }
+
+        data[ri] = r;
+        data[gi] = g;
+        data[bi] = b;
+        data[ai] = a;
+        data += 4;
+    }
+}
+
+// The SIMD kernels divide in single precision: c * 255 and a are exact in float
+// and the correctly rounded quotient, which is below 2^16, is always less than
+// 1/512 away from the exact one, while a fractional quotient is at least 1/255
+// away from the nearest integer. Truncation therefore yields the same value as
+// the integer division, the low byte is kept just like in the scalar code.
+
+#ifdef LUNASVG_HAS_SSE2
+
+static void convertRowSSE2(std::uint8_t* data, std::uint32_t count, int ri, int gi, int bi, int ai, bool unpremultiply)
+{
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 scale = _mm_set1_ps(255.f);
+    const __m128i rshift = _mm_cvtsi32_si128(ri * 8);
+    const __m128i gshift = _mm_cvtsi32_si128(gi * 8);
+    const __m128i bshift = _mm_cvtsi32_si128(bi * 8);
+    const __m128i ashift = _mm_cvtsi32_si128(ai * 8);
+
+    std::uint32_t x = 0;
+    for(; x + 4 <= count; x += 4) {
+        auto pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        auto b = _mm_and_si128(pixels, mask);
+        auto g = _mm_and_si128(_mm_srli_epi32(pixels, 8), mask);
+        auto r = _mm_and_si128(_mm_srli_epi32(pixels, 16), mask);
+        auto a = _mm_srli_epi32(pixels, 24);
+
+        if(unpremultiply) {
+            auto alpha = _mm_cvtepi32_ps(a);
+            auto transparent = _mm_cmpeq_epi32(a, zero);
+            auto ur = _mm_cvttps_epi32(_mm_div_ps(_mm_mul_ps(_mm_cvtepi32_ps(r), scale), alpha));
+            auto ug = _mm_cvttps_epi32(_mm_div_ps(_mm_mul_ps(_mm_cvtepi32_ps(g), scale), alpha));
+            auto ub = _mm_cvttps_epi32(_mm_div_ps(_mm_mul_ps(_mm_cvtepi32_ps(b), scale), alpha));
+            r = _mm_or_si128(_mm_and_si128(transparent, r), _mm_andnot_si128(transparent, _mm_and_si128(ur, mask)));
+            g = _mm_or_si128(_mm_and_si128(transparent, g), _mm_andnot_si128(transparent, _mm_and_si128(ug, mask)));
+            b = _mm_or_si128(_mm_and_si128(transparent, b), _mm_andnot_si128(transparent, _mm_and_si128(ub, mask)));
+        }
+
+        pixels = _mm_or_si128(_mm_or_si128(_mm_sll_epi32(r, rshift), _mm_sll_epi32(g, gshift)),
+                              _mm_or_si128(_mm_sll_epi32(b, bshift), _mm_sll_epi32(a, ashift)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data), pixels);
+        data += 16;
+    }
+
+    convertRowScalar(data, count - x, ri, gi, bi, ai, unpremultiply);
+}
+
+#endif // LUNASVG_HAS_SSE2
+
+#ifdef LUNASVG_HAS_AVX2
+
+LUNASVG_TARGET_AVX2
+static void convertRowAVX2(std::uint8_t* data, std::uint32_t count, int ri, int gi, int bi, int ai, bool unpremultiply)
+{
+    const __m256i mask = _mm256_set1_epi32(0xFF);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256 scale = _mm256_set1_ps(255.f);
+    const __m128i rshift = _mm_cvtsi32_si128(ri * 8);
+    const __m128i gshift = _mm_cvtsi32_si128(gi * 8);
+    const __m128i bshift = _mm_cvtsi32_si128(bi * 8);
+    const __m128i ashift = _mm_cvtsi32_si128(ai * 8);
+
+    std::uint32_t x = 0;
+    for(; x + 8 <= count; x += 8) {
+        auto pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+        auto b = _mm256_and_si256(pixels, mask);
+        auto g = _mm256_and_si256(_mm256_srli_epi32(pixels, 8), mask);
+        auto r = _mm256_and_si256(_mm256_srli_epi32(pixels, 16), mask);
+        auto a = _mm256_srli_epi32(pixels, 24);
+
+        if(unpremultiply) {
+            auto alpha = _mm256_cvtepi32_ps(a);
+            auto transparent = _mm256_cmpeq_epi32(a, zero);
+            auto ur = _mm256_cvttps_epi32(_mm256_div_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(r), scale), alpha));
+            auto ug = _mm256_cvttps_epi32(_mm256_div_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(g), scale), alpha));
+            auto ub = _mm256_cvttps_epi32(_mm256_div_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(b), scale), alpha));
+            r = _mm256_blendv_epi8(_mm256_and_si256(ur, mask), r, transparent);
+            g = _mm256_blendv_epi8(_mm256_and_si256(ug, mask), g, transparent);
+            b = _mm256_blendv_epi8(_mm256_and_si256(ub, mask), b, transparent);
+        }
+
+        pixels = _mm256_or_si256(_mm256_or_si256(_mm256_sll_epi32(r, rshift), _mm256_sll_epi32(g, gshift)),
+                                 _mm256_or_si256(_mm256_sll_epi32(b, bshift), _mm256_sll_epi32(a, ashift)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(data), pixels);
+        data += 32;
+    }
+
+    convertRowSSE2(data, count - x, ri, gi, bi, ai, unpremultiply);
+}
+
+static bool cpuSupportsAVX2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if(info[0] < 7)
+        return false;
+
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if(!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // LUNASVG_HAS_AVX2
+
+struct ConvertKernel {
+    ConvertRowFunc func;
+    const char* name;
+};
+
+static ConvertKernel selectKernel()
+{
+#ifdef LUNASVG_HAS_AVX2
+    if(cpuSupportsAVX2())
+        return ConvertKernel{convertRowAVX2, "avx2"};
+#endif
+#ifdef LUNASVG_HAS_SSE2
+    return ConvertKernel{convertRowSSE2, "sse2"};
+#else
+    return ConvertKernel{convertRowScalar, "scalar"};
+#endif
+}
+
+static const ConvertKernel& kernel()
+{
+    static const ConvertKernel selected = selectKernel();
+    return selected;
+}
+
+void convertPixels(std::uint8_t* data, std::uint32_t width, std::uint32_t height, std::uint32_t stride, int ri, int gi, int bi, int ai, bool unpremultiply)
+{
+    if(!unpremultiply && ri == 2 && gi == 1 && bi == 0 && ai == 3)
+        return;
+
+    auto convertRow = kernel().func;
+    for(std::uint32_t y = 0; y < height; y++) {
+        convertRow(data, width, ri, gi, bi, ai, unpremultiply);
+        data += stride;
+    }
+}
+
+const char* convertPixelsKernel()
+{
+    return kernel().name;
+}
+
+} // namespace lunasvg
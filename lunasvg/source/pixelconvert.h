@@ -0,0 +1,25 @@
+#ifndef PIXELCONVERT_H
+#define PIXELCONVERT_H
+
+#include <cstdint>
+
+namespace lunasvg {
+
+/**
+ * @brief Converts ARGB32 premultiplied pixels in place
+ * @param ri, gi, bi, ai - byte index of each channel in the converted pixel
+ * @param unpremultiply - whether to convert to straight alpha
+ * @note The result is identical to dividing each color channel by alpha
+ * with integer arithmetic, regardless of which conversion kernel is used.
+ */
+void convertPixels(std::uint8_t* data, std::uint32_t width, std::uint32_t height, std::uint32_t stride, int ri, int gi, int bi, int ai, bool unpremultiply);
+
+/**
+ * @brief Returns the name of the conversion kernel selected for this CPU
+ * @return "avx2", "sse2" or "scalar"
+ */
+const char* convertPixelsKernel();
+
+} // namespace lunasvg
+
+#endif // PIXELCONVERT_H
@@ -0,0 +1,176 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        perfcounters.cpp
+// Purpose:     Reading hardware performance counters for benchmarks
+// Author:      PB
+// Created:     2024-01-18
+// Copyright:   (c) 2024 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+    #include <linux/perf_event.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+#include "perfcounters.h"
+
+const char* GetPerfEventName(PerfEvent event)
+{
+    switch ( event )
+    {
+        case PerfEvent_Cycles:       return "cycles";
+        case PerfEvent_Instructions: return "instructions";
+        case PerfEvent_L1DMisses:    return "l1dMisses";
+        case PerfEvent_LLCMisses:    return "llcMisses";
+        case PerfEvent_BranchMisses: return "branchMisses";
+        case PerfEvent_Count:        break;
+    }
+
+    return "";
+}
+
+// ============================================================================
+// PerfCounts
+// ============================================================================
+
+double PerfCounts::GetIPC() const
+{
+    if ( !available[PerfEvent_Cycles] || !available[PerfEvent_Instructions] || values[PerfEvent_Cycles] == 0 )
+        return 0;
+
+    return static_cast<double>(values[PerfEvent_Instructions]) / values[PerfEvent_Cycles];
+}
+
+PerfCounts& PerfCounts::operator+=(const PerfCounts& other)
+{
+    for ( size_t i = 0; i < PerfEvent_Count; ++i )
+    {
+        available[i] = available[i] && other.available[i];
+        values[i] = available[i] ? values[i] + other.values[i] : 0;
+    }
+
+    return *this;
+}
+
+PerfCounts operator-(const PerfCounts& a, const PerfCounts& b)
+{
+    PerfCounts result;
+
+    for ( size_t i = 0; i < PerfEvent_Count; ++i )
+    {
+        // a scaled count may be slightly smaller than the previous one
+        result.available[i] = a.available[i] && b.available[i];
+        result.values[i] = result.available[i] && a.values[i] > b.values[i] ? a.values[i] - b.values[i] : 0;
+    }
+
+    return result;
+}
+
+// ============================================================================
+// PerfCounters
+// ============================================================================
+
+#ifdef __linux__
+
+PerfCounters::PerfCounters()
+{
+    const auto cacheMiss = [](std::uint64_t cache)
+    {
+        return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    };
+
+    const struct
+    {
+        std::uint32_t type;
+        std::uint64_t config;
+    } events[PerfEvent_Count] =
+    {
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_L1D) },
+        { PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_LL) },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    };
+
+    for ( size_t i = 0; i < PerfEvent_Count; ++i )
+    {
+        perf_event_attr attr;
+
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = events[i].type;
+        attr.config = events[i].config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        // the calling thread on any CPU
+        m_fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+        if ( m_fds[i] == -1 && m_error.empty() )
+            m_error = std::string("perf_event_open() failed: ") + std::strerror(errno);
+    }
+}
+
+PerfCounters::~PerfCounters()
+{
+    for ( const int fd : m_fds )
+    {
+        if ( fd != -1 )
+            close(fd);
+    }
+}
+
+PerfCounts PerfCounters::Read() const
+{
+    PerfCounts counts;
+
+    for ( size_t i = 0; i < PerfEvent_Count; ++i )
+    {
+        std::uint64_t data[3]; // value, time enabled, time running
+
+        if ( m_fds[i] == -1 || read(m_fds[i], data, sizeof(data)) != sizeof(data) || data[2] == 0 )
+            continue;
+
+        counts.available[i] = true;
+        counts.values[i] = data[2] < data[1]
+                           ? static_cast<std::uint64_t>(static_cast<double>(data[0]) * data[1] / data[2])
+                           : data[0];
+    }
+
+    return counts;
+}
+
+#else // !__linux__
+
+PerfCounters::PerfCounters()
+    : m_error("hardware performance counters are supported only on Linux")
+{
+    for ( int& fd : m_fds )
+        fd = -1;
+}
+
+PerfCounters::~PerfCounters()
+{
+}
+
+PerfCounts PerfCounters::Read() const
+{
+    return PerfCounts();
+}
+
+#endif // #ifdef __linux__
+
+bool PerfCounters::IsAvailable() const
+{
+    for ( const int fd : m_fds )
+    {
+        if ( fd != -1 )
+            return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,82 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        perfcounters.h
+// Purpose:     Reading hardware performance counters for benchmarks
+// Author:      PB
+// Created:     2024-01-18
+// Copyright:   (c) 2024 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef PERFCOUNTERS_H_DEFINED
+#define PERFCOUNTERS_H_DEFINED
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Does not depend on wxWidgets
+
+enum PerfEvent
+{
+    PerfEvent_Cycles,
+    PerfEvent_Instructions,
+    PerfEvent_L1DMisses,   // L1 data cache read misses
+    PerfEvent_LLCMisses,   // last level cache read misses
+    PerfEvent_BranchMisses,
+
+    PerfEvent_Count
+};
+
+// returns a name of the event suitable for JSON and CSV, e.g., "l1dMisses"
+const char* GetPerfEventName(PerfEvent event);
+
+struct PerfCounts
+{
+    std::uint64_t values[PerfEvent_Count]{};
+    bool          available[PerfEvent_Count]{};
+
+    // returns 0 if cycles or instructions are not available
+    double GetIPC() const;
+
+    // counts of events available in both are added, the others become unavailable
+    PerfCounts& operator+=(const PerfCounts& other);
+};
+
+// returns the counts of events available in both, the others are unavailable
+PerfCounts operator-(const PerfCounts& a, const PerfCounts& b);
+
+/*
+    Counts the hardware events in the user space code run by the thread which
+    created the instance, from its creation. Uses perf_event_open() and is
+    available only on Linux; even there, some or all of the events may be
+    unavailable, e.g., in virtual machines or when not permitted by
+    /proc/sys/kernel/perf_event_paranoid. The events which could not be
+    opened are not available in the counts, the others still are.
+
+    When the kernel has to multiplex the counters, the counts are scaled
+    to the whole time the instance existed.
+*/
+class PerfCounters
+{
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    // returns true if at least one event is available
+    bool IsAvailable() const;
+
+    // returns the reason why the events are not available, if any
+    const std::string& GetError() const { return m_error; }
+
+    // returns the counts since the instance was created
+    PerfCounts Read() const;
+
+private:
+    int         m_fds[PerfEvent_Count];
+    std::string m_error;
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+};
+
+#endif // #ifndef PERFCOUNTERS_H_DEFINED
@@ -0,0 +1,611 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        plutovgbench.c
+// Purpose:     Microbenchmarks of plutovg rasterization kernels
+// Author:      PB
+// Created:     2024-01-18
+// Copyright:   (c) 2024 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+    Measures the hot kernels of plutovg (the rasterizer used by LunaSVG)
+    in isolation, with synthetic inputs, so that optimizing a kernel can be
+    evaluated without the noise of the rest of SVG rendering.
+
+    The blending and gradient kernels are static functions, so this file
+    includes plutovg-blend.c and plutovg-rle.c instead of linking to them;
+    the executable is built from the plutovg sources and does not use LunaSVG.
+
+    Every case is repeated in batches taking at least MinBatchMilliseconds
+    and the median and minimum time per unit (pixel, span or outline point)
+    of runs batches is reported.
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "plutovg-blend.c"
+#include "plutovg-rle.c"
+
+static const double MinBatchMilliseconds = 10;
+
+// ============================================================================
+// timing
+// ============================================================================
+
+static double GetTimeNs(void)
+{
+    struct timespec ts;
+
+#ifdef _WIN32
+    timespec_get(&ts, TIME_UTC);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int CompareDoubles(const void* a, const void* b)
+{
+    const double da = *(const double*)a;
+    const double db = *(const double*)b;
+
+    return (da > db) - (da < db);
+}
+
+typedef struct
+{
+    const char* kernel;
+    char        name[64];
+    const char* unit;
+    double      unitCount; // processed by one call of run
+    void      (*run)(void* data);
+    void*       data;
+} BenchCase;
+
+typedef struct
+{
+    double median; // nanoseconds per unit
+    double min;
+    size_t iterationCount;
+} BenchResult;
+
+static BenchResult RunCase(const BenchCase* bc, size_t runCount)
+{
+    BenchResult result;
+    size_t      iterationCount = 1;
+    double*     times = malloc(runCount * sizeof(double));
+
+    // find the number of iterations for a batch long enough
+    for ( ;; )
+    {
+        const double start = GetTimeNs();
+
+        for ( size_t i = 0; i < iterationCount; ++i )
+            bc->run(bc->data);
+
+        if ( GetTimeNs() - start >= MinBatchMilliseconds * 1e6 || iterationCount >= ((size_t)1 << 30) )
+            break;
+        iterationCount *= 2;
+    }
+
+    for ( size_t run = 0; run < runCount; ++run )
+    {
+        const double start = GetTimeNs();
+
+        for ( size_t i = 0; i < iterationCount; ++i )
+            bc->run(bc->data);
+
+        times[run] = (GetTimeNs() - start) / (iterationCount * bc->unitCount);
+    }
+
+    qsort(times, runCount, sizeof(double), CompareDoubles);
+    result.median = runCount % 2 ? times[runCount / 2] : (times[runCount / 2 - 1] + times[runCount / 2]) / 2;
+    result.min = times[0];
+    result.iterationCount = iterationCount;
+
+    free(times);
+    return result;
+}
+
+// ============================================================================
+// composition
+// ============================================================================
+
+#define MaxSpanLength 1024
+
+typedef struct
+{
+    int      length;
+    uint32_t color; // premultiplied
+    uint32_t constAlpha;
+    uint32_t dest[MaxSpanLength];
+    uint32_t src[MaxSpanLength];
+} CompositionData;
+
+static void RunCompositionSolidSourceOver(void* data)
+{
+    CompositionData* d = data;
+
+    composition_solid_source_over(d->dest, d->length, d->color, d->constAlpha);
+}
+
+static void RunCompositionSourceOver(void* data)
+{
+    CompositionData* d = data;
+
+    composition_source_over(d->dest, d->length, d->src, d->constAlpha);
+}
+
+static void InitCompositionData(CompositionData* d, int length, uint32_t constAlpha)
+{
+    d->length = length;
+    d->color = 0x80402010;
+    d->constAlpha = constAlpha;
+
+    // semi-transparent premultiplied pixels with varying alpha, like a gradient
+    for ( int i = 0; i < MaxSpanLength; ++i )
+    {
+        const uint32_t a = i % 256;
+
+        d->dest[i] = 0xff808080;
+        d->src[i] = (a << 24) | ((a / 2) << 16) | ((a / 3) << 8) | (a / 4);
+    }
+}
+
+// ============================================================================
+// gradients
+// ============================================================================
+
+typedef struct
+{
+    int                      length;
+    gradient_data_t          gradient;
+    linear_gradient_values_t linear;
+    radial_gradient_values_t radial;
+    uint32_t                 buffer[MaxSpanLength];
+} GradientData;
+
+static void RunFetchLinearGradient(void* data)
+{
+    GradientData* d = data;
+
+    fetch_linear_gradient(d->buffer, &d->linear, &d->gradient, 7, 0, d->length);
+}
+
+static void RunFetchRadialGradient(void* data)
+{
+    GradientData* d = data;
+
+    fetch_radial_gradient(d->buffer, &d->radial, &d->gradient, 7, 0, d->length);
+}
+
+// the gradient spans the whole span length, the values are computed
+// the same as in blend_linear_gradient() and blend_radial_gradient(),
+// focal is used only for a radial gradient
+static void InitGradientData(GradientData* d, int length, plutovg_spread_method_t spread, int radial, int focal)
+{
+    d->length = length;
+    d->gradient.spread = spread;
+    plutovg_matrix_init_identity(&d->gradient.matrix);
+
+    // from opaque red to semi-transparent blue
+    for ( int i = 0; i < COLOR_TABLE_SIZE; ++i )
+    {
+        const uint32_t t = i * 255 / (COLOR_TABLE_SIZE - 1);
+        const uint32_t a = 255 - t / 2;
+
+        d->gradient.colortable[i] = (a << 24) | ((255 - t) * a / 255 << 16) | (t * a / 255);
+    }
+
+    if ( !radial )
+    {
+        d->gradient.linear.x1 = 0;
+        d->gradient.linear.y1 = 0;
+        d->gradient.linear.x2 = length / 2.0;
+        d->gradient.linear.y2 = length / 4.0;
+
+        d->linear.dx = d->gradient.linear.x2 - d->gradient.linear.x1;
+        d->linear.dy = d->gradient.linear.y2 - d->gradient.linear.y1;
+        d->linear.l = d->linear.dx * d->linear.dx + d->linear.dy * d->linear.dy;
+        d->linear.dx /= d->linear.l;
+        d->linear.dy /= d->linear.l;
+        d->linear.off = -d->linear.dx * d->gradient.linear.x1 - d->linear.dy * d->gradient.linear.y1;
+        return;
+    }
+
+    d->gradient.radial.cx = length / 2.0;
+    d->gradient.radial.cy = length / 2.0;
+    d->gradient.radial.cr = length / 2.0;
+    d->gradient.radial.fx = focal ? length / 3.0 : d->gradient.radial.cx;
+    d->gradient.radial.fy = focal ? length / 3.0 : d->gradient.radial.cy;
+    d->gradient.radial.fr = focal ? length / 16.0 : 0;
+
+    d->radial.dx = d->gradient.radial.cx - d->gradient.radial.fx;
+    d->radial.dy = d->gradient.radial.cy - d->gradient.radial.fy;
+    d->radial.dr = d->gradient.radial.cr - d->gradient.radial.fr;
+    d->radial.sqrfr = d->gradient.radial.fr * d->gradient.radial.fr;
+    d->radial.a = d->radial.dr * d->radial.dr - d->radial.dx * d->radial.dx - d->radial.dy * d->radial.dy;
+    d->radial.inv2a = 1.0 / (2.0 * d->radial.a);
+    d->radial.extended = d->gradient.radial.fr != 0.0 || d->radial.a <= 0.0;
+}
+
+// ============================================================================
+// paths, outlines and RLEs
+// ============================================================================
+
+typedef enum
+{
+    Shape_Circle, // cubic curves
+    Shape_Star    // many straight edges crossing each other
+} Shape;
+
+static plutovg_path_t* CreatePath(Shape shape, double size)
+{
+    plutovg_path_t* path = plutovg_path_create();
+
+    if ( shape == Shape_Circle )
+    {
+        plutovg_path_add_circle(path, size / 2, size / 2, size * 0.45);
+    }
+    else
+    {
+        const int pointCount = 24;
+
+        for ( int i = 0; i < pointCount; ++i )
+        {
+            // every point is connected to the one 11 points farther
+            const double angle = plutovg_two_pi * ((i * 11) % pointCount) / pointCount;
+            const double x = size / 2 + cos(angle) * size * 0.45;
+            const double y = size / 2 + sin(angle) * size * 0.45;
+
+            if ( i == 0 )
+                plutovg_path_move_to(path, x, y);
+            else
+                plutovg_path_line_to(path, x, y);
+        }
+        plutovg_path_close(path);
+    }
+
+    return path;
+}
+
+static const char* GetShapeName(Shape shape)
+{
+    return shape == Shape_Circle ? "circle" : "star";
+}
+
+// the outline data are owned by pluto
+typedef struct
+{
+    plutovg_surface_t* surface;
+    plutovg_t*         pluto;
+    PVG_FT_Outline     outline;
+} OutlineData;
+
+static void InitOutlineData(OutlineData* d, Shape shape, double size)
+{
+    plutovg_path_t*  path = CreatePath(shape, size);
+    plutovg_matrix_t matrix;
+
+    plutovg_matrix_init_identity(&matrix);
+
+    d->surface = plutovg_surface_create(1, 1);
+    d->pluto = plutovg_create(d->surface);
+    ft_outline_convert(&d->outline, d->pluto, path, &matrix);
+    d->outline.flags = shape == Shape_Star ? PVG_FT_OUTLINE_EVEN_ODD_FILL : PVG_FT_OUTLINE_NONE;
+
+    plutovg_path_destroy(path);
+}
+
+static void FreeOutlineData(OutlineData* d)
+{
+    plutovg_destroy(d->pluto);
+    plutovg_surface_destroy(d->surface);
+}
+
+static void CountSpans(int count, const PVG_FT_Span* spans, void* user)
+{
+    (void)spans;
+    *(int*)user += count;
+}
+
+typedef struct
+{
+    OutlineData outline;
+    int         spanCount;
+} RasterData;
+
+static void RunRasterRender(void* data)
+{
+    RasterData*          d = data;
+    PVG_FT_Raster_Params params;
+
+    memset(&params, 0, sizeof(params));
+    params.flags = PVG_FT_RASTER_FLAG_DIRECT | PVG_FT_RASTER_FLAG_AA;
+    params.gray_spans = CountSpans;
+    params.user = &d->spanCount;
+    params.source = &d->outline.outline;
+
+    d->spanCount = 0;
+    PVG_FT_Raster_Render(&params);
+}
+
+typedef struct
+{
+    OutlineData    outline;
+    PVG_FT_Stroker stroker;
+} StrokerData;
+
+static void RunStrokerParseOutline(void* data)
+{
+    StrokerData* d = data;
+
+    PVG_FT_Stroker_ParseOutline(d->stroker, &d->outline.outline);
+}
+
+typedef struct
+{
+    plutovg_rle_t* a;
+    plutovg_rle_t* b;
+} IntersectionData;
+
+static void RunRleIntersection(void* data)
+{
+    IntersectionData* d = data;
+
+    plutovg_rle_destroy(plutovg_rle_intersection(d->a, d->b));
+}
+
+static plutovg_rle_t* CreateRle(plutovg_t* pluto, Shape shape, double size, double offset)
+{
+    plutovg_path_t*  path = CreatePath(shape, size);
+    plutovg_rle_t*   rle = plutovg_rle_create();
+    plutovg_matrix_t matrix;
+
+    plutovg_matrix_init_translate(&matrix, offset, offset);
+    plutovg_rle_rasterize(pluto, rle, path, &matrix, NULL, NULL,
+                          shape == Shape_Star ? plutovg_fill_rule_even_odd : plutovg_fill_rule_non_zero);
+
+    plutovg_path_destroy(path);
+    return rle;
+}
+
+// ============================================================================
+// main
+// ============================================================================
+
+static void PrintUsage(const char* programName)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --runs <count>        number of timed batches for each case (default: 10)\n"
+            "  --filter <text>       run only the kernels whose name contains text\n"
+            "  --csv <file>          write results as CSV, '-' for standard output\n"
+            "  --help                show this help\n",
+            programName);
+}
+
+int main(int argc, char** argv)
+{
+    size_t      runCount = 10;
+    const char* filter = NULL;
+    const char* csvPath = NULL;
+
+    for ( int i = 1; i < argc; ++i )
+    {
+        const int hasValue = i + 1 < argc;
+
+        if ( strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0 )
+        {
+            PrintUsage(argv[0]);
+            return EXIT_SUCCESS;
+        }
+        else if ( strcmp(argv[i], "--runs") == 0 && hasValue )
+        {
+            runCount = strtoul(argv[++i], NULL, 10);
+            if ( runCount == 0 )
+            {
+                fprintf(stderr, "Invalid run count '%s'.\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        }
+        else if ( strcmp(argv[i], "--filter") == 0 && hasValue )
+            filter = argv[++i];
+        else if ( strcmp(argv[i], "--csv") == 0 && hasValue )
+            csvPath = argv[++i];
+        else
+        {
+            fprintf(stderr, "Unknown or incomplete option '%s'.\n", argv[i]);
+            PrintUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // inputs, all created before any case runs
+
+    static const int      spanLengths[] = { 8, 64, 1024 };
+    static const uint32_t constAlphas[] = { 255, 128 };
+    static const double   shapeSizes[] = { 48, 256 };
+    static const Shape    shapes[] = { Shape_Circle, Shape_Star };
+
+#define ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+    enum
+    {
+        CompositionCount = ARRAY_SIZE(spanLengths) * ARRAY_SIZE(constAlphas),
+        GradientCount = ARRAY_SIZE(spanLengths) + 1,
+        OutlineCount = ARRAY_SIZE(shapeSizes) * ARRAY_SIZE(shapes),
+        MaxCaseCount = 2 * CompositionCount + 2 * GradientCount + 3 * OutlineCount
+    };
+
+    static CompositionData  compositionData[CompositionCount];
+    static GradientData     gradientData[GradientCount * 2];
+    static RasterData       rasterData[OutlineCount];
+    static StrokerData      strokerData[OutlineCount];
+    static IntersectionData intersectionData[OutlineCount];
+
+    BenchCase cases[MaxCaseCount];
+    size_t    caseCount = 0;
+
+    memset(cases, 0, sizeof(cases));
+
+    for ( size_t l = 0; l < ARRAY_SIZE(spanLengths); ++l )
+    {
+        for ( size_t a = 0; a < ARRAY_SIZE(constAlphas); ++a )
+        {
+            CompositionData* d = &compositionData[l * ARRAY_SIZE(constAlphas) + a];
+
+            InitCompositionData(d, spanLengths[l], constAlphas[a]);
+
+            BenchCase* bc = &cases[caseCount++];
+            bc->kernel = "composition_solid_source_over";
+            bc->run = RunCompositionSolidSourceOver;
+
+            BenchCase* bcs = &cases[caseCount++];
+            bcs->kernel = "composition_source_over";
+            bcs->run = RunCompositionSourceOver;
+
+            for ( BenchCase* c = bc; c <= bcs; ++c )
+            {
+                snprintf(c->name, sizeof(c->name), "length %d, coverage %u", spanLengths[l], constAlphas[a]);
+                c->unit = "pixel";
+                c->unitCount = spanLengths[l];
+                c->data = d;
+            }
+        }
+    }
+
+    for ( size_t g = 0; g < GradientCount; ++g )
+    {
+        // the last one is the longest span with reflect spread and the focal radial gradient
+        const int  isLast = g == ARRAY_SIZE(spanLengths);
+        const int  length = isLast ? MaxSpanLength : spanLengths[g];
+        GradientData* linear = &gradientData[g * 2];
+        GradientData* radial = &gradientData[g * 2 + 1];
+
+        InitGradientData(linear, length, isLast ? plutovg_spread_method_reflect : plutovg_spread_method_pad, 0, 0);
+        InitGradientData(radial, length, plutovg_spread_method_pad, 1, isLast);
+
+        BenchCase* bc = &cases[caseCount++];
+        bc->kernel = "fetch_linear_gradient";
+        snprintf(bc->name, sizeof(bc->name), "length %d, %s", length, isLast ? "reflect" : "pad");
+        bc->unit = "pixel";
+        bc->unitCount = length;
+        bc->run = RunFetchLinearGradient;
+        bc->data = linear;
+
+        bc = &cases[caseCount++];
+        bc->kernel = "fetch_radial_gradient";
+        snprintf(bc->name, sizeof(bc->name), "length %d, %s", length, isLast ? "focal" : "simple");
+        bc->unit = "pixel";
+        bc->unitCount = length;
+        bc->run = RunFetchRadialGradient;
+        bc->data = radial;
+    }
+
+    for ( size_t s = 0; s < ARRAY_SIZE(shapeSizes); ++s )
+    {
+        for ( size_t h = 0; h < ARRAY_SIZE(shapes); ++h )
+        {
+            const size_t index = s * ARRAY_SIZE(shapes) + h;
+            const double size = shapeSizes[s];
+            const Shape  shape = shapes[h];
+
+            RasterData* rd = &rasterData[index];
+
+            InitOutlineData(&rd->outline, shape, size);
+            RunRasterRender(rd);
+
+            BenchCase* bc = &cases[caseCount++];
+            bc->kernel = "PVG_FT_Raster_Render";
+            snprintf(bc->name, sizeof(bc->name), "%s %gx%g", GetShapeName(shape), size, size);
+            bc->unit = "span";
+            bc->unitCount = rd->spanCount;
+            bc->run = RunRasterRender;
+            bc->data = rd;
+
+            StrokerData* sd = &strokerData[index];
+
+            InitOutlineData(&sd->outline, shape, size);
+            PVG_FT_Stroker_New(&sd->stroker);
+            PVG_FT_Stroker_Set(sd->stroker, 2 << 6, PVG_FT_STROKER_LINECAP_BUTT,
+                               PVG_FT_STROKER_LINEJOIN_MITER_FIXED, 4 << 16);
+
+            bc = &cases[caseCount++];
+            bc->kernel = "PVG_FT_Stroker_ParseOutline";
+            snprintf(bc->name, sizeof(bc->name), "%s %gx%g, width 4", GetShapeName(shape), size, size);
+            bc->unit = "point";
+            bc->unitCount = sd->outline.outline.n_points;
+            bc->run = RunStrokerParseOutline;
+            bc->data = sd;
+
+            // the shape intersected with itself shifted by a quarter
+            IntersectionData* id = &intersectionData[index];
+
+            id->a = CreateRle(rd->outline.pluto, shape, size, 0);
+            id->b = CreateRle(rd->outline.pluto, shape, size, size / 4);
+
+            bc = &cases[caseCount++];
+            bc->kernel = "plutovg_rle_intersection";
+            snprintf(bc->name, sizeof(bc->name), "%s %gx%g", GetShapeName(shape), size, size);
+            bc->unit = "span";
+            bc->unitCount = id->a->spans.size + id->b->spans.size;
+            bc->run = RunRleIntersection;
+            bc->data = id;
+        }
+    }
+#undef ARRAY_SIZE
+
+    // run the cases
+
+    FILE* csv = NULL;
+
+    if ( csvPath )
+    {
+        csv = strcmp(csvPath, "-") == 0 ? stdout : fopen(csvPath, "w");
+        if ( !csv )
+        {
+            fprintf(stderr, "Couldn't create file '%s'.\n", csvPath);
+            return EXIT_FAILURE;
+        }
+        fprintf(csv, "kernel,case,unit,units,iterations,median_ns_per_unit,min_ns_per_unit\n");
+    }
+
+    // do not mix the table with the CSV written to stdout
+    FILE* out = csv == stdout ? stderr : stdout;
+
+    fprintf(out, "%-30s %-28s %12s %12s\n", "Kernel", "Case", "Median ns", "Min ns");
+    for ( size_t i = 0; i < caseCount; ++i )
+    {
+        const BenchCase* bc = &cases[i];
+
+        if ( filter && !strstr(bc->kernel, filter) )
+            continue;
+
+        const BenchResult result = RunCase(bc, runCount);
+
+        fprintf(out, "%-30s %-28s %12.3f %12.3f per %s\n", bc->kernel, bc->name, result.median, result.min, bc->unit);
+        if ( csv )
+        {
+            fprintf(csv, "%s,\"%s\",%s,%g,%zu,%g,%g\n", bc->kernel, bc->name, bc->unit, bc->unitCount,
+                    result.iterationCount, result.median, result.min);
+        }
+    }
+
+    if ( csv && csv != stdout )
+        fclose(csv);
+
+    for ( size_t i = 0; i < OutlineCount; ++i )
+    {
+        FreeOutlineData(&rasterData[i].outline);
+        FreeOutlineData(&strokerData[i].outline);
+        PVG_FT_Stroker_Done(strokerData[i].stroker);
+        plutovg_rle_destroy(intersectionData[i].a);
+        plutovg_rle_destroy(intersectionData[i].b);
+    }
+
+    return EXIT_SUCCESS;
+}
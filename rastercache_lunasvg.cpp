@@ -0,0 +1,420 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        rastercache_lunasvg.cpp
+// Purpose:     Persistent on-disk cache of SVGs rasterized by LunaSVG
+// Author:      PB
+// Created:     2024-01-18
+// Copyright:   (c) 2024 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#include <wx/ffile.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+#include <wx/log.h>
+#include <wx/utils.h>
+
+#ifdef __WINDOWS__
+    #include <wx/msw/wrapwin.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+#include <lunasvg.h>
+
+#include "rastercache_lunasvg.h"
+
+namespace {
+
+// increase whenever the file layout changes
+const std::uint32_t FileFormatVersion = 2;
+
+const char FileMagic[8] = { 'W', 'X', 'L', 'S', 'V', 'G', 'R', 'C' };
+
+// followed by width * height premultiplied BGRA pixels, top-down without padding
+struct FileHeader
+{
+    char          magic[8];
+    std::uint32_t formatVersion;
+    std::uint32_t lunasvgVersion;
+    std::uint8_t  dataDigest[32];
+    std::uint64_t dataLen;
+    std::uint32_t width;
+    std::uint32_t height;
+};
+
+bool IsHeaderValid(const FileHeader& header, const wxLunaSVGDiskCacheKey& key)
+{
+    return memcmp(header.magic, FileMagic, sizeof(FileMagic)) == 0
+           && header.formatVersion  == FileFormatVersion
+           && header.lunasvgVersion == LUNASVG_VERSION
+           && memcmp(header.dataDigest, key.dataDigest.data(), sizeof(header.dataDigest)) == 0
+           && header.dataLen        == key.dataLen
+           && header.width          == static_cast<std::uint32_t>(key.size.x)
+           && header.height         == static_cast<std::uint32_t>(key.size.y);
+}
+
+/*
+    SHA-256 as specified in FIPS 180-4.
+*/
+
+class SHA256
+{
+public:
+    SHA256();
+
+    void Update(const std::uint8_t* data, size_t len);
+    wxLunaSVGDataDigest Finish();
+private:
+    std::uint32_t m_state[8];
+    std::uint8_t  m_block[64];
+    size_t        m_blockLen{0};
+    std::uint64_t m_totalLen{0};
+
+    void ProcessBlock(const std::uint8_t* block);
+};
+
+const std::uint32_t SHA256RoundConstants[64] =
+{
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+inline std::uint32_t RotateRight(std::uint32_t value, unsigned count)
+{
+    return (value >> count) | (value << (32 - count));
+}
+
+SHA256::SHA256()
+{
+    static const std::uint32_t initialState[8] =
+        { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+
+    memcpy(m_state, initialState, sizeof(m_state));
+}
+
+void SHA256::Update(const std::uint8_t* data, size_t len)
+{
+    m_totalLen += len;
+
+    while ( len > 0 )
+    {
+        if ( m_blockLen == 0 && len >= sizeof(m_block) )
+        {
+            ProcessBlock(data);
+            data += sizeof(m_block);
+            len -= sizeof(m_block);
+            continue;
+        }
+
+        const size_t copyLen = std::min(len, sizeof(m_block) - m_blockLen);
+
+        memcpy(m_block + m_blockLen, data, copyLen);
+        m_blockLen += copyLen;
+        data += copyLen;
+        len -= copyLen;
+
+        if ( m_blockLen == sizeof(m_block) )
+        {
+            ProcessBlock(m_block);
+            m_blockLen = 0;
+        }
+    }
+}
+
+wxLunaSVGDataDigest SHA256::Finish()
+{
+    const std::uint64_t bitLen = m_totalLen * 8;
+    std::uint8_t        padding[72] = { 0x80 };
+    const size_t        paddingLen = (m_blockLen < 56 ? 56 : 120) - m_blockLen;
+
+    // the length is appended in big-endian order
+    for ( size_t i = 0; i < 8; ++i )
+        padding[paddingLen + i] = static_cast<std::uint8_t>(bitLen >> (56 - i * 8));
+
+    Update(padding, paddingLen + 8);
+
+    wxLunaSVGDataDigest digest;
+
+    for ( size_t i = 0; i < 8; ++i )
+    {
+        for ( size_t b = 0; b < 4; ++b )
+            digest[i * 4 + b] = static_cast<std::uint8_t>(m_state[i] >> (24 - b * 8));
+    }
+
+    return digest;
+}
+
+void SHA256::ProcessBlock(const std::uint8_t* block)
+{
+    std::uint32_t w[64];
+
+    for ( size_t i = 0; i < 16; ++i )
+    {
+        w[i] = static_cast<std::uint32_t>(block[i * 4]) << 24 | static_cast<std::uint32_t>(block[i * 4 + 1]) << 16
+               | static_cast<std::uint32_t>(block[i * 4 + 2]) << 8 | block[i * 4 + 3];
+    }
+
+    for ( size_t i = 16; i < 64; ++i )
+    {
+        const std::uint32_t s0 = RotateRight(w[i - 15], 7) ^ RotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        const std::uint32_t s1 = RotateRight(w[i - 2], 17) ^ RotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    std::uint32_t a = m_state[0], b = m_state[1], c = m_state[2], d = m_state[3];
+    std::uint32_t e = m_state[4], f = m_state[5], g = m_state[6], h = m_state[7];
+
+    for ( size_t i = 0; i < 64; ++i )
+    {
+        const std::uint32_t s1 = RotateRight(e, 6) ^ RotateRight(e, 11) ^ RotateRight(e, 25);
+        const std::uint32_t ch = (e & f) ^ (~e & g);
+        const std::uint32_t temp1 = h + s1 + ch + SHA256RoundConstants[i] + w[i];
+        const std::uint32_t s0 = RotateRight(a, 2) ^ RotateRight(a, 13) ^ RotateRight(a, 22);
+        const std::uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        const std::uint32_t temp2 = s0 + maj;
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + temp1;
+        d = c;
+        c = b;
+        b = a;
+        a = temp1 + temp2;
+    }
+
+    m_state[0] += a; m_state[1] += b; m_state[2] += c; m_state[3] += d;
+    m_state[4] += e; m_state[5] += f; m_state[6] += g; m_state[7] += h;
+}
+
+/*
+    Read-only memory mapping of a whole file.
+*/
+
+class MappedFile
+{
+public:
+    explicit MappedFile(const wxString& path);
+    ~MappedFile();
+
+    const std::uint8_t* GetData() const { return m_data; }
+    size_t GetSize() const { return m_size; }
+private:
+    const std::uint8_t* m_data{nullptr};
+    size_t              m_size{0};
+
+    wxDECLARE_NO_COPY_CLASS(MappedFile);
+};
+
+#ifdef __WINDOWS__
+
+MappedFile::MappedFile(const wxString& path)
+{
+    // FILE_SHARE_DELETE allows another instance to replace the file while mapped
+    HANDLE file = ::CreateFileW(path.wc_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                                nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if ( file == INVALID_HANDLE_VALUE )
+        return;
+
+    LARGE_INTEGER size;
+
+    if ( ::GetFileSizeEx(file, &size) && size.QuadPart > 0 )
+    {
+        HANDLE mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+        if ( mapping )
+        {
+            // the view keeps the mapping alive after its handle is closed
+            void* view = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+            if ( view )
+            {
+                m_data = static_cast<const std::uint8_t*>(view);
+                m_size = static_cast<size_t>(size.QuadPart);
+            }
+            ::CloseHandle(mapping);
+        }
+    }
+    ::CloseHandle(file);
+}
+
+MappedFile::~MappedFile()
+{
+    if ( m_data )
+        ::UnmapViewOfFile(m_data);
+}
+
+#else // !__WINDOWS__
+
+MappedFile::MappedFile(const wxString& path)
+{
+    const int fd = open(path.fn_str(), O_RDONLY);
+
+    if ( fd == -1 )
+        return;
+
+    struct stat st;
+
+    if ( fstat(fd, &st) == 0 && st.st_size > 0 )
+    {
+        // the mapping stays valid after the descriptor is closed
+        void* addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+
+        if ( addr != MAP_FAILED )
+        {
+            m_data = static_cast<const std::uint8_t*>(addr);
+            m_size = static_cast<size_t>(st.st_size);
+        }
+    }
+    close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if ( m_data )
+        munmap(const_cast<std::uint8_t*>(m_data), m_size);
+}
+
+#endif // #ifdef __WINDOWS__
+
+} // anonymous namespace
+
+// ============================================================================
+// wxLunaSVGDiskCache
+// ============================================================================
+
+wxLunaSVGDiskCache::wxLunaSVGDiskCache(const wxString& dir)
+    : m_dir(dir)
+{
+    if ( !wxDirExists(m_dir) )
+        wxFileName::Mkdir(m_dir, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+
+    m_ok = wxDirExists(m_dir);
+    if ( !m_ok )
+        wxLogDebug("Couldn't create disk cache folder '%s'", m_dir);
+}
+
+bool wxLunaSVGDiskCache::Contains(const wxLunaSVGDiskCacheKey& key) const
+{
+    return m_ok && wxFileExists(GetFilePath(key));
+}
+
+bool wxLunaSVGDiskCache::Load(const wxLunaSVGDiskCacheKey& key,
+                              const std::function<void(const lunasvg::Bitmap&)>& use) const
+{
+    if ( !m_ok || key.size.x <= 0 || key.size.y <= 0 )
+        return false;
+
+    const MappedFile file(GetFilePath(key));
+    const size_t     stride = static_cast<size_t>(key.size.x) * 4;
+
+    if ( file.GetSize() != sizeof(FileHeader) + stride * key.size.y )
+        return false;
+
+    FileHeader header;
+
+    memcpy(&header, file.GetData(), sizeof(header));
+    if ( !IsHeaderValid(header, key) )
+        return false;
+
+    // lunasvg::Bitmap needs a non-const pointer, the pixels are only read from
+    const lunasvg::Bitmap bitmap(const_cast<std::uint8_t*>(file.GetData()) + sizeof(FileHeader),
+                                 key.size.x, key.size.y, static_cast<std::uint32_t>(stride));
+
+    use(bitmap);
+    return true;
+}
+
+bool wxLunaSVGDiskCache::Store(const wxLunaSVGDiskCacheKey& key, const lunasvg::Bitmap& bitmap) const
+{
+    wxCHECK(bitmap.valid(), false);
+    wxCHECK(bitmap.width() == static_cast<std::uint32_t>(key.size.x)
+            && bitmap.height() == static_cast<std::uint32_t>(key.size.y), false);
+
+    if ( !m_ok )
+        return false;
+
+    static std::atomic<unsigned> tempCounter{0};
+
+    const wxString path = GetFilePath(key);
+    const wxString tempPath = wxString::Format("%s.%lu-%zx-%u.tmp", path, wxGetProcessId(),
+                                               std::hash<std::thread::id>()(std::this_thread::get_id()),
+                                               tempCounter++);
+    FileHeader header;
+
+    memcpy(header.magic, FileMagic, sizeof(FileMagic));
+    header.formatVersion  = FileFormatVersion;
+    header.lunasvgVersion = LUNASVG_VERSION;
+    memcpy(header.dataDigest, key.dataDigest.data(), sizeof(header.dataDigest));
+    header.dataLen        = key.dataLen;
+    header.width          = bitmap.width();
+    header.height         = bitmap.height();
+
+    // a failure to store a bitmap is not an error worth reporting
+    wxLogNull noLog;
+    bool      written = false;
+
+    {
+        wxFFile file(tempPath, "wb");
+
+        if ( !file.IsOpened() )
+            return false;
+
+        const size_t rowLen = static_cast<size_t>(bitmap.width()) * 4;
+
+        written = file.Write(&header, sizeof(header)) == sizeof(header);
+        for ( std::uint32_t y = 0; written && y < bitmap.height(); ++y )
+            written = file.Write(bitmap.data() + static_cast<size_t>(y) * bitmap.stride(), rowLen) == rowLen;
+
+        written = file.Close() && written;
+    }
+
+    // another thread or application instance may have stored the same bitmap
+    // in the meantime, then just one of the identical files is kept
+    if ( written && wxRenameFile(tempPath, path, true) )
+        return true;
+
+    wxRemoveFile(tempPath);
+    return false;
+}
+
+wxLunaSVGDataDigest wxLunaSVGDiskCache::DigestData(const char* data, size_t len)
+{
+    SHA256 sha256;
+
+    sha256.Update(reinterpret_cast<const std::uint8_t*>(data), len);
+    return sha256.Finish();
+}
+
+wxString wxLunaSVGDiskCache::GetFilePath(const wxLunaSVGDiskCacheKey& key) const
+{
+    // the rest of the digest is verified when the file is loaded
+    std::uint64_t namePrefix = 0;
+
+    for ( size_t i = 0; i < 8; ++i )
+        namePrefix = namePrefix << 8 | key.dataDigest[i];
+
+    const wxString name = wxString::Format("%016" wxLongLongFmtSpec "x-%" wxLongLongFmtSpec "u-%dx%d-%d.lsvgrc",
+                                           static_cast<wxULongLong_t>(namePrefix),
+                                           static_cast<wxULongLong_t>(key.dataLen),
+                                           key.size.x, key.size.y, LUNASVG_VERSION);
+
+    return wxFileName(m_dir, name).GetFullPath();
+}
@@ -0,0 +1,82 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        rastercache_lunasvg.h
+// Purpose:     Persistent on-disk cache of SVGs rasterized by LunaSVG
+// Author:      PB
+// Created:     2024-01-18
+// Copyright:   (c) 2024 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef RASTERCACHE_LUNASVG_H_DEFINED
+#define RASTERCACHE_LUNASVG_H_DEFINED
+
+#include <wx/gdicmn.h>
+#include <wx/string.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace lunasvg { class Bitmap; }
+
+// SHA-256 digest of SVG data
+typedef std::array<std::uint8_t, 32> wxLunaSVGDataDigest;
+
+// Identifies a rasterized bitmap in wxLunaSVGDiskCache
+struct wxLunaSVGDiskCacheKey
+{
+    wxLunaSVGDataDigest dataDigest{}; // obtained with wxLunaSVGDiskCache::DigestData()
+    std::uint64_t       dataLen{0};
+    wxSize              size;
+};
+
+/*
+    Cache of rasterized SVGs persisting across application launches.
+
+    Every bitmap is stored in its own file in the cache folder, as premultiplied
+    BGRA pixels as rendered by LunaSVG. The file name contains the beginning
+    of the SVG data digest, the data length, the bitmap size and LunaSVG
+    version, so that the bitmaps rendered by another version are never used.
+    The whole SHA-256 digest is stored in the file and compared on loading,
+    as a collision of the shorter names must not result in a wrong bitmap.
+    The files are memory-mapped read-only, so that several instances of
+    the application share the same pages.
+
+    The files are written to a temporary file first and then renamed, so that
+    an incomplete file is never read, even by another application instance.
+
+    All methods can be called from any thread.
+*/
+
+class wxLunaSVGDiskCache
+{
+public:
+    // dir is created if it does not exist
+    explicit wxLunaSVGDiskCache(const wxString& dir);
+
+    bool IsOk() const { return m_ok; }
+
+    const wxString& GetDir() const { return m_dir; }
+
+    bool Contains(const wxLunaSVGDiskCacheKey& key) const;
+
+    // if the bitmap is in the cache, calls use with the bitmap mapped
+    // to memory and returns true. The bitmap is valid only during the call
+    // and must not be modified.
+    bool Load(const wxLunaSVGDiskCacheKey& key, const std::function<void(const lunasvg::Bitmap&)>& use) const;
+
+    // bitmap must have the size specified in key
+    bool Store(const wxLunaSVGDiskCacheKey& key, const lunasvg::Bitmap& bitmap) const;
+
+    // returns SHA-256 digest of data
+    static wxLunaSVGDataDigest DigestData(const char* data, size_t len);
+
+private:
+    wxString m_dir;
+    bool     m_ok{false};
+
+    wxString GetFilePath(const wxLunaSVGDiskCacheKey& key) const;
+};
+
+#endif // #ifndef RASTERCACHE_LUNASVG_H_DEFINED
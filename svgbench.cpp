@@ -15,41 +15,145 @@
     #error "wxWidgets must be built with support for wxFFile"    
 #endif
 #include <wx/filename.h>
+#include <wx/listctrl.h>
 #include <wx/stopwatch.h>
 #include <wx/textfile.h>
+#include <wx/utils.h>
 #include <wx/webview.h>
 
 #include <algorithm>
-#include <climits>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
 #include <numeric>
+#include <random>
+
+#include <lunasvg.h>
 
 #include "bmpbndl_lunasvg.h"
+#include "rastercache_lunasvg.h"
+#include "svgchart.h"
 
 #include "svgbench.h"
 
 
-// 0 means the benchmark will include only wxBitmapBundle::ToBitmap() while
-// any other value means the benchmark will also include creating
-// wxBitmapBundle from an in-memory SVG
-#ifndef WXSVGTEST2_BENCH_FULL
-    #define WXSVGTEST2_BENCH_FULL 1
+// number of untimed runs for each file and size before the timed ones
+#ifndef WXSVGTEST2_BENCH_WARMUP_RUNS
+    #define WXSVGTEST2_BENCH_WARMUP_RUNS 3
+#endif
+
+// minimum duration of a timed batch of iterations in microseconds, so that
+// the clock resolution and overhead do not matter even for tiny bitmaps
+#ifndef WXSVGTEST2_BENCH_MIN_BATCH_MICRO
+    #define WXSVGTEST2_BENCH_MIN_BATCH_MICRO 200
+#endif
+
+#ifndef WXSVGTEST2_BENCH_MAX_BATCH_ITERATIONS
+    #define WXSVGTEST2_BENCH_MAX_BATCH_ITERATIONS 1000
+#endif
+
+// maximum number of the latest runs from the history shown in the trend charts
+#ifndef WXSVGTEST2_BENCH_TREND_RUNS
+    #define WXSVGTEST2_BENCH_TREND_RUNS 30
 #endif
 
+// times farther from the median than this many scaled median absolute
+// deviations are rejected as outliers
+static const double OutlierMADCount = 3;
+
+static const size_t BootstrapResampleCount = 1000;
+
 // ============================================================================
 // wxTestSVGRasterizationBenchmark
 // ============================================================================
 
+wxString wxTestSVGRasterizationBenchmark::GetModeName(Mode mode)
+{
+    switch ( mode )
+    {
+        case Mode_Parse:      return "Parse only (LunaSVG)";
+        case Mode_Layout:     return "Layout only (LunaSVG)";
+        case Mode_Render:     return "Render only (LunaSVG)";
+        case Mode_ColdBitmap: return "Cold GetBitmap";
+        case Mode_WarmBitmap: return "Warm GetBitmap";
+        case Mode_Full:       return "Full";
+        case Mode_Count:      break;
+    }
+
+    return wxString();
+}
+
+wxString wxTestSVGRasterizationBenchmark::GetModeKey(Mode mode)
+{
+    switch ( mode )
+    {
+        case Mode_Parse:      return "parse";
+        case Mode_Layout:     return "layout";
+        case Mode_Render:     return "render";
+        case Mode_ColdBitmap: return "cold";
+        case Mode_WarmBitmap: return "warm";
+        case Mode_Full:       return "full";
+        case Mode_Count:      break;
+    }
+
+    return wxString();
+}
+
+bool wxTestSVGRasterizationBenchmark::IsLunaSVGOnlyMode(Mode mode)
+{
+    return mode == Mode_Parse || mode == Mode_Layout || mode == Mode_Render;
+}
+
 wxTestSVGRasterizationBenchmark::wxTestSVGRasterizationBenchmark()
 {
 }
 
+wxTestSVGRasterizationBenchmark::~wxTestSVGRasterizationBenchmark()
+{
+    TeardownBackends();
+}
+
 void wxTestSVGRasterizationBenchmark::Setup(const wxString& dirName,
                                             const wxArrayString& fileNames,
-                                            const std::vector<wxSize>& sizes)
+                                            const std::vector<wxSize>& sizes,
+                                            const std::vector<Mode>& modes,
+                                            const std::vector<Backend>& backends)
 {
     m_dirName   = dirName;
     m_fileNames = fileNames;
     m_sizes     = sizes;
+    m_modes     = modes;
+    m_backends  = backends;
+
+    m_phasesBackend = NoBackend;
+    for ( size_t b = 0; b < m_backends.size() && m_phasesBackend == NoBackend; ++b )
+    {
+        if ( m_backends[b].isPlainLunaSVG )
+            m_phasesBackend = b;
+    }
+}
+
+bool wxTestSVGRasterizationBenchmark::IsBenchmarked(Mode mode, size_t backend) const
+{
+    return !IsLunaSVGOnlyMode(mode) || m_backends[backend].isPlainLunaSVG;
+}
+
+bool wxTestSVGRasterizationBenchmark::CollectsPhases() const
+{
+    return m_phasesBackend != NoBackend
+           && std::find(m_modes.begin(), m_modes.end(), Mode_Full) != m_modes.end();
+}
+
+wxString wxTestSVGRasterizationBenchmark::FormatPhasesCells(const wxString& cell) const
+{
+    wxString cells;
+
+    for ( size_t b = 0; b < m_backends.size(); ++b )
+        cells += b == m_phasesBackend ? cell : wxString("<td></td>");
+    return cells;
 }
 
 wxMemoryBuffer LoadSVGFromFile(const wxString& path)
@@ -91,189 +195,1555 @@ wxBitmapBundle CreateBitmapBundleLunaFromMemory(const wxMemoryBuffer& buf)
     return wxBitmapBundle();
 }
 
+static std::vector<wxTestSVGRasterizationBenchmark::Backend> CreateBuiltinBackends()
+{
+    using Backend = wxTestSVGRasterizationBenchmark::Backend;
+
+    std::vector<Backend> backends;
+    Backend              backend;
+
+    backend.name = "Nano";
+    backend.description = "NanoSVG, used by wxBitmapBundle::FromSVG()";
+    backend.createBundle = CreateBitmapBundleNanoFromMemory;
+    backends.push_back(backend);
+
+    backend = Backend();
+    backend.name = "Luna";
+    backend.description = "LunaSVG, used by CreateWithLunaSVGFromMemory()";
+    backend.createBundle = CreateBitmapBundleLunaFromMemory;
+    backend.isPlainLunaSVG = true;
+    backends.push_back(backend);
+
+    backend = Backend();
+    backend.name = "Luna compiled";
+    backend.description = "LunaSVG loading the documents compiled by CompileLunaSVG() without parsing, compiling is not timed";
+    backend.createBundle = CreateBitmapBundleLunaFromMemory;
+    backend.prepareData = [](const wxMemoryBuffer& svg)
+    {
+        return CompileLunaSVG(static_cast<const wxByte*>(svg.GetData()), svg.GetDataLen());
+    };
+    backends.push_back(backend);
+
+    // the cache is shared by all bundles and filled by the warmup runs,
+    // so the timed runs load the bitmaps from it instead of rasterizing them
+    const auto diskCache = std::make_shared<std::shared_ptr<wxLunaSVGDiskCache>>();
+
+    backend = Backend();
+    backend.name = "Luna disk cache";
+    backend.description = "LunaSVG with wxLunaSVGDiskCache in a temporary folder, filled by the warmup runs";
+    backend.createBundle = [diskCache](const wxMemoryBuffer& buf)
+    {
+        wxLunaSVGBundleOptions options;
+
+        options.diskCache = *diskCache;
+        return CreateWithLunaSVGFromMemory(static_cast<const wxByte*>(buf.GetData()), buf.GetDataLen(),
+                                           wxSize(2, 2), options);
+    };
+    backend.setup = [diskCache]()
+    {
+        const wxString dir = wxFileName(wxFileName::GetTempDir(),
+                                        wxString::Format("wxTestSVG2-bench-cache-%lu", wxGetProcessId())).GetFullPath();
+
+        // left behind by a benchmark which crashed
+        if ( wxDirExists(dir) )
+            wxFileName::Rmdir(dir, wxPATH_RMDIR_RECURSIVE);
+
+        *diskCache = std::make_shared<wxLunaSVGDiskCache>(dir);
+        return (*diskCache)->IsOk();
+    };
+    backend.teardown = [diskCache]()
+    {
+        const wxString dir = (*diskCache)->GetDir();
+
+        diskCache->reset();
+        wxFileName::Rmdir(dir, wxPATH_RMDIR_RECURSIVE);
+    };
+    backends.push_back(backend);
+
+    return backends;
+}
+
+static std::vector<wxTestSVGRasterizationBenchmark::Backend>& GetBackendRegistry()
+{
+    static std::vector<wxTestSVGRasterizationBenchmark::Backend> backends(CreateBuiltinBackends());
+
+    return backends;
+}
+
+void wxTestSVGRasterizationBenchmark::RegisterBackend(const Backend& backend)
+{
+    wxCHECK_RET(!backend.name.empty() && backend.createBundle, "Invalid backend");
+    wxCHECK_RET(!FindRegisteredBackend(backend.name), "Backend with this name is already registered");
+
+    GetBackendRegistry().push_back(backend);
+}
+
+const std::vector<wxTestSVGRasterizationBenchmark::Backend>& wxTestSVGRasterizationBenchmark::GetRegisteredBackends()
+{
+    return GetBackendRegistry();
+}
+
+const wxTestSVGRasterizationBenchmark::Backend* wxTestSVGRasterizationBenchmark::FindRegisteredBackend(const wxString& name)
+{
+    for ( const auto& backend : GetBackendRegistry() )
+    {
+        if ( backend.name == name )
+            return &backend;
+    }
+
+    return nullptr;
+}
+
+std::vector<wxTestSVGRasterizationBenchmark::Backend> wxTestSVGRasterizationBenchmark::GetDefaultBackends()
+{
+    std::vector<Backend> backends;
+
+    for ( const char* name : { "Nano", "Luna" } )
+        backends.push_back(*FindRegisteredBackend(name));
+
+    return backends;
+}
+
+bool wxTestSVGRasterizationBenchmark::SetupBackends()
+{
+    for ( size_t b = 0; b < m_backends.size(); ++b )
+    {
+        if ( !m_backends[b].setup || m_backends[b].setup() )
+            continue;
+
+        wxLogError("Couldn't set up backend '%s'.", m_backends[b].name);
+
+        for ( size_t i = 0; i < b; ++i )
+        {
+            if ( m_backends[i].teardown )
+                m_backends[i].teardown();
+        }
+        return false;
+    }
+
+    m_backendsSetUp = true;
+    return true;
+}
+
+void wxTestSVGRasterizationBenchmark::TeardownBackends()
+{
+    if ( !m_backendsSetUp )
+        return;
+
+    m_backendsSetUp = false;
+    for ( const auto& backend : m_backends )
+    {
+        if ( backend.teardown )
+            backend.teardown();
+    }
+}
+
 bool wxTestSVGRasterizationBenchmark::Run(size_t runCount,
                                           wxString& report, wxString& detailedReport)
+{
+    if ( !Start(runCount) )
+        return false;
+
+    while ( !IsDone() )
+    {
+        if ( !Step() )
+        {
+            TeardownBackends();
+            return false;
+        }
+    }
+
+    return Finish(report, detailedReport);
+}
+
+bool wxTestSVGRasterizationBenchmark::Start(size_t runCount)
 {
     wxCHECK(!m_fileNames.empty(), false);
     wxCHECK(!m_sizes.empty(), false);
+    wxCHECK(!m_modes.empty(), false);
+    wxCHECK(!m_backends.empty(), false);
     wxCHECK(runCount, false);
+    wxCHECK(!m_backendsSetUp, false);
 
-    MatrixLong3 timesNano(m_fileNames.size());
-    MatrixLong3 timesLuna(m_fileNames.size());
+    m_stepUnits.clear();
+    for ( size_t m = 0; m < m_modes.size(); ++m )
+    {
+        for ( size_t b = 0; b < m_backends.size(); ++b )
+        {
+            if ( IsBenchmarked(m_modes[m], b) )
+                m_stepUnits.push_back(std::make_pair(m, b));
+        }
+    }
+    wxCHECK(!m_stepUnits.empty(), false);
 
-    for ( size_t f = 0; f < m_fileNames.size(); ++f )
+    m_stepData.clear();
+    m_stepBatches      = SizeBatches();
+    m_runCount         = runCount;
+    m_doneStepCount    = 0;
+    m_startedFileCount = m_fileNames.size();
+
+    m_results.assign(m_modes.size(), ModeResults());
+    for ( size_t m = 0; m < m_modes.size(); ++m )
     {
-        const wxString fileName = wxFileName(m_dirName, m_fileNames[f]).GetFullPath();
+        m_results[m].mode = m_modes[m];
+        m_results[m].times.resize(m_backends.size());
+        m_results[m].stats.resize(m_backends.size());
+        for ( size_t b = 0; b < m_backends.size(); ++b )
+        {
+            if ( !IsBenchmarked(m_modes[m], b) )
+                continue;
 
-        if ( !BenchmarkFile(CreateBitmapBundleNanoFromMemory, fileName, runCount, timesNano[f]) )
-            return false;
-        if ( !BenchmarkFile(CreateBitmapBundleLunaFromMemory, fileName, runCount, timesLuna[f]) )
-            return false;
+            m_results[m].times[b].assign(m_fileNames.size(), MatrixTimes2(m_sizes.size()));
+            m_results[m].stats[b].assign(m_fileNames.size(), VectorStats(m_sizes.size()));
+        }
     }
 
-    MatrixStats statsNano;
-    MatrixStats statsLuna;
+    const size_t phaseFileCount = CollectsPhases() ? m_fileNames.size() : 0;
 
-    statsNano.resize(m_fileNames.size());
-    for ( auto& s : statsNano )
-        s.resize(m_sizes.size());
+    m_phasesLuna.assign(phaseFileCount, MatrixPhases2(m_sizes.size()));
+    m_allocsLuna.assign(phaseFileCount, VectorAllocs(m_sizes.size()));
 
-    statsLuna.resize(m_fileNames.size());
-    for ( auto& s : statsLuna )
-        s.resize(m_sizes.size());
+    return SetupBackends();
+}
 
-    for ( size_t f = 0; f < m_fileNames.size(); ++f )
+// all the modes and backends of a file at a size are benchmarked one after
+// another, so that they are affected the same by the state of the machine
+void wxTestSVGRasterizationBenchmark::GetStep(size_t step, size_t& file, size_t& mode, size_t& backend, size_t& size) const
+{
+    file    = step / GetFileStepCount();
+    size    = step / m_stepUnits.size() % m_sizes.size();
+    mode    = m_stepUnits[step % m_stepUnits.size()].first;
+    backend = m_stepUnits[step % m_stepUnits.size()].second;
+}
+
+bool wxTestSVGRasterizationBenchmark::Step()
+{
+    wxCHECK(m_backendsSetUp && !IsDone(), false);
+
+    size_t f = 0, m = 0, b = 0, s = 0;
+
+    GetStep(m_doneStepCount, f, m, b, s);
+
+    ModeResults&   r = m_results[m];
+    const bool     phases = r.mode == Mode_Full && b == m_phasesBackend;
+    const wxString fileName = wxFileName(m_dirName, m_fileNames[f]).GetFullPath();
+
+    // each file is loaded and prepared by the backends only once for all sizes
+    if ( m_stepData.empty() || m_stepDataFile != f )
     {
-        for ( size_t s = 0; s < m_sizes.size(); ++s )
+        m_stepData.assign(m_stepUnits.size(), wxMemoryBuffer());
+        m_stepDataFile = f;
+    }
+
+    wxMemoryBuffer& buf = m_stepData[m_doneStepCount % m_stepUnits.size()];
+
+    if ( buf.IsEmpty() )
+        buf = LoadFile(m_backends[b], r.mode, fileName);
+
+    if ( buf.IsEmpty() )
+        return false;
+
+    if ( m_stepBatches.doneCount == 0 )
+    {
+        r.times[b][f][s].assign(m_runCount, 0);
+        if ( phases )
+            m_phasesLuna[f][s].assign(m_runCount, wxLunaSVGPhaseTimes());
+    }
+
+    // a step of a heavy file takes seconds, so only one of its batches
+    // is run at once to keep the GUI responsive
+    if ( !BenchmarkSizeBatch(m_backends[b], r.mode, fileName, buf, m_sizes[s], m_runCount, m_stepBatches,
+                             r.times[b][f][s], phases ? &m_phasesLuna[f][s] : nullptr,
+                             phases ? &m_allocsLuna[f][s] : nullptr) )
+    {
+        return false;
+    }
+
+    if ( !m_stepBatches.done )
+        return true;
+
+    r.stats[b][f][s] = CalcStats(r.times[b][f][s]);
+
+    m_stepBatches = SizeBatches();
+    ++m_doneStepCount;
+    return true;
+}
+
+size_t wxTestSVGRasterizationBenchmark::GetDoneFileCount() const
+{
+    return GetFileStepCount() == 0 ? 0 : m_doneStepCount / GetFileStepCount();
+}
+
+std::vector<double> wxTestSVGRasterizationBenchmark::GetMedians(size_t file, size_t mode, size_t backend) const
+{
+    std::vector<double> medians;
+
+    if ( mode < m_results.size() && file < m_results[mode].stats[backend].size() )
+    {
+        for ( const auto& stats : m_results[mode].stats[backend][file] )
+            medians.push_back(stats.mdn);
+    }
+
+    return medians;
+}
+
+bool wxTestSVGRasterizationBenchmark::Finish(wxString& report, wxString& detailedReport)
+{
+    TeardownBackends();
+    m_stepData.clear();
+
+    // the files not benchmarked at all sizes in all modes with all backends are left out
+    const size_t fileCount = GetDoneFileCount();
+    const bool   complete = fileCount == m_fileNames.size();
+
+    if ( fileCount == 0 )
+        return false;
+
+    if ( !complete )
+    {
+        m_fileNames.RemoveAt(fileCount, m_fileNames.size() - fileCount);
+
+        for ( auto& r : m_results )
+        {
+            for ( size_t b = 0; b < m_backends.size(); ++b )
+            {
+                if ( r.times[b].empty() )
+                    continue;
+
+                r.times[b].resize(fileCount);
+                r.stats[b].resize(fileCount);
+            }
+        }
+
+        if ( !m_phasesLuna.empty() )
         {
-            statsNano[f][s] = CalcStatsForVectorLong(timesNano[f][s]);
-            statsLuna[f][s] = CalcStatsForVectorLong(timesLuna[f][s]);
+            m_phasesLuna.resize(fileCount);
+            m_allocsLuna.resize(fileCount);
         }
     }
 
-    CreateReport(statsNano, statsLuna, runCount, report);
+    MatrixPhases2 phaseMediansLuna(m_phasesLuna.size(), VectorPhases(m_sizes.size()));
+
+    for ( size_t f = 0; f < m_phasesLuna.size(); ++f )
+    {
+        for ( size_t s = 0; s < m_sizes.size(); ++s )
+            phaseMediansLuna[f][s] = CalcPhaseMedians(m_phasesLuna[f][s]);
+    }
+
+    wxTestSVGBenchmarkHistory history;
+
+    if ( !m_historyFileName.empty() && complete )
+    {
+        if ( !history.Load(m_historyFileName, m_dirName) )
+            wxLogWarning("Couldn't read the benchmark history file '%s', the results were not added to it.", m_historyFileName);
+        else if ( !history.Append(m_historyFileName, CreateHistoryRun(m_results, m_runCount)) )
+            wxLogWarning("Couldn't append the results to the benchmark history file '%s'.", m_historyFileName);
+    }
+
+    CreateReport(m_results, phaseMediansLuna, m_allocsLuna, m_runCount, history.GetRuns(), report);
 
-    CreateDetailedReport(timesNano, statsNano,
-                         timesLuna, statsLuna,
-                         true, detailedReport);
+    CreateDetailedReport(m_results, m_runCount, true, detailedReport);
 
     return true;
 }
 
-bool wxTestSVGRasterizationBenchmark::BenchmarkFile(CreateBitmapBundleFn fn,
-                                                    const wxString& fileName,
-                                                    size_t runCount, MatrixLong2& times)
+bool wxTestSVGRasterizationBenchmark::RunStreaming(size_t runCount, const wxString& resultsFileName,
+                                                   wxString& report)
 {
-    wxStopWatch stopWatch;
-    const wxMemoryBuffer buf = LoadSVGFromFile(fileName);
+    wxCHECK(!m_fileNames.empty(), false);
+    wxCHECK(!m_sizes.empty(), false);
+    wxCHECK(!m_modes.empty(), false);
+    wxCHECK(!m_backends.empty(), false);
+    wxCHECK(runCount, false);
 
-    if ( buf.IsEmpty() )
+    if ( !SetupBackends() )
+        return false;
+
+    const bool result = DoRunStreaming(runCount, resultsFileName, report);
+
+    TeardownBackends();
+    return result;
+}
+
+bool wxTestSVGRasterizationBenchmark::DoRunStreaming(size_t runCount, const wxString& resultsFileName,
+                                                     wxString& report)
+{
+    wxFFile resultsFile(resultsFileName, "w");
+
+    if ( !resultsFile.IsOpened() )
         return false;
 
-    times.resize(m_sizes.size());
-    for ( auto& t : times )
-        t.resize(runCount);
+    // the header
+    wxString header = "File\tWidth\tHeight\tMode";
+
+    for ( const auto& backend : m_backends )
+    {
+        for ( const char* stat : { "Median", "Min", "Max", "P90", "P99", "CI Low", "CI High", "Outliers" } )
+            header += wxString::Format("\t%s %s", backend.name, stat);
+    }
+    if ( m_phasesBackend != NoBackend )
+    {
+        for ( const char* column : { "Parse", "Layout", "Render", "Convert", "Allocations", "Allocated", "Peak" } )
+            header += wxString::Format("\t%s %s", m_backends[m_phasesBackend].name, column);
+    }
+    header += "\n";
+
+    if ( !resultsFile.Write(header, wxConvUTF8) )
+        return false;
 
-    for ( size_t run = 0; run < runCount; ++run )
+    // only these, the results for the current file and the names
+    // of the failed files are kept in memory
+    BackendTotals       totals(m_backends.size(), MatrixTotals(m_modes.size(), std::vector<Totals>(m_sizes.size())));
+    VectorPhases        phaseSumsLuna(m_sizes.size());
+    VectorAllocs        allocTotalsLuna(m_sizes.size());
+    size_t              benchmarkedCount = 0;
+    wxArrayString       failedFileNames;
+
+    MatrixTimes2             times;
+    MatrixPhases2            phasesLuna;
+    VectorAllocs             allocsLuna;
+    std::vector<MatrixStats> stats(m_backends.size(), MatrixStats(m_modes.size(), VectorStats(m_sizes.size())));
+    VectorPhases             phaseMediansLuna(m_sizes.size());
+
+    for ( const auto& name : m_fileNames )
     {
+        const wxString fileName = wxFileName(m_dirName, name).GetFullPath();
+        bool           failed = false;
 
-#if !WXSVGTEST2_BENCH_FULL
-        // do not include bundle creation in benchmark,
-        // create it here just once outside the benched loop
-        const wxBitmapBundle bundle = fn(buf);
-#endif
-        wxBitmap   bitmap;
-        wxLongLong time;
+        // the results are written only when all the modes succeeded
+        for ( size_t m = 0; m < m_modes.size() && !failed; ++m )
+        {
+            const Mode mode = m_modes[m];
 
-        for ( size_t s = 0; s < m_sizes.size(); ++s )
+            for ( size_t b = 0; b < m_backends.size(); ++b )
+            {
+                const bool phases = mode == Mode_Full && b == m_phasesBackend;
+
+                if ( !IsBenchmarked(mode, b) )
+                    continue;
+
+                if ( !BenchmarkFile(m_backends[b], mode, fileName, runCount, times,
+                                    phases ? &phasesLuna : nullptr, phases ? &allocsLuna : nullptr) )
+                {
+                    failed = true;
+                    break;
+                }
+
+                for ( size_t s = 0; s < m_sizes.size(); ++s )
+                {
+                    stats[b][m][s] = CalcStats(times[s]);
+                    if ( phases )
+                        phaseMediansLuna[s] = CalcPhaseMedians(phasesLuna[s]);
+                }
+            }
+        }
+
+        if ( failed )
         {
-            const wxSize& bitmapSize = m_sizes[s];
+            failedFileNames.push_back(name);
+            continue;
+        }
 
-            stopWatch.Start();
-#if WXSVGTEST2_BENCH_FULL
-            // include bundle creation in benchmark
-            const wxBitmapBundle bundle = fn(buf);
-#endif
-            if ( !bundle.IsOk() )
-                return false;
-            bitmap = bundle.GetBitmap(bitmapSize);
-            time = stopWatch.TimeInMicro();
+        for ( size_t m = 0; m < m_modes.size(); ++m )
+        {
+            std::vector<const VectorStats*> modeStats(m_backends.size());
 
-            if ( !bitmap.IsOk() )
-             {
-                wxLogError("Couldn't rasterize file '%s' at size %dx%d.", fileName, bitmapSize.x, bitmapSize.y);
-                return false;
+            for ( size_t b = 0; b < m_backends.size(); ++b )
+            {
+                if ( !IsBenchmarked(m_modes[m], b) )
+                    continue;
+
+                for ( size_t s = 0; s < m_sizes.size(); ++s )
+                    totals[b][m][s].Add(stats[b][m][s]);
+                modeStats[b] = &stats[b][m];
             }
 
-            times[s][run] = time.ToLong();
+            const bool phases = m_modes[m] == Mode_Full && CollectsPhases();
+
+            WriteStreamingResults(resultsFile, name, m_modes[m], modeStats,
+                                  phases ? &phaseMediansLuna : nullptr, phases ? &allocsLuna : nullptr);
+        }
+
+        for ( size_t s = 0; CollectsPhases() && s < m_sizes.size(); ++s )
+        {
+            wxLunaSVGPhaseTimes& phaseSums = phaseSumsLuna[s];
+
+            phaseSums.parse   += phaseMediansLuna[s].parse;
+            phaseSums.layout  += phaseMediansLuna[s].layout;
+            phaseSums.render  += phaseMediansLuna[s].render;
+            phaseSums.convert += phaseMediansLuna[s].convert;
+
+            AllocStats& allocTotals = allocTotalsLuna[s].total;
+
+            allocTotals.count += allocsLuna[s].total.count;
+            allocTotals.bytes += allocsLuna[s].total.bytes;
+            allocTotals.peakLive = wxMax(allocTotals.peakLive, allocsLuna[s].total.peakLive);
         }
+
+        // so that the results survive a crash in the following files
+        if ( resultsFile.Error() || !resultsFile.Flush() )
+            return false;
+
+        ++benchmarkedCount;
     }
 
+    if ( !resultsFile.Close() )
+        return false;
+
+    CreateStreamingReport(totals, phaseSumsLuna, allocTotalsLuna, runCount,
+                          benchmarkedCount, failedFileNames, resultsFileName, report);
+
     return true;
 }
 
-void wxTestSVGRasterizationBenchmark::CreateReport(const MatrixStats& statsNano, const MatrixStats& statsLuna,
-                                                   size_t runCount, wxString& reportText)
+bool wxTestSVGRasterizationBenchmark::BenchmarkFile(const Backend& backend, Mode mode,
+                                                    const wxString& fileName,
+                                                    size_t runCount, MatrixTimes2& times,
+                                                    MatrixPhases2* phases,
+                                                    VectorAllocs* allocs)
 {
-    wxArrayString       result;
-    wxString            rowStr;
-    std::vector<double> sumsNano(m_sizes.size());
-    VectorLong          minsNano(m_sizes.size(), LONG_MAX), maxesNano(m_sizes.size(), LONG_MIN);
-    std::vector<double> sumsLuna(m_sizes.size());
-    VectorLong          minsLuna(m_sizes.size(), LONG_MAX), maxesLuna(m_sizes.size(), LONG_MIN);
+    const wxMemoryBuffer buf = LoadFile(backend, mode, fileName);
 
-    rowStr = R"(<!DOCTYPE html><html><head><meta charset="UTF-8"><meta name="description" content="wxTestSVG2 Report">)";
-    rowStr += "<style>";
-    rowStr += "table, th, td, tfoot {border: 1px solid black; border-collapse: collapse;} td {text-align: right;} tfoot {color: red;} ";
-    rowStr += "body {font-family: Verdana, Arial, Helvetica, sans-serif;}";
-    rowStr += "</style></head><body>\n";
-    result.push_back(rowStr);
+    if ( buf.IsEmpty() )
+        return false;
 
-    result.push_back(wxString::Format("<h3>Benchmarked %zu files from folder '%s' (%zu runs)</h1>",
-        m_fileNames.size(), m_dirName, runCount));
-    result.push_back("<p>Unless indicated otherwise, the times are medians in microseconds</p>");
+    times.assign(m_sizes.size(), VectorTimes());
+    if ( phases )
+        phases->assign(m_sizes.size(), VectorPhases());
+    if ( allocs )
+        allocs->assign(m_sizes.size(), Allocs());
 
-    // create headers
-    rowStr = R"(<table>)";
-    rowStr += R"(<thead><tr>)";
-    rowStr += R"(<th rowspan="2">File</th>)";
-    for ( const auto& s : m_sizes )
+    for ( size_t s = 0; s < m_sizes.size(); ++s )
     {
-        rowStr += wxString::Format(R"(<th colspan="2">%dx%d</th>)", s.x, s.y);
+        if ( !BenchmarkSize(backend, mode, fileName, buf, m_sizes[s], runCount, times[s],
+                            phases ? &(*phases)[s] : nullptr, allocs ? &(*allocs)[s] : nullptr) )
+        {
+            return false;
+        }
     }
-    rowStr += R"(</tr>)";
-    rowStr += "\n";
-    result.push_back(rowStr);
 
-    rowStr = R"(<tr>)";
-    for ( size_t i = 0; i < m_sizes.size(); ++i )
-        rowStr += "<th>Nano</th><th>Luna</th>";
-    rowStr += R"(</tr>)";
-    rowStr += R"(</thead>)";
-    rowStr += "\n";
-    result.push_back(rowStr);
+    return true;
+}
+
+wxMemoryBuffer wxTestSVGRasterizationBenchmark::LoadFile(const Backend& backend, Mode mode,
+                                                         const wxString& fileName) const
+{
+    wxMemoryBuffer buf = LoadSVGFromFile(fileName);
+
+    // LunaSVG only modes always use SVG
+    if ( !buf.IsEmpty() && backend.prepareData && !IsLunaSVGOnlyMode(mode) )
+        buf = backend.prepareData(buf);
+
+    return buf;
+}
+
+bool wxTestSVGRasterizationBenchmark::BenchmarkSize(const Backend& backend, Mode mode,
+                                                    const wxString& fileName, const wxMemoryBuffer& buf,
+                                                    const wxSize& bitmapSize, size_t runCount, VectorTimes& times,
+                                                    VectorPhases* phases, Allocs* allocs)
+{
+    times.assign(runCount, 0);
+    if ( phases )
+        phases->assign(runCount, wxLunaSVGPhaseTimes());
+
+    SizeBatches batches;
+
+    while ( !batches.done )
+    {
+        if ( !BenchmarkSizeBatch(backend, mode, fileName, buf, bitmapSize, runCount, batches,
+                                 times, phases, allocs) )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool wxTestSVGRasterizationBenchmark::BenchmarkSizeBatch(const Backend& backend, Mode mode,
+                                                         const wxString& fileName, const wxMemoryBuffer& buf,
+                                                         const wxSize& bitmapSize, size_t runCount, SizeBatches& batches,
+                                                         VectorTimes& times, VectorPhases* phases, Allocs* allocs)
+{
+    wxCHECK(!batches.done && times.size() == runCount, false);
+
+    // the phases are timed with a high-resolution clock
+    wxLunaSVGPhaseTimesCollector phaseCollector;
+
+    const auto reportError = [&fileName, &bitmapSize]()
+    {
+        wxLogError("Couldn't rasterize file '%s' at size %dx%d.", fileName, bitmapSize.x, bitmapSize.y);
+        return false;
+    };
+
+    // the warmup runs are also used to find out how many iterations
+    // are needed for a batch to take at least WXSVGTEST2_BENCH_MIN_BATCH_MICRO
+    const size_t warmupRunCount = wxMax(WXSVGTEST2_BENCH_WARMUP_RUNS, 1);
+
+    if ( batches.doneCount < warmupRunCount )
+    {
+        wxLongLong_t time = 0;
+
+        if ( !TimeBatch(backend, mode, buf, bitmapSize, 1, time) )
+            return reportError();
+        batches.minWarmupTime = std::min(batches.minWarmupTime, time);
+
+        if ( ++batches.doneCount == warmupRunCount )
+        {
+            const wxLongLong_t minBatchTime = static_cast<wxLongLong_t>(WXSVGTEST2_BENCH_MIN_BATCH_MICRO) * 1000;
+            const size_t       iterationCount = static_cast<size_t>(std::max<wxLongLong_t>(minBatchTime / std::max<wxLongLong_t>(batches.minWarmupTime, 1), 1));
+
+            batches.iterationCount = std::min<size_t>(iterationCount, WXSVGTEST2_BENCH_MAX_BATCH_ITERATIONS);
+        }
+        return true;
+    }
+
+    const size_t run = batches.doneCount - warmupRunCount;
+
+    if ( run < runCount )
+    {
+        const size_t iterationCount = batches.iterationCount;
+        wxLongLong_t time = 0;
+
+        if ( !TimeBatch(backend, mode, buf, bitmapSize, iterationCount, time) )
+            return reportError();
+
+        times[run] = static_cast<double>(time) / iterationCount;
+
+        if ( phases )
+        {
+            wxLunaSVGPhaseTimes& p = (*phases)[run];
+
+            p = phaseCollector.GetTimes();
+            p.parse   /= static_cast<wxLongLong_t>(iterationCount);
+            p.layout  /= static_cast<wxLongLong_t>(iterationCount);
+            p.render  /= static_cast<wxLongLong_t>(iterationCount);
+            p.convert /= static_cast<wxLongLong_t>(iterationCount);
+        }
+
+        ++batches.doneCount;
+        batches.done = run + 1 == runCount && !allocs;
+        return true;
+    }
+
+    // allocations are counted in a single untimed iteration of the full mode,
+    // as a batch keeps all its bitmaps alive
+    AllocStatsCollector allocCollector;
+
+    {
+        const wxBitmapBundle bundle = backend.createBundle(buf);
+        const wxBitmap bitmap = bundle.GetBitmap(bitmapSize);
+
+        if ( !bitmap.IsOk() )
+            return reportError();
+    }
+
+    allocs->total = allocCollector.GetStats();
+    allocs->phases = phaseCollector.GetAllocs();
+
+    ++batches.doneCount;
+    batches.done = true;
+    return true;
+}
+
+bool wxTestSVGRasterizationBenchmark::TimeBatch(const Backend& backend, Mode mode, const wxMemoryBuffer& buf,
+                                                const wxSize& bitmapSize, size_t iterationCount,
+                                                wxLongLong_t& time)
+{
+    using Clock = std::chrono::steady_clock;
+
+    if ( IsLunaSVGOnlyMode(mode) )
+        return TimeLunaSVGBatch(mode, buf, bitmapSize, iterationCount, time);
+
+    // destroyed only after the batch is timed, except the bundles
+    // of the full mode
+    std::vector<wxBitmapBundle> bundles;
+    std::vector<wxBitmap>       bitmaps;
+
+    bundles.reserve(mode != Mode_Full ? iterationCount : 0);
+    bitmaps.reserve(iterationCount);
+
+    if ( mode != Mode_Full )
+    {
+        // do not include bundle creation in benchmark, create the bundles
+        // here outside the benched loop; in the cold mode each bundle
+        // rasterizes only once so that its bitmap cache is not used,
+        // in the warm mode the bitmap is already in the cache
+        for ( size_t i = 0; i < iterationCount; ++i )
+        {
+            bundles.push_back(backend.createBundle(buf));
+            if ( !bundles.back().IsOk() )
+                return false;
+            if ( mode == Mode_WarmBitmap && !bundles.back().GetBitmap(bitmapSize).IsOk() )
+                return false;
+        }
+    }
+
+    const Clock::time_point start = Clock::now();
+
+    for ( size_t i = 0; i < iterationCount; ++i )
+    {
+        if ( mode == Mode_Full )
+        {
+            // include bundle creation and destruction in benchmark; a bundle
+            // still alive would share its parsed document with the next one
+            const wxBitmapBundle bundle = backend.createBundle(buf);
+
+            if ( !bundle.IsOk() )
+                return false;
+            bitmaps.push_back(bundle.GetBitmap(bitmapSize));
+        }
+        else
+        {
+            bitmaps.push_back(bundles[i].GetBitmap(bitmapSize));
+        }
+    }
+
+    time = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+
+    for ( const auto& bitmap : bitmaps )
+    {
+        if ( !bitmap.IsOk() )
+            return false;
+    }
+
+    return true;
+}
+
+bool wxTestSVGRasterizationBenchmark::TimeLunaSVGBatch(Mode mode, const wxMemoryBuffer& buf,
+                                                       const wxSize& bitmapSize, size_t iterationCount,
+                                                       wxLongLong_t& time)
+{
+    using Clock = std::chrono::steady_clock;
+
+    const char*  data = static_cast<const char*>(buf.GetData());
+    const size_t dataLen = buf.GetDataLen();
+
+    // destroyed only after the batch is timed
+    std::vector<std::unique_ptr<lunasvg::Document>> documents;
+    std::vector<lunasvg::Bitmap>                    bitmaps;
+
+    documents.reserve(iterationCount);
+    bitmaps.reserve(mode == Mode_Render ? iterationCount : 0);
+
+    // parsed documents to lay out, or a single document with layout
+    // to render, as rendering does not modify it
+    if ( mode == Mode_Layout )
+    {
+        for ( size_t i = 0; i < iterationCount; ++i )
+        {
+            documents.push_back(lunasvg::Document::parseFromData(data, dataLen));
+            if ( !documents.back() )
+                return false;
+        }
+    }
+    else if ( mode == Mode_Render )
+    {
+        documents.push_back(lunasvg::Document::loadFromData(data, dataLen));
+        if ( !documents.back() )
+            return false;
+    }
+
+    const Clock::time_point start = Clock::now();
+
+    for ( size_t i = 0; i < iterationCount; ++i )
+    {
+        if ( mode == Mode_Parse )
+        {
+            documents.push_back(lunasvg::Document::parseFromData(data, dataLen));
+        }
+        else if ( mode == Mode_Layout )
+        {
+            documents[i]->updateLayout();
+        }
+        else
+        {
+            // the same as wxBitmapBundleImplLunaSVG, without converting the pixels
+            const lunasvg::Document& document = *documents.front();
+            const double             scale = wxMin(bitmapSize.x / document.width(), bitmapSize.y / document.height());
+
+            bitmaps.emplace_back(bitmapSize.x, bitmapSize.y);
+            bitmaps.back().clear(0);
+            document.render(bitmaps.back(), lunasvg::Matrix::scaled(scale, scale));
+        }
+    }
+
+    time = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+
+    for ( const auto& document : documents )
+    {
+        if ( !document )
+            return false;
+    }
+
+    for ( const auto& bitmap : bitmaps )
+    {
+        if ( !bitmap.valid() )
+            return false;
+    }
+
+    return true;
+}
+
+wxTestSVGBenchmarkHistory::Run wxTestSVGRasterizationBenchmark::CreateHistoryRun(const VectorModeResults& results,
+                                                                                  size_t runCount) const
+{
+    wxTestSVGBenchmarkHistory::Run run;
+
+    run.time        = wxDateTime::Now();
+    run.dirName     = m_dirName;
+    run.runCount    = runCount;
+    run.environment = wxTestSVGBenchmarkHistory::Environment::GetCurrent();
+
+    for ( const auto& r : results )
+    {
+        for ( size_t b = 0; b < m_backends.size(); ++b )
+        {
+            for ( size_t f = 0; f < r.stats[b].size(); ++f )
+            {
+                for ( size_t s = 0; s < m_sizes.size(); ++s )
+                {
+                    wxTestSVGBenchmarkHistory::Result result;
+
+                    result.mode     = GetModeKey(r.mode);
+                    result.backend  = m_backends[b].name;
+                    result.fileName = m_fileNames[f];
+                    result.size     = m_sizes[s];
+                    result.median   = r.stats[b][f][s].mdn;
+                    run.results.push_back(result);
+                }
+            }
+        }
+    }
+
+    return run;
+}
+
+void wxTestSVGRasterizationBenchmark::CreateReport(const VectorModeResults& results,
+                                                   const MatrixPhases2& phasesLuna, const MatrixAllocs& allocsLuna,
+                                                   size_t runCount, const std::vector<wxTestSVGBenchmarkHistory::Run>& history,
+                                                   wxString& reportText)
+{
+    const auto formatCell = [](const Stats& stats)
+    {
+        return wxString::Format(R"(<td title="p90 %.2f, p99 %.2f, 95%% CI %.2f-%.2f, %zu outliers">%.2f</td>)",
+                                stats.p90 / 1000, stats.p99 / 1000, stats.ciLow / 1000, stats.ciHigh / 1000,
+                                stats.outliers, stats.mdn / 1000);
+    };
+
+    static const struct
+    {
+        const char* name;
+        double      divisor;
+        double (*get)(const Totals&);
+    } totalInfos[] =
+    {
+        { "Sum (milliseconds)",                   1000000, [](const Totals& t) { return t.sum; } },
+        { "Sum 95% CI (&plusmn; milliseconds)",   1000000, [](const Totals& t) { return std::sqrt(t.sumCIVariance); } },
+        { "Sum of p90 (milliseconds)",            1000000, [](const Totals& t) { return t.sumP90; } },
+        { "Sum of p99 (milliseconds)",            1000000, [](const Totals& t) { return t.sumP99; } },
+        { "Min",                                  1000,    [](const Totals& t) { return t.min; } },
+        { "Max",                                  1000,    [](const Totals& t) { return t.max; } },
+    };
+
+    // LunaSVG phases, collected only in the full mode
+    static const struct
+    {
+        const char*                         name;
+        wxLongLong_t wxLunaSVGPhaseTimes::* phase;
+    } phaseInfos[] =
+    {
+        { "Parse",   &wxLunaSVGPhaseTimes::parse },
+        { "Layout",  &wxLunaSVGPhaseTimes::layout },
+        { "Render",  &wxLunaSVGPhaseTimes::render },
+        { "Convert", &wxLunaSVGPhaseTimes::convert },
+    };
+
+    wxArrayString result;
+    wxString      rowStr;
+    BackendTotals totals(m_backends.size(), MatrixTotals(results.size(), std::vector<Totals>(m_sizes.size())));
+
+    for ( size_t m = 0; m < results.size(); ++m )
+    {
+        for ( size_t b = 0; b < m_backends.size(); ++b )
+        {
+            for ( size_t f = 0; f < results[m].stats[b].size(); ++f )
+            {
+                for ( size_t s = 0; s < m_sizes.size(); ++s )
+                    totals[b][m][s].Add(results[m].stats[b][f][s]);
+            }
+        }
+    }
+
+    // the cells of the backends not benchmarked in the mode are empty
+    const auto formatTotals = [&](size_t m, size_t s, double (*get)(const Totals&), double divisor)
+    {
+        wxString cells;
+
+        for ( size_t b = 0; b < m_backends.size(); ++b )
+        {
+            if ( results[m].stats[b].empty() )
+                cells += "<td></td>";
+            else
+                cells += wxString::Format("<td>%.2f</td>", get(totals[b][m][s]) / divisor);
+        }
+        return cells;
+    };
+
+    // the header rows of a table with a column for each backend and size
+    const auto addSizeHeaders = [&](const char* firstColumn)
+    {
+        rowStr = R"(<table>)";
+        rowStr += R"(<thead><tr>)";
+        rowStr += wxString::Format(R"(<th rowspan="2">%s</th>)", firstColumn);
+        for ( const auto& s : m_sizes )
+        {
+            rowStr += wxString::Format(R"(<th colspan="%zu">%dx%d</th>)", m_backends.size(), s.x, s.y);
+        }
+        rowStr += R"(</tr>)";
+        rowStr += "\n";
+        result.push_back(rowStr);
+
+        rowStr = R"(<tr>)";
+        for ( size_t i = 0; i < m_sizes.size(); ++i )
+        {
+            for ( const auto& backend : m_backends )
+                rowStr += wxString::Format("<th>%s</th>", backend.name);
+        }
+        rowStr += R"(</tr>)";
+        rowStr += R"(</thead>)";
+        rowStr += "\n";
+        result.push_back(rowStr);
+    };
+
+    rowStr = R"(<!DOCTYPE html><html><head><meta charset="UTF-8"><meta name="description" content="wxTestSVG2 Report">)";
+    rowStr += "<style>";
+    rowStr += "table, th, td, tfoot {border: 1px solid black; border-collapse: collapse;} td {text-align: right;} tfoot {color: red;} ";
+    rowStr += "body {font-family: Verdana, Arial, Helvetica, sans-serif;}";
+    rowStr += "</style></head><body>\n";
+    result.push_back(rowStr);
+
+    result.push_back(wxString::Format("<h3>Benchmarked %zu files from folder '%s' (%zu runs)</h1>",
+        m_fileNames.size(), m_dirName, runCount));
+    if ( m_fileNames.size() < m_startedFileCount )
+    {
+        result.push_back(wxString::Format("<p>The benchmark was stopped before it benchmarked all %zu files, "
+                                          "so this run was not added to the history.</p>", m_startedFileCount));
+    }
+    result.push_back("<p>Unless indicated otherwise, the times are medians in microseconds, "
+                     "hover over a time to see its 90th and 99th percentiles and the 95% confidence "
+                     "interval of the median.</p>");
+    result.push_back(wxString::Format("<p>Each file was rasterized %d times before the timed runs. "
+                                      "A timed run consists of as many iterations as needed to take "
+                                      "at least %d microseconds and its time is divided by the iteration count. "
+                                      "The runs farther from the median than %g scaled median absolute "
+                                      "deviations are rejected as outliers.</p>",
+                                      WXSVGTEST2_BENCH_WARMUP_RUNS, WXSVGTEST2_BENCH_MIN_BATCH_MICRO,
+                                      OutlierMADCount));
+    result.push_back("<p>Backends:</p>");
+    result.push_back("<ul>");
+    for ( const auto& backend : m_backends )
+        result.push_back(wxString::Format("<li><b>%s</b>: %s</li>", backend.name, backend.description));
+    result.push_back("</ul>");
+    result.push_back("<p>Parse, layout and render only modes use LunaSVG directly, without wxBitmapBundle, "
+                     "so only the plain LunaSVG backend is benchmarked in them; render does not include converting the pixels. "
+                     "Cold GetBitmap times a bundle which did not create any bitmap yet, warm GetBitmap "
+                     "a bundle which already created the bitmap of the same size, i.e., the bitmap cache. "
+                     "Full includes also creating the bundle from SVG in memory.</p>");
+
+    // sums for all modes side by side
+    result.push_back("<h4>Modes</h4>");
+    result.push_back("<p>Sums of medians of all files in milliseconds</p>");
+    addSizeHeaders("Mode");
+    result.push_back("<tbody>\n");
+    for ( size_t m = 0; m < results.size(); ++m )
+    {
+        rowStr = wxString::Format("<tr><td>%s</td>", GetModeName(results[m].mode));
+        for ( size_t s = 0; s < m_sizes.size(); ++s )
+            rowStr += formatTotals(m, s, totalInfos[0].get, totalInfos[0].divisor);
+        rowStr += "</tr>\n";
+        result.push_back(rowStr);
+    }
+    result.push_back("</tbody>\n");
+    result.push_back("</table>\n");
+
+    if ( !history.empty() )
+        CreateTrendReport(results, history, result);
+
+    // each file in each mode
+    for ( size_t m = 0; m < results.size(); ++m )
+    {
+        const ModeResults& r = results[m];
+
+        result.push_back(wxString::Format("<h4>%s</h4>", GetModeName(r.mode)));
+        addSizeHeaders("File");
+
+        result.push_back("<tbody>\n");
+        for ( size_t f = 0; f < m_fileNames.size(); ++f )
+        {
+            rowStr = wxString::Format("<tr><td>%s</td>", wxFileName(m_fileNames[f]).GetName());
+            for ( size_t s = 0; s < m_sizes.size(); ++s )
+            {
+                for ( size_t b = 0; b < m_backends.size(); ++b )
+                    rowStr += r.stats[b].empty() ? wxString("<td></td>") : formatCell(r.stats[b][f][s]);
+            }
+            rowStr += "</tr>\n";
+            result.push_back(rowStr);
+        }
+        result.push_back("</tbody>\n");
+
+        result.push_back("<tfoot>\n");
+        for ( const auto& ti : totalInfos )
+        {
+            rowStr.Printf("<tr><td>%s</td>", ti.name);
+            for ( size_t s = 0; s < m_sizes.size(); ++s )
+                rowStr += formatTotals(m, s, ti.get, ti.divisor);
+            result.push_back(rowStr + "</tr>\n");
+        }
+
+        if ( r.mode == Mode_Full && !phasesLuna.empty() )
+        {
+            const wxString& phasesName = m_backends[m_phasesBackend].name;
+
+            // sums of LunaSVG phase medians, only in the column of the backend with the phases
+            for ( const auto& pi : phaseInfos )
+            {
+                rowStr.Printf("<tr><td>%s %s Sum (milliseconds)</td>", phasesName, pi.name);
+                for ( size_t s = 0; s < m_sizes.size(); ++s )
+                {
+                    double sum = 0;
+
+                    for ( size_t f = 0; f < m_fileNames.size(); ++f )
+                        sum += phasesLuna[f][s].*pi.phase;
+                    rowStr += FormatPhasesCells(wxString::Format("<td>%.2f</td>", sum / 1000000));
+                }
+                result.push_back(rowStr + "</tr>\n");
+            }
+
+            // LunaSVG memory, also only in that column
+            wxString allocsStr, peaksStr;
+
+            allocsStr.Printf("<tr><td>%s Allocations Sum</td>", phasesName);
+            peaksStr.Printf("<tr><td>%s Peak Max (KiB)</td>", phasesName);
+            for ( size_t s = 0; s < m_sizes.size(); ++s )
+            {
+                wxULongLong_t allocCount = 0, peak = 0;
+
+                for ( size_t f = 0; f < m_fileNames.size(); ++f )
+                {
+                    allocCount += allocsLuna[f][s].total.count;
+                    peak = wxMax(peak, allocsLuna[f][s].total.peakLive);
+                }
+                allocsStr += FormatPhasesCells(wxString::Format("<td>%" wxLongLongFmtSpec "u</td>", allocCount));
+                peaksStr += FormatPhasesCells(wxString::Format("<td>%.1f</td>", peak / 1024.));
+            }
+            result.push_back(allocsStr + "</tr>\n");
+            result.push_back(peaksStr + "</tr>\n");
+        }
+
+        result.push_back("</tfoot>");
+        result.push_back("</table>\n");
+    }
+
+    if ( phasesLuna.empty() )
+    {
+        result.push_back("<p>LunaSVG phases and memory are collected only in the full mode "
+                         "of the plain LunaSVG backend.</p>");
+        result.push_back("</body></html>");
+
+        for ( const auto& r : result )
+            reportText += r + "\n";
+        return;
+    }
+
+    // LunaSVG phases for each file
+    result.push_back("<h4>LunaSVG phases</h4>");
+    result.push_back("<p>Medians of each phase in microseconds, the rest of the total time "
+                     "is spent creating wxBitmapBundle and wxBitmap</p>");
+
+    rowStr = R"(<table>)";
+    rowStr += R"(<thead><tr>)";
+    rowStr += R"(<th rowspan="2">File</th>)";
+    for ( const auto& s : m_sizes )
+        rowStr += wxString::Format(R"(<th colspan="%zu">%dx%d</th>)", WXSIZEOF(phaseInfos), s.x, s.y);
+    rowStr += R"(</tr>)";
+    rowStr += "\n";
+    result.push_back(rowStr);
+
+    rowStr = R"(<tr>)";
+    for ( size_t i = 0; i < m_sizes.size(); ++i )
+    {
+        for ( const auto& pi : phaseInfos )
+            rowStr += wxString::Format("<th>%s</th>", pi.name);
+    }
+    rowStr += R"(</tr>)";
+    rowStr += R"(</thead>)";
+    rowStr += "\n";
+    result.push_back(rowStr);
+
+    result.push_back("<tbody>\n");
+    for ( size_t f = 0; f < m_fileNames.size(); ++f )
+    {
+        rowStr = wxString::Format("<tr><td>%s</td>", wxFileName(m_fileNames[f]).GetName());
+        for ( size_t s = 0; s < m_sizes.size(); ++s )
+        {
+            for ( const auto& pi : phaseInfos )
+                rowStr += wxString::Format("<td>%.1f</td>", phasesLuna[f][s].*pi.phase / 1000.);
+        }
+        rowStr += "</tr>\n";
+        result.push_back(rowStr);
+    }
+    result.push_back("</tbody>\n");
+    result.push_back("</table>\n");
+
+    // LunaSVG memory for each file
+    static const struct
+    {
+        const char*                       name;
+        AllocStats wxLunaSVGPhaseAllocs::* phase;
+    } phaseAllocInfos[] =
+    {
+        { "Parse Peak",   &wxLunaSVGPhaseAllocs::parse },
+        { "Layout Peak",  &wxLunaSVGPhaseAllocs::layout },
+        { "Render Peak",  &wxLunaSVGPhaseAllocs::render },
+        { "Convert Peak", &wxLunaSVGPhaseAllocs::convert },
+    };
+    const size_t allocColumnCount = 3 + WXSIZEOF(phaseAllocInfos);
+
+    result.push_back("<h4>LunaSVG memory</h4>");
+    result.push_back("<p>Allocations made by operator new and the LunaSVG rasterizer in an untimed run, "
+                     "the sizes are in KiB. Peak is the highest amount of memory allocated "
+                     "and not yet freed at the same time. Memory allocated by the native "
+                     "wxBitmap implementation is not included.</p>");
+
+    rowStr = R"(<table>)";
+    rowStr += R"(<thead><tr>)";
+    rowStr += R"(<th rowspan="2">File</th>)";
+    for ( const auto& s : m_sizes )
+        rowStr += wxString::Format(R"(<th colspan="%zu">%dx%d</th>)", allocColumnCount, s.x, s.y);
+    rowStr += R"(</tr>)";
+    rowStr += "\n";
+    result.push_back(rowStr);
+
+    rowStr = R"(<tr>)";
+    for ( size_t i = 0; i < m_sizes.size(); ++i )
+    {
+        rowStr += "<th>Allocs</th><th>Allocated</th><th>Peak</th>";
+        for ( const auto& pi : phaseAllocInfos )
+            rowStr += wxString::Format("<th>%s</th>", pi.name);
+    }
+    rowStr += R"(</tr>)";
+    rowStr += R"(</thead>)";
+    rowStr += "\n";
+    result.push_back(rowStr);
+
+    result.push_back("<tbody>\n");
+    for ( size_t f = 0; f < m_fileNames.size(); ++f )
+    {
+        rowStr = wxString::Format("<tr><td>%s</td>", wxFileName(m_fileNames[f]).GetName());
+        for ( size_t s = 0; s < m_sizes.size(); ++s )
+        {
+            const Allocs& a = allocsLuna[f][s];
+
+            rowStr += wxString::Format("<td>%" wxLongLongFmtSpec "u</td><td>%.1f</td><td>%.1f</td>",
+                                       static_cast<wxULongLong_t>(a.total.count),
+                                       a.total.bytes / 1024., a.total.peakLive / 1024.);
+            for ( const auto& pi : phaseAllocInfos )
+                rowStr += wxString::Format("<td>%.1f</td>", (a.phases.*pi.phase).peakLive / 1024.);
+        }
+        rowStr += "</tr>\n";
+        result.push_back(rowStr);
+    }
+    result.push_back("</tbody>\n");
+    result.push_back("</table>\n");
+
+    result.push_back("</body></html>");
+
+    for ( const auto& r : result )
+        reportText += r + "\n";
+}
+
+void wxTestSVGRasterizationBenchmark::CreateTrendReport(const VectorModeResults& results,
+                                                        const std::vector<wxTestSVGBenchmarkHistory::Run>& history,
+                                                        wxArrayString& result)
+{
+    using Environment = wxTestSVGBenchmarkHistory::Environment;
+    using Result = wxTestSVGBenchmarkHistory::Result;
+
+    // Tango palette, the backends are usually Nano and Luna first
+    static const char* const colors[] =
+    {
+        "#f57900", "#3465a4", "#73d216", "#75507b", "#cc0000", "#c17d11", "#edd400", "#555753"
+    };
+
+    static const struct
+    {
+        const char*             name;
+        wxString Environment::* value;
+    } environmentInfos[] =
+    {
+        { "Commit",    &Environment::gitCommit },
+        { "LunaSVG",   &Environment::lunasvgVersion },
+        { "wxWidgets", &Environment::wxWidgetsVersion },
+        { "Compiler",  &Environment::compiler },
+        { "Flags",     &Environment::buildFlags },
+        { "CPU",       &Environment::cpu },
+    };
+
+    const size_t firstRun = history.size() > WXSVGTEST2_BENCH_TREND_RUNS ? history.size() - WXSVGTEST2_BENCH_TREND_RUNS : 0;
+    const size_t runCount = history.size() - firstRun;
+    wxString     rowStr;
+
+    result.push_back("<h4>Trends</h4>");
+
+    if ( runCount < 2 )
+    {
+        result.push_back(wxString::Format("<p>This is the first run of the folder in the history file '%s', "
+                                          "the trends are shown when it contains more runs.</p>", m_historyFileName));
+        return;
+    }
+
+    result.push_back(wxString::Format("<p>The last %zu runs of the folder from the history file '%s', "
+                                      "the last one is this run. The values which changed from the previous "
+                                      "run are in bold.</p>", runCount, m_historyFileName));
+
+    rowStr = "<table><thead><tr><th>Run</th><th>Time</th><th>Runs</th>";
+    for ( const auto& ei : environmentInfos )
+        rowStr += wxString::Format("<th>%s</th>", ei.name);
+    rowStr += "</tr></thead>\n";
+    result.push_back(rowStr);
+
+    result.push_back("<tbody>\n");
+    for ( size_t i = firstRun; i < history.size(); ++i )
+    {
+        const wxTestSVGBenchmarkHistory::Run& run = history[i];
+
+        rowStr.Printf("<tr><td>%zu</td><td>%s</td><td>%zu</td>",
+                      i - firstRun + 1, run.time.FormatISOCombined(' '), run.runCount);
+        for ( const auto& ei : environmentInfos )
+        {
+            const wxString& value = run.environment.*ei.value;
+            const bool      changed = i > firstRun && value != history[i - 1].environment.*ei.value;
+
+            rowStr += wxString::Format(changed ? "<td><b>%s</b></td>" : "<td>%s</td>", value);
+        }
+        rowStr += "</tr>\n";
+        result.push_back(rowStr);
+    }
+    result.push_back("</tbody>\n");
+    result.push_back("</table>\n");
+
+    // the results of each run by mode, backend, file name and size
+    const auto makeKey = [](const wxString& mode, const wxString& backend, const wxString& fileName, const wxSize& size)
+    {
+        return wxString::Format("%s\t%s\t%s\t%dx%d", mode, backend, fileName, size.x, size.y);
+    };
+    std::vector<std::map<wxString, const Result*>> indices(runCount);
+
+    for ( size_t i = 0; i < runCount; ++i )
+    {
+        for ( const auto& r : history[firstRun + i].results )
+            indices[i][makeKey(r.mode, r.backend, r.fileName, r.size)] = &r;
+    }
+
+    // medians of a file in microseconds for each run, NaN when it was not benchmarked
+    const auto getTrend = [&](Mode mode, size_t backend, const wxString& fileName, const wxSize& size)
+    {
+        const wxString      key = makeKey(GetModeKey(mode), m_backends[backend].name, fileName, size);
+        std::vector<double> values(runCount, std::numeric_limits<double>::quiet_NaN());
+
+        for ( size_t i = 0; i < runCount; ++i )
+        {
+            const auto it = indices[i].find(key);
+
+            if ( it != indices[i].end() )
+                values[i] = it->second->median / 1000;
+        }
+
+        return values;
+    };
+
+    for ( const auto& r : results )
+    {
+        std::vector<size_t> backends; // benchmarked in the mode
+        std::vector<Chart>  charts;
+
+        for ( size_t b = 0; b < m_backends.size(); ++b )
+        {
+            if ( !r.stats[b].empty() )
+                backends.push_back(b);
+        }
+
+        if ( backends.empty() )
+            continue;
+
+        // the change is shown for the plain LunaSVG backend if possible
+        size_t changeBackend = backends.front();
+
+        if ( std::find(backends.begin(), backends.end(), m_phasesBackend) != backends.end() )
+            changeBackend = m_phasesBackend;
+
+        result.push_back(wxString::Format("<h5>%s</h5>", GetModeName(r.mode)));
+        result.push_back("<p>Sums of medians of the files benchmarked now, the runs which did not "
+                         "benchmark all of them are not shown</p>");
+
+        for ( const auto& size : m_sizes )
+        {
+            Chart chart;
+
+            chart.title = wxString::Format("%dx%d", size.x, size.y).ToStdString();
+            chart.xLabel = "run";
+            chart.yLabel = "milliseconds";
+            for ( size_t i = 0; i < runCount; ++i )
+                chart.x.push_back(i + 1);
+
+            // a missing median makes the sum NaN
+            for ( const size_t b : backends )
+            {
+                ChartSeries series{m_backends[b].name.ToStdString(), colors[b % WXSIZEOF(colors)],
+                                   std::vector<double>(runCount)};
+
+                for ( const auto& fileName : m_fileNames )
+                {
+                    const std::vector<double> trend = getTrend(r.mode, b, fileName, size);
+
+                    for ( size_t i = 0; i < runCount; ++i )
+                        series.values[i] += trend[i] / 1000;
+                }
+
+                chart.series.push_back(series);
+            }
+
+            charts.push_back(chart);
+        }
+
+        result.push_back(wxString::FromUTF8(CreateChartsSVG(std::string(), charts, 3).c_str()));
+
+        result.push_back(wxString::Format("<p>Medians of each file, the change is of %s in this run "
+                                          "from the oldest run shown</p>", m_backends[changeBackend].name));
+
+        rowStr = "<table><thead><tr><th>File</th>";
+        for ( const auto& size : m_sizes )
+            rowStr += wxString::Format("<th>%dx%d</th>", size.x, size.y);
+        rowStr += "</tr></thead>\n";
+        result.push_back(rowStr);
+
+        result.push_back("<tbody>\n");
+        for ( const auto& fileName : m_fileNames )
+        {
+            rowStr = wxString::Format("<tr><td>%s</td>", wxFileName(fileName).GetName());
+            for ( const auto& size : m_sizes )
+            {
+                std::vector<ChartSeries> series;
+
+                for ( const size_t b : backends )
+                {
+                    series.push_back({m_backends[b].name.ToStdString(), colors[b % WXSIZEOF(colors)],
+                                      getTrend(r.mode, b, fileName, size)});
+                }
+
+                const std::vector<double> trend = getTrend(r.mode, changeBackend, fileName, size);
+                const auto                oldest = std::find_if(trend.begin(), trend.end(),
+                                                                [](double v) { return !std::isnan(v); });
+                wxString                  change;
+
+                if ( oldest != trend.end() && *oldest > 0 && !std::isnan(trend.back()) )
+                    change.Printf("%+.1f%%", 100 * (trend.back() - *oldest) / *oldest);
+
+                rowStr += wxString::Format("<td>%s %s</td>",
+                                           wxString::FromUTF8(CreateSparklineSVG(series, 80, 20).c_str()), change);
+            }
+            rowStr += "</tr>\n";
+            result.push_back(rowStr);
+        }
+        result.push_back("</tbody>\n");
+        result.push_back("</table>\n");
+    }
+}
+
+void wxTestSVGRasterizationBenchmark::WriteStreamingResults(wxFFile& file, const wxString& fileName, Mode mode,
+                                                            const std::vector<const VectorStats*>& stats,
+                                                            const VectorPhases* phasesLuna, const VectorAllocs* allocsLuna)
+{
+    // times in microseconds, sizes in bytes
+    const auto formatStats = [](const Stats& stats)
+    {
+        return wxString::Format("\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\t%zu",
+                                stats.mdn / 1000, stats.min / 1000, stats.max / 1000,
+                                stats.p90 / 1000, stats.p99 / 1000, stats.ciLow / 1000, stats.ciHigh / 1000,
+                                stats.outliers);
+    };
+
+    // the values which were not measured are empty
+    const wxString emptyStats('\t', 8);
+    const wxString emptyPhasesAndAllocs('\t', 7);
+
+    wxString lines;
+
+    for ( size_t s = 0; s < m_sizes.size(); ++s )
+    {
+        lines += wxString::Format("%s\t%d\t%d\t%s", fileName, m_sizes[s].x, m_sizes[s].y, GetModeName(mode));
+        for ( const auto backendStats : stats )
+            lines += backendStats ? formatStats((*backendStats)[s]) : emptyStats;
+
+        if ( phasesLuna && allocsLuna )
+        {
+            const wxLunaSVGPhaseTimes& p = (*phasesLuna)[s];
+            const AllocStats&          a = (*allocsLuna)[s].total;
+
+            lines += wxString::Format("\t%.3f\t%.3f\t%.3f\t%.3f", p.parse / 1000., p.layout / 1000.,
+                                      p.render / 1000., p.convert / 1000.);
+            lines += wxString::Format("\t%" wxLongLongFmtSpec "u\t%" wxLongLongFmtSpec "u\t%" wxLongLongFmtSpec "u",
+                                      static_cast<wxULongLong_t>(a.count), static_cast<wxULongLong_t>(a.bytes),
+                                      static_cast<wxULongLong_t>(a.peakLive));
+        }
+        else if ( m_phasesBackend != NoBackend ) // otherwise there are no columns for them
+        {
+            lines += emptyPhasesAndAllocs;
+        }
+        lines += "\n";
+    }
+
+    file.Write(lines, wxConvUTF8);
+}
+
+void wxTestSVGRasterizationBenchmark::CreateStreamingReport(const BackendTotals& totals,
+                                                            const VectorPhases& phaseSumsLuna,
+                                                            const VectorAllocs& allocTotalsLuna,
+                                                            size_t runCount, size_t benchmarkedCount,
+                                                            const wxArrayString& failedFileNames,
+                                                            const wxString& resultsFileName,
+                                                            wxString& reportText)
+{
+    wxArrayString result;
+    wxString      rowStr;
+
+    rowStr = R"(<!DOCTYPE html><html><head><meta charset="UTF-8"><meta name="description" content="wxTestSVG2 Report">)";
+    rowStr += "<style>";
+    rowStr += "table, th, td {border: 1px solid black; border-collapse: collapse;} td {text-align: right;} ";
+    rowStr += "body {font-family: Verdana, Arial, Helvetica, sans-serif;}";
+    rowStr += "</style></head><body>\n";
+    result.push_back(rowStr);
+
+    result.push_back(wxString::Format("<h3>Benchmarked %zu files from folder '%s' (%zu runs)</h3>",
+        benchmarkedCount, m_dirName, runCount));
+    result.push_back(wxString::Format("<p>The results for each file and size were written to '%s'. "
+                                      "Unless indicated otherwise, the times are in milliseconds.</p>",
+                                      resultsFileName));
+
+    // create headers
+    rowStr = R"(<table>)";
+    rowStr += R"(<thead><tr>)";
+    rowStr += R"(<th rowspan="2"></th>)";
+    for ( const auto& s : m_sizes )
+        rowStr += wxString::Format(R"(<th colspan="%zu">%dx%d</th>)", m_backends.size(), s.x, s.y);
+    rowStr += R"(</tr>)";
+    rowStr += "\n";
+    result.push_back(rowStr);
+
+    rowStr = R"(<tr>)";
+    for ( size_t i = 0; i < m_sizes.size(); ++i )
+    {
+        for ( const auto& backend : m_backends )
+            rowStr += wxString::Format("<th>%s</th>", backend.name);
+    }
+    rowStr += R"(</tr>)";
+    rowStr += R"(</thead>)";
+    rowStr += "\n";
+    result.push_back(rowStr);
+
+    static const struct
+    {
+        const char* name;
+        double      divisor;
+        double (*get)(const Totals&);
+    } totalInfos[] =
+    {
+        { "Sum of medians",          1000000, [](const Totals& t) { return t.sum; } },
+        { "Sum 95% CI (&plusmn;)",   1000000, [](const Totals& t) { return std::sqrt(t.sumCIVariance); } },
+        { "Sum of p90",              1000000, [](const Totals& t) { return t.sumP90; } },
+        { "Sum of p99",              1000000, [](const Totals& t) { return t.sumP99; } },
+        { "Min median (microseconds)", 1000,  [](const Totals& t) { return t.min; } },
+        { "Max median (microseconds)", 1000,  [](const Totals& t) { return t.max; } },
+    };
 
     result.push_back("<tbody>\n");
-    for ( size_t f = 0; f < m_fileNames.size(); ++f )
+    for ( size_t m = 0; m < m_modes.size(); ++m )
     {
-        rowStr = wxString::Format("<tr><td>%s</td>", wxFileName(m_fileNames[f]).GetName());
-        for ( size_t s = 0; s < m_sizes.size(); ++s )
+        result.push_back(wxString::Format(R"(<tr><th colspan="%zu">%s</th></tr>)",
+                                          1 + m_backends.size() * m_sizes.size(), GetModeName(m_modes[m])) + "\n");
+        for ( const auto& ti : totalInfos )
         {
-            rowStr += wxString::Format("<td>%ld</td><td>%ld</td>", statsNano[f][s].mdn, statsLuna[f][s].mdn);
+            rowStr.Printf("<tr><td>%s</td>", ti.name);
+            for ( size_t s = 0; s < m_sizes.size(); ++s )
+            {
+                for ( size_t b = 0; b < m_backends.size(); ++b )
+                {
+                    if ( IsBenchmarked(m_modes[m], b) )
+                        rowStr += wxString::Format("<td>%.2f</td>", ti.get(totals[b][m][s]) / ti.divisor);
+                    else
+                        rowStr += "<td></td>";
+                }
+            }
+            result.push_back(rowStr + "</tr>\n");
+        }
+    }
 
-            sumsNano[s] += statsNano[f][s].mdn;
-            if ( statsNano[f][s].mdn < minsNano[s] )
-                minsNano[s] = statsNano[f][s].mdn;
-            if ( statsNano[f][s].mdn > maxesNano[s] )
-                maxesNano[s] = statsNano[f][s].mdn;
+    // LunaSVG phases and memory of the full mode, only in the column of the backend with them
+    if ( CollectsPhases() )
+    {
+        const wxString& phasesName = m_backends[m_phasesBackend].name;
+
+        result.push_back(wxString::Format(R"(<tr><th colspan="%zu">LunaSVG phases and memory (%s)</th></tr>)",
+                                          1 + m_backends.size() * m_sizes.size(), GetModeName(Mode_Full)) + "\n");
+
+        static const struct
+        {
+            const char*                         name;
+            wxLongLong_t wxLunaSVGPhaseTimes::* phase;
+        } phaseInfos[] =
+        {
+            { "Parse Sum",   &wxLunaSVGPhaseTimes::parse },
+            { "Layout Sum",  &wxLunaSVGPhaseTimes::layout },
+            { "Render Sum",  &wxLunaSVGPhaseTimes::render },
+            { "Convert Sum", &wxLunaSVGPhaseTimes::convert },
+        };
 
-            sumsLuna[s] += statsLuna[f][s].mdn;
-            if ( statsLuna[f][s].mdn < minsLuna[s] )
-                minsLuna[s] = statsLuna[f][s].mdn;
-            if ( statsLuna[f][s].mdn > maxesLuna[s] )
-                maxesLuna[s] = statsLuna[f][s].mdn;
+        for ( const auto& pi : phaseInfos )
+        {
+            rowStr.Printf("<tr><td>%s %s</td>", phasesName, pi.name);
+            for ( size_t s = 0; s < m_sizes.size(); ++s )
+                rowStr += FormatPhasesCells(wxString::Format("<td>%.2f</td>", phaseSumsLuna[s].*pi.phase / 1000000.));
+            result.push_back(rowStr + "</tr>\n");
         }
-        rowStr += "</tr>\n";
-        result.push_back(rowStr);
+
+        wxString allocsStr, peaksStr;
+
+        allocsStr.Printf("<tr><td>%s Allocations Sum</td>", phasesName);
+        peaksStr.Printf("<tr><td>%s Peak Max (KiB)</td>", phasesName);
+        for ( size_t s = 0; s < m_sizes.size(); ++s )
+        {
+            const AllocStats& a = allocTotalsLuna[s].total;
+
+            allocsStr += FormatPhasesCells(wxString::Format("<td>%" wxLongLongFmtSpec "u</td>", static_cast<wxULongLong_t>(a.count)));
+            peaksStr += FormatPhasesCells(wxString::Format("<td>%.1f</td>", a.peakLive / 1024.));
+        }
+        result.push_back(allocsStr + "</tr>\n");
+        result.push_back(peaksStr + "</tr>\n");
     }
-    result.push_back("</tbody>\n");
 
-    wxString sumsStr, minsStr, maxesStr;
+    result.push_back("</tbody>\n");
+    result.push_back("</table>\n");
 
-    sumsStr = "<tfoot><tr><td>Sum (milliseconds)</td>";
-    minsStr = "<tr><td>Min</td>";
-    maxesStr = "<tr><td>Max</td>";
-    for ( size_t s = 0; s < m_sizes.size(); ++s )
+    if ( !failedFileNames.empty() )
     {
-        sumsStr += wxString::Format("<td>%.2f</td><td>%.2f</td>", sumsNano[s] / 1000, sumsLuna[s] / 1000);
-        minsStr += wxString::Format("<td>%ld</td><td>%ld</td>", minsNano[s], minsLuna[s]);
-        maxesStr += wxString::Format("<td>%ld</td><td>%ld</td>", maxesNano[s], maxesLuna[s]);
+        result.push_back(wxString::Format("<h4>%zu files could not be benchmarked</h4>", failedFileNames.size()));
+        result.push_back("<ul>");
+        for ( const auto& name : failedFileNames )
+            result.push_back(wxString::Format("<li>%s</li>", name));
+        result.push_back("</ul>");
     }
-    result.push_back(sumsStr + "</tr>\n");
-    result.push_back(minsStr + "</tr>\n");
-    result.push_back(maxesStr + "</tr>\n");
-    result.push_back("<tfoot>");
-    result.push_back("</table>\n");
+
     result.push_back("</body></html>");
 
     for ( const auto& r : result )
@@ -281,12 +1751,9 @@ void wxTestSVGRasterizationBenchmark::CreateReport(const MatrixStats& statsNano,
 }
 
 // if !asHTML, the result is plaintext with the values separated by tabs
-void wxTestSVGRasterizationBenchmark::CreateDetailedReport(const MatrixLong3& timesNano, const MatrixStats& statsNano,
-                                                           const MatrixLong3& timesLuna,  const MatrixStats& statsLuna,
+void wxTestSVGRasterizationBenchmark::CreateDetailedReport(const VectorModeResults& results, size_t runCount,
                                                            bool asHTML, wxString& reportText)
 {
-    const size_t runCount = timesNano[0][0].size();
-
     wxArrayString result;
     wxString      rowStr;
 
@@ -298,194 +1765,326 @@ void wxTestSVGRasterizationBenchmark::CreateDetailedReport(const MatrixLong3& ti
         rowStr += "body {font-family: Verdana, Arial, Helvetica, sans-serif}";
         rowStr += "</style></head><body>\n";
         result.push_back(rowStr);
+
+        result.push_back(wxString::Format("<h3>Benchmarked %zu files from folder '%s'</h1>", m_fileNames.size(), m_dirName));
+        result.push_back("<p>All times are in microseconds, the statistics are calculated "
+                         "without the outliers</p>");
     }
 
-    // create headers
-    if ( asHTML )
+    static const struct
     {
-        result.push_back(wxString::Format("<h3>Benchmarked %zu files from folder '%s'</h1>", m_fileNames.size(), m_dirName));
-        result.push_back("<p>All times are in microseconds</p>");
-        rowStr = R"(<table style="width:100%">)";
-        rowStr += R"(<thead><tr>)";
-        rowStr += R"(<th rowspan="3">Run</th>)";
-        for ( const auto& f : m_fileNames )
+        const char*     name;
+        double Stats::* value;
+    } statInfos[] =
+    {
+        { "Median",   &Stats::mdn },
+        { "Mean",     &Stats::avg },
+        { "Min",      &Stats::min },
+        { "Max",      &Stats::max },
+        { "P90",      &Stats::p90 },
+        { "P99",      &Stats::p99 },
+        { "CI Low",   &Stats::ciLow },
+        { "CI High",  &Stats::ciHigh },
+    };
+
+    const wxChar* valueFormatHTML = wxS("<td>%.2f</td>");
+    const wxChar* valueFormatTSV = wxS("%.2f\t");
+
+    const size_t backendCount = m_backends.size();
+
+    for ( const auto& r : results )
+    {
+        // the values of the backends not benchmarked in the mode are empty
+        const auto formatValues = [&](const std::function<double (size_t backend)>& get)
+        {
+            wxString values;
+
+            for ( size_t b = 0; b < backendCount; ++b )
+            {
+                if ( r.stats[b].empty() )
+                    values += asHTML ? wxS("<td></td>") : wxS("\t");
+                else
+                    values += wxString::Format(asHTML ? valueFormatHTML : valueFormatTSV, get(b));
+            }
+            return values;
+        };
+
+        // create headers
+        if ( asHTML )
         {
-            rowStr += wxString::Format(R"(<th colspan="%zu">%s</th>)",
-                m_sizes.size() * 2, wxFileName(f).GetName());
+            result.push_back(wxString::Format("<h4>%s</h4>", GetModeName(r.mode)));
+            rowStr = R"(<table style="width:100%">)";
+            rowStr += R"(<thead><tr>)";
+            rowStr += R"(<th rowspan="3">Run</th>)";
+            for ( const auto& f : m_fileNames )
+            {
+                rowStr += wxString::Format(R"(<th colspan="%zu">%s</th>)",
+                    m_sizes.size() * backendCount, wxFileName(f).GetName());
+            }
+            rowStr += R"(</tr>)";
         }
-        rowStr += R"(</tr>)";
-    }
-    else
-    {
-        rowStr = "Run\t";
-        for ( const auto& f : m_fileNames )
+        else
         {
-            rowStr += wxFileName(f).GetName();
-            rowStr += wxString('\t', m_sizes.size() * 2);
+            result.push_back(GetModeName(r.mode));
+            rowStr = "Run\t";
+            for ( const auto& f : m_fileNames )
+            {
+                rowStr += wxFileName(f).GetName();
+                rowStr += wxString('\t', m_sizes.size() * backendCount);
+            }
         }
-    }
-    rowStr += "\n";
-    result.push_back(rowStr);
+        rowStr += "\n";
+        result.push_back(rowStr);
 
-    if ( asHTML )
-    {
-        rowStr = R"(<tr>)";
-        for ( const auto& f : m_fileNames )
+        if ( asHTML )
+        {
+            rowStr = R"(<tr>)";
+            for ( const auto& f : m_fileNames )
+            {
+                wxUnusedVar(f);
+                for ( const auto& s : m_sizes )
+                    rowStr += wxString::Format(R"(<th colspan="%zu">%dx%d</th>)", backendCount, s.x, s.y);
+            }
+            rowStr += R"(</tr>)";
+        }
+        else
         {
-            wxUnusedVar(f);
-            for ( const auto& s : m_sizes )
-                rowStr += wxString::Format(R"(<th colspan="2">%dx%d</th>)", s.x, s.y);
+            rowStr = "\t"; // Run column
+            for ( const auto& f : m_fileNames )
+            {
+                wxUnusedVar(f);
+                for ( const auto& s : m_sizes )
+                    rowStr += wxString::Format("%dx%d", s.x, s.y) + wxString('\t', backendCount);
+            }
+            rowStr.RemoveLast(backendCount); // extra tabs at the end of the row
         }
-        rowStr += R"(</tr>)";
-    }
-    else
-    {
-        rowStr = "\t"; // Run column
-        for ( const auto& f : m_fileNames )
+        rowStr += "\n";
+        result.push_back(rowStr);
+
+        if ( asHTML )
+        {
+            rowStr = R"(<tr>)";
+            for ( size_t i = 0; i < m_fileNames.size() * m_sizes.size(); ++i )
+            {
+                for ( const auto& backend : m_backends )
+                    rowStr += wxString::Format("<th>%s</th>", backend.name);
+            }
+            rowStr += R"(</tr>)";
+            rowStr += R"(</thead>)";
+        }
+        else
         {
-            wxUnusedVar(f);
-            for ( const auto& s : m_sizes )
-                rowStr += wxString::Format("%dx%d\t\t", s.x, s.y);
+            rowStr.clear();
+            for ( size_t i = 0; i < m_fileNames.size() * m_sizes.size(); ++i )
+            {
+                for ( const auto& backend : m_backends )
+                    rowStr += "\t" + backend.name;
+            }
         }
-        rowStr.RemoveLast(2); // extra tabs at the end of the row
-    }
-    rowStr += "\n";
-    result.push_back(rowStr);
+        rowStr += "\n";
+        result.push_back(rowStr);
 
-    if ( asHTML )
-    {
-        rowStr = R"(<tr>)";
-        for ( size_t i = 0; i < m_fileNames.size() * m_sizes.size(); ++i )
-            rowStr += "<th>Nano</th><th>Luna</th>";
-        rowStr += R"(</tr>)";
-        rowStr += R"(</thead>)";
-    }
-    else
-    {
-        rowStr.clear();
-        for ( size_t i = 0; i < m_fileNames.size() * m_sizes.size(); ++i )
-            rowStr += "\tNano\tLuna";
-    }
-    rowStr += "\n";
-    result.push_back(rowStr);
+        if ( asHTML )
+            result.push_back("<tbody>\n");
+        for ( size_t run = 0; run < runCount; ++run )
+        {
+            if ( asHTML )
+                rowStr.Printf(R"(<tr><td>%zu</td>)", run + 1);
+            else
+                rowStr.Printf("%zu\t", run + 1);
 
-    const wxChar* valueFormatHTML = wxS("<td>%ld</td><td>%ld</td>");
-    const wxChar* valueFormatTSV = wxS("%ld\t%ld\t");
+            for ( size_t f = 0; f < m_fileNames.size(); ++f )
+            {
+                for ( size_t s = 0; s < m_sizes.size(); ++s )
+                {
+                    rowStr += formatValues([&](size_t b) { return r.times[b][f][s][run] / 1000; });
+                }
+
+            }
+            if ( asHTML )
+                rowStr += R"(</tr>)";
+            else
+                rowStr.RemoveLast(); // extra tab
+
+            rowStr += "\n";
+            result.push_back(rowStr);
+        }
 
-    if ( asHTML )
-        result.push_back("<tbody>\n");
-    for ( size_t run = 0; run < runCount; ++run )
-    {
         if ( asHTML )
-            rowStr.Printf(R"(<tr><td>%zu</td>)", run + 1);
-        else
-            rowStr.Printf("%zu\t", run + 1);
+            result.push_back("</tbody>\n");
+
+        if ( asHTML )
+            result.push_back("<tfoot>");
+
+        for ( const auto& si : statInfos )
+        {
+            if ( asHTML )
+                rowStr.Printf("<tr><td>%s</td>", si.name);
+            else
+                rowStr.Printf("%s\t", si.name);
+
+            for ( size_t f = 0; f < m_fileNames.size(); ++f )
+            {
+                for ( size_t s = 0; s < m_sizes.size(); ++s )
+                {
+                    rowStr += formatValues([&](size_t b) { return r.stats[b][f][s].*si.value / 1000; });
+                }
+            }
+
+            if ( asHTML )
+                rowStr += "</tr>";
+            else
+                rowStr.RemoveLast(); // extra tab
+
+            result.push_back(rowStr);
+        }
 
+        rowStr = asHTML ? "<tr><td>Outliers</td>" : "Outliers\t";
         for ( size_t f = 0; f < m_fileNames.size(); ++f )
         {
             for ( size_t s = 0; s < m_sizes.size(); ++s )
             {
-                rowStr += wxString::Format(asHTML ? valueFormatHTML : valueFormatTSV,
-                    timesNano[f][s][run], timesLuna[f][s][run]);
+                for ( size_t b = 0; b < backendCount; ++b )
+                {
+                    if ( r.stats[b].empty() )
+                        rowStr += asHTML ? wxS("<td></td>") : wxS("\t");
+                    else
+                        rowStr += wxString::Format(asHTML ? wxS("<td>%zu</td>") : wxS("%zu\t"), r.stats[b][f][s].outliers);
+                }
             }
-
         }
         if ( asHTML )
-            rowStr += R"(</tr>)";
+            rowStr += "</tr>";
         else
             rowStr.RemoveLast(); // extra tab
 
-        rowStr += "\n";
         result.push_back(rowStr);
+
+        if ( asHTML )
+            result.push_back("</tfoot></table>\n");
     }
 
     if ( asHTML )
-        result.push_back("</tbody>\n");
+        result.push_back("</body></html>");
 
-    wxString mdnRow("Median");
-    wxString avgRow("Mean");
-    wxString minRow("Min ");
-    wxString maxRow("Max");
+    for ( const auto& r : result )
+        reportText += r + "\n";
+}
 
-    if ( asHTML )
-    {
-        result.push_back("<tfoot>");
-        mdnRow.Printf("<tr><td>%s</td>", mdnRow);
-        avgRow.Printf("<tr><td>%s</td>", avgRow);
-        minRow.Printf("<tr><td>%s</td>", minRow);
-        maxRow.Printf("<tr><td>%s</td>", maxRow);
-    }
-    else
-    {
-        mdnRow.Printf("%s\t", mdnRow);
-        avgRow.Printf("%s\t", avgRow);
-        minRow.Printf("%s\t", minRow);
-        maxRow.Printf("%s\t", maxRow);
-    }
+void wxTestSVGRasterizationBenchmark::Totals::Add(const Stats& stats)
+{
+    const double ciHalfWidth = (stats.ciHigh - stats.ciLow) / 2;
+
+    sum += stats.mdn;
+    sumP90 += stats.p90;
+    sumP99 += stats.p99;
+    sumCIVariance += ciHalfWidth * ciHalfWidth;
+    min = wxMin(min, stats.mdn);
+    max = wxMax(max, stats.mdn);
+}
 
-    for ( size_t f = 0; f < m_fileNames.size(); ++f )
-    {
-        for ( size_t s = 0; s < m_sizes.size(); ++s )
-        {
-            mdnRow += wxString::Format(asHTML ? valueFormatHTML : valueFormatTSV,
-                statsNano[f][s].mdn, statsLuna[f][s].mdn);
-            avgRow += wxString::Format(asHTML ? valueFormatHTML : valueFormatTSV,
-                statsNano[f][s].avg, statsLuna[f][s].avg);
-            minRow += wxString::Format(asHTML ? valueFormatHTML : valueFormatTSV,
-                statsNano[f][s].min, statsLuna[f][s].min);
-            maxRow += wxString::Format(asHTML ? valueFormatHTML : valueFormatTSV,
-                statsNano[f][s].max, statsLuna[f][s].max);
-        }
-    }
-    if ( asHTML )
+wxTestSVGRasterizationBenchmark::Stats wxTestSVGRasterizationBenchmark::CalcStats(const VectorTimes& data)
+{
+    Stats stats;
+
+    if ( data.empty() )
+        return stats;
+
+    VectorTimes dataSorted(data);
+
+    std::sort(dataSorted.begin(), dataSorted.end());
+
+    // reject outliers using median absolute deviation, scaled to be
+    // comparable to the standard deviation of normally distributed data
+    const double median = CalcPercentile(dataSorted, 50);
+    VectorTimes  deviations;
+
+    deviations.reserve(dataSorted.size());
+    for ( const auto d : dataSorted )
+        deviations.push_back(std::fabs(d - median));
+    std::sort(deviations.begin(), deviations.end());
+
+    const double mad = CalcPercentile(deviations, 50) * 1.4826;
+
+    if ( mad > 0 )
     {
-        mdnRow += "</tr>";
-        avgRow += "</tr>";
-        minRow += "</tr>";
-        maxRow += "</tr>";
+        dataSorted.erase(std::remove_if(dataSorted.begin(), dataSorted.end(),
+                            [median, mad](double d) { return std::fabs(d - median) > OutlierMADCount * mad; }),
+                         dataSorted.end());
+        stats.outliers = data.size() - dataSorted.size();
     }
-    else // extra tabs
+
+    stats.min = dataSorted.front();
+    stats.max = dataSorted.back();
+    stats.mdn = CalcPercentile(dataSorted, 50);
+    stats.avg = std::accumulate(dataSorted.begin(), dataSorted.end(), 0.0) / dataSorted.size();
+    stats.p90 = CalcPercentile(dataSorted, 90);
+    stats.p99 = CalcPercentile(dataSorted, 99);
+
+    // percentile bootstrap, with a fixed seed so that the same times
+    // always give the same interval
+    std::mt19937                          generator(static_cast<std::mt19937::result_type>(dataSorted.size()));
+    std::uniform_int_distribution<size_t> distribution(0, dataSorted.size() - 1);
+    VectorTimes                           resample(dataSorted.size());
+    VectorTimes                           medians(BootstrapResampleCount);
+
+    for ( auto& m : medians )
     {
-        mdnRow.RemoveLast();
-        avgRow.RemoveLast();
-        minRow.RemoveLast();
-        maxRow.RemoveLast();
+        for ( auto& r : resample )
+            r = dataSorted[distribution(generator)];
+        std::sort(resample.begin(), resample.end());
+        m = CalcPercentile(resample, 50);
     }
+    std::sort(medians.begin(), medians.end());
 
-    result.push_back(mdnRow);
-    result.push_back(avgRow);
-    result.push_back(minRow);
-    result.push_back(maxRow);
+    stats.ciLow = CalcPercentile(medians, 2.5);
+    stats.ciHigh = CalcPercentile(medians, 97.5);
 
-    if ( asHTML )
-    {
-        result.push_back("</tfoot></table>\n");
-        result.push_back("</body></html>");
-    }
+    return stats;
+}
 
-    for ( const auto& r : result )
-        reportText += r + "\n";
+double wxTestSVGRasterizationBenchmark::CalcPercentile(const VectorTimes& sortedData, double percentile)
+{
+    wxCHECK(!sortedData.empty(), 0);
+
+    const double rank = percentile / 100 * (sortedData.size() - 1);
+    const size_t lower = static_cast<size_t>(rank);
+    const size_t upper = wxMin(lower + 1, sortedData.size() - 1);
+
+    return sortedData[lower] + (sortedData[upper] - sortedData[lower]) * (rank - lower);
 }
 
-wxTestSVGRasterizationBenchmark::Stats wxTestSVGRasterizationBenchmark::CalcStatsForVectorLong(const VectorLong& data)
+wxLunaSVGPhaseTimes wxTestSVGRasterizationBenchmark::CalcPhaseMedians(const VectorPhases& data)
 {
-    VectorLong dataSorted(data);
-    Stats      stats;
-    wxLongLong sum = 0;
+    wxLunaSVGPhaseTimes medians;
 
-    std::sort(dataSorted.begin(), dataSorted.end());
+    if ( data.empty() )
+        return medians;
+
+    const auto calcMedian = [&data](wxLongLong_t wxLunaSVGPhaseTimes::* phase) -> wxLongLong_t
+    {
+        std::vector<wxLongLong_t> values;
 
-    stats.min = dataSorted[0];
-    stats.max = dataSorted[dataSorted.size() - 1];
+        values.reserve(data.size());
+        for ( const auto& d : data )
+            values.push_back(d.*phase);
 
-    stats.mdn = dataSorted[dataSorted.size() / 2];
-    if ( !(data.size() % 2) ) // even number
-        stats.mdn = (stats.mdn + dataSorted[(dataSorted.size() / 2) - 1]) / 2;
+        std::sort(values.begin(), values.end());
 
-    sum = std::accumulate(dataSorted.begin(), dataSorted.end(), sum);
-    stats.avg = ( sum / dataSorted.size() ).ToLong();
+        wxLongLong_t median = values[values.size() / 2];
 
-    return stats;
+        if ( !(values.size() % 2) ) // even number
+            median = (median + values[(values.size() / 2) - 1]) / 2;
+
+        return median;
+    };
+
+    medians.parse   = calcMedian(&wxLunaSVGPhaseTimes::parse);
+    medians.layout  = calcMedian(&wxLunaSVGPhaseTimes::layout);
+    medians.render  = calcMedian(&wxLunaSVGPhaseTimes::render);
+    medians.convert = calcMedian(&wxLunaSVGPhaseTimes::convert);
+
+    return medians;
 }
 
 // ============================================================================
@@ -505,7 +2104,9 @@ wxTestSVGBenchmarkReportFrame::wxTestSVGBenchmarkReportFrame(wxWindow* parent,
     wxMenu* menuFile = new wxMenu;
 
     menuFile->Append(wxID_SAVEAS);
-    menuFile->Append(ID_SAVE_DETAILED, "Save &Detailed Report As...");
+    // there is no detailed report for a streaming benchmark
+    if ( !detailedReport.empty() )
+        menuFile->Append(ID_SAVE_DETAILED, "Save &Detailed Report As...");
 
     Bind(wxEVT_MENU, &wxTestSVGBenchmarkReportFrame::OnSaveReport, this, wxID_SAVEAS);
     Bind(wxEVT_MENU, &wxTestSVGBenchmarkReportFrame::OnSaveDetailedReport, this, ID_SAVE_DETAILED);
@@ -555,4 +2156,195 @@ bool wxTestSVGBenchmarkReportFrame::WriteHTMLReport(const wxString& fileName, co
         return false;
 
     return reportFile.Write(reportText, wxConvUTF8);
-}
\ No newline at end of file
+}
+
+// ============================================================================
+// wxTestSVGBenchmarkProgressFrame
+// ============================================================================
+
+static wxString FormatDuration(long milliseconds)
+{
+    const long seconds = milliseconds / 1000;
+
+    return wxString::Format("%ld:%02ld:%02ld", seconds / 3600, seconds / 60 % 60, seconds % 60);
+}
+
+wxTestSVGBenchmarkProgressFrame::wxTestSVGBenchmarkProgressFrame(wxWindow* parent,
+                    const wxTestSVGRasterizationBenchmark& benchmark,
+                    size_t runCount)
+    : wxFrame(parent, wxID_ANY, "Benchmark Progress"),
+      m_benchmark(benchmark)
+{
+    SetIcon(wxICON(wxICON_AAA)); // from wx.rc
+
+    wxPanel*    panel = new wxPanel(this);
+    wxBoxSizer* panelSizer = new wxBoxSizer(wxVERTICAL);
+    wxString    sizes;
+
+    for ( const auto& s : m_benchmark.GetSizes() )
+        sizes += wxString::Format("%dx%d, ", s.x, s.y);
+    sizes.RemoveLast(2);
+
+    m_statusText = new wxStaticText(panel, wxID_ANY, wxString());
+    panelSizer->Add(m_statusText, wxSizerFlags().Expand().Border());
+
+    m_gauge = new wxGauge(panel, wxID_ANY, 1);
+    panelSizer->Add(m_gauge, wxSizerFlags().Expand().Border(wxLEFT | wxRIGHT));
+
+    panelSizer->Add(new wxStaticText(panel, wxID_ANY, wxString::Format("Medians in microseconds at %s", sizes)),
+                    wxSizerFlags().Border());
+
+    m_resultsList = new wxListCtrl(panel, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxLC_REPORT | wxLC_SINGLE_SEL);
+    m_resultsList->AppendColumn("File");
+    for ( const auto mode : m_benchmark.GetModes() )
+    {
+        for ( size_t b = 0; b < m_benchmark.GetBackends().size(); ++b )
+        {
+            if ( !m_benchmark.IsBenchmarked(mode, b) )
+                continue;
+
+            m_resultsList->AppendColumn(wxString::Format("%s: %s", wxTestSVGRasterizationBenchmark::GetModeName(mode),
+                                                         m_benchmark.GetBackends()[b].name), wxLIST_FORMAT_RIGHT);
+        }
+    }
+    panelSizer->Add(m_resultsList, wxSizerFlags(1).Expand().Border(wxLEFT | wxRIGHT));
+
+    m_stopButton = new wxButton(panel, wxID_ANY, "&Stop");
+    m_stopButton->Bind(wxEVT_BUTTON, &wxTestSVGBenchmarkProgressFrame::OnStop, this);
+    panelSizer->Add(m_stopButton, wxSizerFlags().Right().Border());
+
+    panel->SetSizer(panelSizer);
+
+    Bind(wxEVT_IDLE, &wxTestSVGBenchmarkProgressFrame::OnIdle, this);
+    Bind(wxEVT_CLOSE_WINDOW, &wxTestSVGBenchmarkProgressFrame::OnClose, this);
+
+    SetMinClientSize(FromDIP(wxSize(800, 500)));
+    Show();
+
+    if ( !m_benchmark.Start(runCount) )
+    {
+        m_statusText->SetLabel("Couldn't start the benchmark.");
+        m_stopButton->SetLabel("&Close");
+        return;
+    }
+
+    m_gauge->SetRange(static_cast<int>(m_benchmark.GetStepCount()));
+    m_running = true;
+    m_stopWatch.Start();
+    UpdateStatus();
+}
+
+void wxTestSVGBenchmarkProgressFrame::OnIdle(wxIdleEvent& event)
+{
+    event.Skip();
+
+    if ( !m_running )
+        return;
+
+    // the events are processed only between the batches of the steps
+    if ( !m_benchmark.Step() )
+    {
+        Finish("Stopped, a file could not be benchmarked");
+        return;
+    }
+
+    UpdateResultsList();
+
+    if ( m_benchmark.IsDone() )
+    {
+        Finish("Finished");
+        return;
+    }
+
+    UpdateStatus();
+    event.RequestMore();
+}
+
+void wxTestSVGBenchmarkProgressFrame::OnStop(wxCommandEvent&)
+{
+    if ( m_running )
+        Finish("Stopped");
+    else
+        Close();
+}
+
+void wxTestSVGBenchmarkProgressFrame::OnClose(wxCloseEvent& event)
+{
+    // the results are discarded, the backends are torn down by the benchmark
+    m_running = false;
+    event.Skip();
+}
+
+void wxTestSVGBenchmarkProgressFrame::UpdateResultsList()
+{
+    const size_t doneFileCount = m_benchmark.GetDoneFileCount();
+
+    for ( ; m_shownFileCount < doneFileCount; ++m_shownFileCount )
+    {
+        const size_t f = m_shownFileCount;
+        const long   item = m_resultsList->InsertItem(m_resultsList->GetItemCount(),
+                                                      wxFileName(m_benchmark.GetFileNames()[f]).GetName());
+        int          column = 1;
+
+        for ( size_t m = 0; m < m_benchmark.GetModes().size(); ++m )
+        {
+            for ( size_t b = 0; b < m_benchmark.GetBackends().size(); ++b )
+            {
+                if ( !m_benchmark.IsBenchmarked(m_benchmark.GetModes()[m], b) )
+                    continue;
+
+                wxString medians;
+
+                for ( const double median : m_benchmark.GetMedians(f, m, b) )
+                    medians += wxString::Format("%.1f / ", median / 1000);
+                medians.RemoveLast(3);
+                m_resultsList->SetItem(item, column++, medians);
+            }
+        }
+
+        m_resultsList->EnsureVisible(item);
+    }
+}
+
+void wxTestSVGBenchmarkProgressFrame::UpdateStatus()
+{
+    const size_t doneStepCount = m_benchmark.GetDoneStepCount();
+    const size_t stepCount = m_benchmark.GetStepCount();
+    const long   elapsed = m_stopWatch.Time();
+    size_t       file = 0, mode = 0, backend = 0, size = 0;
+    wxString     remaining;
+
+    m_benchmark.GetStep(doneStepCount, file, mode, backend, size);
+
+    // assuming all the steps take about the same time
+    if ( doneStepCount > 0 )
+    {
+        remaining.Printf(", about %s remaining",
+                         FormatDuration(static_cast<long>(static_cast<double>(elapsed) / doneStepCount
+                                                          * (stepCount - doneStepCount))));
+    }
+
+    m_statusText->SetLabel(wxString::Format("Benchmarking file %zu of %zu '%s' (%s, %s, %dx%d), %s elapsed%s",
+                                            file + 1, m_benchmark.GetFileNames().size(), m_benchmark.GetFileNames()[file],
+                                            wxTestSVGRasterizationBenchmark::GetModeName(m_benchmark.GetModes()[mode]),
+                                            m_benchmark.GetBackends()[backend].name,
+                                            m_benchmark.GetSizes()[size].x, m_benchmark.GetSizes()[size].y,
+                                            FormatDuration(elapsed), remaining));
+    m_gauge->SetValue(static_cast<int>(doneStepCount));
+}
+
+void wxTestSVGBenchmarkProgressFrame::Finish(const wxString& status)
+{
+    const size_t fileCount = m_benchmark.GetFileNames().size();
+    wxString     report, detailedReport;
+
+    m_running = false;
+    m_stopButton->SetLabel("&Close");
+    m_gauge->SetValue(static_cast<int>(m_benchmark.GetDoneStepCount()));
+    m_statusText->SetLabel(wxString::Format("%s, %zu of %zu files were benchmarked in %s.", status,
+                                            m_benchmark.GetDoneFileCount(), fileCount,
+                                            FormatDuration(m_stopWatch.Time())));
+
+    if ( m_benchmark.Finish(report, detailedReport) )
+        new wxTestSVGBenchmarkReportFrame(GetParent(), m_benchmark.GetDirName(), report, detailedReport);
+}
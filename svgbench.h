@@ -10,10 +10,18 @@
 #ifndef TEST_SVG_BENCH_H_DEFINED
 #define TEST_SVG_BENCH_H_DEFINED
 
+#include <functional>
+#include <limits>
+#include <utility>
 #include <vector>
 
 #include <wx/wx.h>
 #include <wx/buffer.h>
+#include <wx/ffile.h>
+#include <wx/stopwatch.h>
+
+#include "benchhistory.h"
+#include "bmpbndl_lunasvg.h"
 
 // ============================================================================
 // wxTestSVGRasterizationBenchmark
@@ -22,48 +30,305 @@
 class wxTestSVGRasterizationBenchmark
 {
 public:
+    // what is timed, several modes can be benchmarked side by side
+    enum Mode
+    {
+        Mode_Parse,      // LunaSVG only: parsing SVG into a document without layout
+        Mode_Layout,     // LunaSVG only: computing the layout of a parsed document
+        Mode_Render,     // LunaSVG only: rendering a document with layout into lunasvg::Bitmap
+        Mode_ColdBitmap, // wxBitmapBundle::GetBitmap() of a bundle which did not create any bitmap yet
+        Mode_WarmBitmap, // wxBitmapBundle::GetBitmap() of a bundle which already created the same bitmap
+        Mode_Full,       // creating wxBitmapBundle from SVG in memory and GetBitmap()
+
+        Mode_Count
+    };
+
+    static wxString GetModeName(Mode mode);
+
+    // not localized and never changed, used in the benchmark history
+    static wxString GetModeKey(Mode mode);
+
+    // NanoSVG can be benchmarked only when used by wxBitmapBundle
+    static bool IsLunaSVGOnlyMode(Mode mode);
+
+    // a way of creating bitmap bundles, the backends of a benchmark
+    // are benchmarked side by side, each in its own report column
+    struct Backend
+    {
+        wxString name;        // short and unique, used in the reports and the history
+        wxString description; // shown when selecting the backends
+
+        // creates the bundle from the data returned by prepareData
+        std::function<wxBitmapBundle (const wxMemoryBuffer& data)> createBundle;
+
+        // optional, converts the contents of an SVG file to the data passed
+        // to createBundle, it is not timed and an empty result fails the file
+        std::function<wxMemoryBuffer (const wxMemoryBuffer& svg)> prepareData;
+
+        // optional, called before the first file is benchmarked and after
+        // the last one, nothing is benchmarked when setup returns false
+        std::function<bool ()> setup;
+        std::function<void ()> teardown;
+
+        // creates the bundles with LunaSVG from SVG without any changes, only
+        // such backends are benchmarked in LunaSVG only modes and the phases
+        // and memory of the first one are collected in the full mode
+        bool isPlainLunaSVG{false};
+    };
+
+    // "Nano" and "Luna" are registered first, followed by the LunaSVG variants
+    // "Luna compiled" and "Luna disk cache"; backends registered later can be
+    // selected for benchmarking as well
+    static void RegisterBackend(const Backend& backend);
+    static const std::vector<Backend>& GetRegisteredBackends();
+
+    // returns nullptr if there is no such backend
+    static const Backend* FindRegisteredBackend(const wxString& name);
+
+    // "Nano" and "Luna"
+    static std::vector<Backend> GetDefaultBackends();
+
     wxTestSVGRasterizationBenchmark();
+    ~wxTestSVGRasterizationBenchmark();
 
     void Setup(const wxString& dirName, const wxArrayString& fileNames,
-               const std::vector<wxSize>& sizes);
+               const std::vector<wxSize>& sizes,
+               const std::vector<Mode>& modes = std::vector<Mode>(1, Mode_Full),
+               const std::vector<Backend>& backends = GetDefaultBackends());
+
+    // Run() appends the medians to the history file and the report
+    // shows their trends, empty fileName (the default) means no history
+    void SetHistoryFileName(const wxString& fileName) { m_historyFileName = fileName; }
+
+    const wxString&             GetDirName() const { return m_dirName; }
+    const wxArrayString&        GetFileNames() const { return m_fileNames; }
+    const std::vector<wxSize>&  GetSizes() const { return m_sizes; }
+    const std::vector<Mode>&    GetModes() const { return m_modes; }
+    const std::vector<Backend>& GetBackends() const { return m_backends; }
+
+    bool IsBenchmarked(Mode mode, size_t backend) const;
 
     bool Run(size_t runCount, wxString& report, wxString& detailedReport);
 
+    // Run() split into steps, so that the GUI can process events between
+    // them: Start() sets up the backends, each Step() runs one batch (a warmup
+    // run, a timed batch or the allocation counting) of the step benchmarking
+    // one file at one size in one mode with one backend and Finish() tears down the backends
+    // and creates the reports of the files benchmarked in all modes with
+    // all backends, also when it is called before all steps were done;
+    // only the runs with all files are added to the history
+    bool Start(size_t runCount);
+    bool Step(); // returns false if the file could not be benchmarked
+    bool Finish(wxString& report, wxString& detailedReport); // returns false if no file was benchmarked
+
+    // the steps counted here are the whole ones, done after all their batches
+    size_t GetStepCount() const { return m_fileNames.size() * GetFileStepCount(); }
+    size_t GetDoneStepCount() const { return m_doneStepCount; }
+    size_t GetDoneFileCount() const;
+    bool   IsDone() const { return m_doneStepCount == GetStepCount(); }
+
+    // the indices of the file, mode, backend and size benchmarked in the step
+    void GetStep(size_t step, size_t& file, size_t& mode, size_t& backend, size_t& size) const;
+
+    // medians of a file for each size in nanoseconds, valid only after
+    // the file was benchmarked at all sizes
+    std::vector<double> GetMedians(size_t file, size_t mode, size_t backend) const;
+
+    // for folders with thousands of files: the statistics for each file
+    // are appended to resultsFileName (tab-separated text) as soon as the
+    // file is benchmarked, only the totals for each size are kept in memory
+    // and report contains only them; the files which fail are skipped
+    bool RunStreaming(size_t runCount, const wxString& resultsFileName, wxString& report);
+
 private:
-    // times in ms for one file and one bitmap size
-    using VectorLong  = std::vector<long>;
-    using MatrixLong2 = std::vector<VectorLong>;
-    using MatrixLong3 = std::vector<MatrixLong2>;
+    // times in nanoseconds for one file and one bitmap size, each time
+    // is the time of a batch of iterations divided by the iteration count
+    using VectorTimes  = std::vector<double>;
+    using MatrixTimes2 = std::vector<VectorTimes>;
+    using MatrixTimes3 = std::vector<MatrixTimes2>;
 
+    // calculated after the outliers were rejected
     struct Stats
     {
-        long min{0};
-        long max{0};
-        long mdn{0};
-        long avg{0};
+        double min{0};
+        double max{0};
+        double mdn{0};
+        double avg{0};
+        double p90{0};
+        double p99{0};
+        double ciLow{0};  // 95% bootstrap confidence interval of the median
+        double ciHigh{0};
+        size_t outliers{0};
     };
     using VectorStats = std::vector<Stats>;
     using MatrixStats = std::vector<VectorStats>;
 
-    using CreateBitmapBundleFn = wxBitmapBundle (*) (const wxMemoryBuffer&);
+    // the results of all files in one mode for each backend, empty
+    // for the backends which are not benchmarked in the mode
+    struct ModeResults
+    {
+        Mode                      mode{Mode_Full};
+        std::vector<MatrixTimes3> times;
+        std::vector<MatrixStats>  stats;
+    };
+    using VectorModeResults = std::vector<ModeResults>;
+
+    // for all files at one bitmap size
+    struct Totals
+    {
+        double sum{0};
+        double sumP90{0};
+        double sumP99{0};
+        double sumCIVariance{0}; // of the half-widths, assuming the files are independent
+        double min{std::numeric_limits<double>::max()};
+        double max{0};
 
-    wxString            m_dirName;
-    wxArrayString       m_fileNames;
-    std::vector<wxSize> m_sizes;
+        void Add(const Stats& stats);
+    };
+    using MatrixTotals  = std::vector<std::vector<Totals>>; // for each mode and size
+    using BackendTotals = std::vector<MatrixTotals>;        // for each backend
 
-    // benchmarks a single file for all bitmap sizes
-    bool BenchmarkFile(CreateBitmapBundleFn createBundleFn,
+    // LunaSVG phase times for one file and one bitmap size
+    using VectorPhases  = std::vector<wxLunaSVGPhaseTimes>;
+    using MatrixPhases2 = std::vector<VectorPhases>;
+    using MatrixPhases3 = std::vector<MatrixPhases2>;
+
+    // LunaSVG allocations for one file and one bitmap size
+    struct Allocs
+    {
+        AllocStats           total;
+        wxLunaSVGPhaseAllocs phases;
+    };
+    using VectorAllocs = std::vector<Allocs>;
+    using MatrixAllocs = std::vector<VectorAllocs>;
+
+    static const size_t NoBackend = static_cast<size_t>(-1);
+
+    // the state of benchmarking a file at one size in batches
+    struct SizeBatches
+    {
+        size_t       doneCount{0};
+        wxLongLong_t minWarmupTime{std::numeric_limits<wxLongLong_t>::max()};
+        size_t       iterationCount{1};
+        bool         done{false};
+    };
+
+    wxString             m_dirName;
+    wxArrayString        m_fileNames;
+    std::vector<wxSize>  m_sizes;
+    std::vector<Mode>    m_modes;
+    std::vector<Backend> m_backends;
+    size_t               m_phasesBackend{NoBackend}; // the first plain LunaSVG one
+    wxString             m_historyFileName;
+
+    // the state of a run in steps, for each file and size the steps
+    // benchmark the mode and backend pairs in m_stepUnits
+    std::vector<std::pair<size_t, size_t>> m_stepUnits;
+    std::vector<wxMemoryBuffer>            m_stepData; // of m_stepDataFile for each step unit
+    size_t                                 m_stepDataFile{0};
+    SizeBatches                            m_stepBatches; // of the step being done
+    size_t                                 m_runCount{0};
+    size_t                                 m_doneStepCount{0};
+    size_t                                 m_startedFileCount{0}; // m_fileNames are truncated by Finish()
+    bool                                   m_backendsSetUp{false};
+    VectorModeResults                      m_results;
+    MatrixPhases3                          m_phasesLuna;
+    MatrixAllocs                           m_allocsLuna;
+
+    size_t GetFileStepCount() const { return m_stepUnits.size() * m_sizes.size(); }
+
+    // the LunaSVG phases and allocations are collected only in Mode_Full,
+    // in the other modes they would include also the untimed work
+    bool CollectsPhases() const;
+
+    // returns cell in the column of the backend with the phases and
+    // empty cells in the columns of the others
+    wxString FormatPhasesCells(const wxString& cell) const;
+
+    // calls setup of all backends, when one fails, the ones already
+    // set up are torn down and false is returned
+    bool SetupBackends();
+    void TeardownBackends(); // does nothing if they are not set up
+
+    // called by RunStreaming() between setting up and tearing down the backends
+    bool DoRunStreaming(size_t runCount, const wxString& resultsFileName, wxString& report);
+
+    // benchmarks a single file for all bitmap sizes, if phases is not null,
+    // it is filled with the times of LunaSVG phases, if allocs is not null,
+    // it is filled with the allocations for each size made in the last run;
+    // the backend is not used in LunaSVG only modes
+    bool BenchmarkFile(const Backend& backend, Mode mode,
                        const wxString& fileName,
-                       size_t runCount, MatrixLong2& times);
+                       size_t runCount, MatrixTimes2& times,
+                       MatrixPhases2* phases = nullptr,
+                       VectorAllocs* allocs = nullptr);
+
+    // returns the SVG prepared by the backend, empty if it could not be loaded
+    wxMemoryBuffer LoadFile(const Backend& backend, Mode mode, const wxString& fileName) const;
+
+    // benchmarks the data loaded by LoadFile() for one bitmap size,
+    // the parameters are like those of BenchmarkFile()
+    bool BenchmarkSize(const Backend& backend, Mode mode,
+                       const wxString& fileName, const wxMemoryBuffer& buf,
+                       const wxSize& bitmapSize, size_t runCount, VectorTimes& times,
+                       VectorPhases* phases, Allocs* allocs);
+
+    // runs the next batch of BenchmarkSize(), the times and phases must
+    // already have runCount elements; batches.done is set after the last one
+    bool BenchmarkSizeBatch(const Backend& backend, Mode mode,
+                            const wxString& fileName, const wxMemoryBuffer& buf,
+                            const wxSize& bitmapSize, size_t runCount, SizeBatches& batches,
+                            VectorTimes& times, VectorPhases* phases, Allocs* allocs);
+
+    // creates bitmapSize bitmap iterationCount times (or parses, lays out
+    // or renders the document in LunaSVG only modes) and returns the time
+    // in nanoseconds, excluding the time of destroying the bitmaps and
+    // the bundles, except those created in Mode_Full
+    bool TimeBatch(const Backend& backend, Mode mode, const wxMemoryBuffer& buf,
+                   const wxSize& bitmapSize, size_t iterationCount, wxLongLong_t& time);
+
+    static bool TimeLunaSVGBatch(Mode mode, const wxMemoryBuffer& buf,
+                                 const wxSize& bitmapSize, size_t iterationCount, wxLongLong_t& time);
+
+    // writes a line for each size to the results file of RunStreaming(),
+    // stats are null for the backends not benchmarked in the mode, phasesLuna
+    // and allocsLuna are null in the modes where they are not collected
+    void WriteStreamingResults(wxFFile& file, const wxString& fileName, Mode mode,
+                               const std::vector<const VectorStats*>& stats,
+                               const VectorPhases* phasesLuna, const VectorAllocs* allocsLuna);
+
+    void CreateStreamingReport(const BackendTotals& totals,
+                               const VectorPhases& phaseSumsLuna, const VectorAllocs& allocTotalsLuna,
+                               size_t runCount, size_t benchmarkedCount, const wxArrayString& failedFileNames,
+                               const wxString& resultsFileName, wxString& reportText);
+
+    wxTestSVGBenchmarkHistory::Run CreateHistoryRun(const VectorModeResults& results, size_t runCount) const;
+
+    // phasesLuna are medians for each file and size, they and allocsLuna
+    // are empty when the phases are not collected; history are the runs of the benchmarked
+    // folder ending with this one, empty without history
+    void CreateReport(const VectorModeResults& results,
+                      const MatrixPhases2& phasesLuna, const MatrixAllocs& allocsLuna,
+                      size_t runCount, const std::vector<wxTestSVGBenchmarkHistory::Run>& history,
+                      wxString& reportText);
 
-    void CreateReport(const MatrixStats& statsNano, const MatrixStats& statsD2D,
-                      size_t runCount, wxString& reportText);
+    // adds the HTML with the trend charts of the sums of medians for each
+    // mode and size and of the medians of each file to result
+    void CreateTrendReport(const VectorModeResults& results,
+                           const std::vector<wxTestSVGBenchmarkHistory::Run>& history,
+                           wxArrayString& result);
 
-    void CreateDetailedReport(const MatrixLong3& timesNano, const MatrixStats& statsNano,
-                              const MatrixLong3& timesLuna, const MatrixStats& statsLuna,
+    void CreateDetailedReport(const VectorModeResults& results, size_t runCount,
                               bool asHTML, wxString& reportText);
 
-    static Stats CalcStatsForVectorLong(const VectorLong& data);
+    static Stats CalcStats(const VectorTimes& data);
+
+    // returns the percentile (0-100) of sorted data, interpolated between
+    // the closest ranks
+    static double CalcPercentile(const VectorTimes& sortedData, double percentile);
+
+    // returns the median of each phase
+    static wxLunaSVGPhaseTimes CalcPhaseMedians(const VectorPhases& data);
 };
 
 
@@ -92,4 +357,51 @@ private:
     static bool WriteHTMLReport(const wxString& fileName, const wxString& reportText);
 };
 
+
+// ============================================================================
+// wxTestSVGBenchmarkProgressFrame
+// ============================================================================
+
+class wxListCtrl;
+
+/*
+    Runs the benchmark in steps when the application is idle, so that the GUI
+    stays responsive and the benchmark can be stopped at any time, and shows
+    the medians of each file as soon as it is benchmarked. When the benchmark
+    is finished or stopped, the report of the benchmarked files is shown.
+
+    The steps run in the main thread, because wxBitmap can be created only
+    there on some platforms.
+*/
+class wxTestSVGBenchmarkProgressFrame: public wxFrame
+{
+public:
+    // benchmark must be set up
+    wxTestSVGBenchmarkProgressFrame(wxWindow* parent, const wxTestSVGRasterizationBenchmark& benchmark,
+                                    size_t runCount);
+
+    bool IsRunning() const { return m_running; }
+private:
+    wxTestSVGRasterizationBenchmark m_benchmark;
+    bool                            m_running{false};
+    size_t                          m_shownFileCount{0};
+    wxStopWatch                     m_stopWatch;
+
+    wxStaticText* m_statusText;
+    wxGauge*      m_gauge;
+    wxListCtrl*   m_resultsList;
+    wxButton*     m_stopButton;
+
+    void OnIdle(wxIdleEvent& event);
+    void OnStop(wxCommandEvent&);
+    void OnClose(wxCloseEvent& event);
+
+    // adds the files benchmarked since the last call to the list
+    void UpdateResultsList();
+    void UpdateStatus();
+
+    // creates the report of the files benchmarked so far
+    void Finish(const wxString& status);
+};
+
 #endif // #ifndef TEST_SVG_BENCH_H_DEFINED
\ No newline at end of file
@@ -0,0 +1,1698 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgbenchcli.cpp
+// Purpose:     Headless benchmark of SVG rasterization with LunaSVG
+// Author:      PB
+// Created:     2024-01-18
+// Copyright:   (c) 2024 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+    Console counterpart of wxTestSVGRasterizationBenchmark, which does not
+    need wxWidgets and writes the results as JSON and/or CSV, so that it can
+    be run on headless machines and its results processed by scripts.
+
+    Every SVG file is rasterized at every size runs times, the same as
+    wxBitmapBundleImplLunaSVG does it (parse, render, convert the pixels
+    to straight RGBA). Unless --render-only is used, the time includes also
+    parsing the SVG, the same as the full mode of the GUI benchmark.
+    The memory allocated by LunaSVG in the last run is reported as well.
+
+    With --perf, every file is additionally rasterized runs times with the
+    hardware performance counters read around each phase (parse, layout,
+    render, convert); these runs are not timed, so that reading the counters
+    does not affect the times. The averages per run are reported, together
+    with instructions per cycle and the cache and branch misses per pixel
+    of the render and convert phases. When the counters are not available
+    (not Linux, a virtual machine, perf_event_paranoid...), a warning is
+    shown and the benchmark runs without them.
+
+    With --features, every file is additionally loaded and rasterized runs
+    times with the time attributed to the SVG features such as gradient
+    fills, dashed strokes, clip paths, masks or CSS styling, using the
+    LunaSVG render trace hooks. The average time of each feature per run is
+    reported for every file and size, and the features are ranked by their
+    total time in all the files, so that the most costly ones come first.
+    These runs are not timed and the attributed times include the overhead
+    of the hooks.
+
+    With --trace, every file is additionally rasterized once at every size
+    with the LunaSVG render trace hooks enabled, and the rendering of each
+    element, its group, clipping, masking, filling and stroking is written
+    to a file in Chrome trace event format, which can be opened in Perfetto
+    (https://ui.perfetto.dev) or chrome://tracing. These runs are not timed
+    either, as the hooks make the rendering slower.
+
+    With --threads, the latency of individual files is not measured; instead
+    the whole file x size x run matrix is rasterized by 1 to count threads
+    taking the work items from a shared queue, and the throughput (icons
+    per second) and the scaling efficiency for each thread count are reported.
+    This exposes contention in the state shared between threads, such as
+    the allocator or static tables in LunaSVG.
+
+    The times of a run can be saved as a baseline with --save-baseline and
+    a later run compared to it with --baseline. For every file and size,
+    the times are compared with Mann-Whitney U test and the change of the
+    median is considered a regression or an improvement when it is both
+    statistically significant and larger than the threshold. When there are
+    more regressions than allowed, the exit status is 2.
+*/
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <lunasvg.h>
+
+#include "allocstats.h"
+#include "clicommon.h"
+#include "featurecosts.h"
+#include "perfcounters.h"
+
+namespace fs = std::filesystem;
+
+// ============================================================================
+// command line options
+// ============================================================================
+
+struct Options
+{
+    fs::path          dir{"SVGs"};
+    bool              recursive{false};
+    std::vector<Size> sizes{ {16, 16}, {24, 24}, {32, 32}, {48, 48}, {64, 64}, {128, 128} };
+    size_t            runCount{10};
+    bool              renderOnly{false};
+    std::string       jsonPath; // "-" means stdout
+    std::string       csvPath;  // ditto
+    size_t            maxThreadCount{0}; // 0 means latency instead of throughput
+    std::string       saveBaselinePath;
+    std::string       baselinePath;
+    std::string       comparisonPath; // "-" means stdout
+    double            alpha{0.01};
+    double            threshold{5}; // percent
+    size_t            maxRegressions{0};
+    bool              perf{false};
+    bool              features{false};
+    std::string       tracePath;
+    bool              showHelp{false};
+};
+
+// exit status when the comparison with baseline found too many regressions
+const int ExitRegressions = 2;
+
+static void PrintUsage(const char* programName)
+{
+    std::cerr
+        << "Usage: " << programName << " [options]\n"
+        << "  --dir <folder>        folder with SVG files (default: SVGs)\n"
+        << "  --recursive           include SVG files from subfolders\n"
+        << "  --sizes <list>        comma separated sizes, e.g. 16,24,32x16 (default: 16,24,32,48,64,128)\n"
+        << "  --runs <count>        number of runs for each file and size (default: 10)\n"
+        << "  --render-only         do not include parsing the SVG in the times\n"
+        << "  --json <file>         write results as JSON, '-' for standard output\n"
+        << "  --csv <file>          write results as CSV, '-' for standard output\n"
+        << "  --threads <count>     measure throughput with 1 to count threads instead of latency,\n"
+        << "                        0 for the number of CPU cores\n"
+        << "  --save-baseline <file> save the times as a baseline for later comparison\n"
+        << "  --baseline <file>     compare the times with a baseline saved before\n"
+        << "  --comparison <file>   write the comparison with baseline as CSV, '-' for standard output\n"
+        << "  --alpha <value>       significance level of the comparison (default: 0.01)\n"
+        << "  --threshold <percent> minimum change of median considered a regression or\n"
+        << "                        an improvement (default: 5)\n"
+        << "  --max-regressions <count> maximum number of regressions before the exit\n"
+        << "                        status is 2 (default: 0)\n"
+        << "  --perf                collect hardware performance counters for each phase (Linux only)\n"
+        << "  --features            attribute the time to SVG features and rank them\n"
+        << "  --trace <file>        write the rendering of each element as Chrome trace JSON\n"
+        << "  --help                show this help\n";
+}
+
+static bool ParseCommandLine(int argc, char** argv, Options& options)
+{
+    for ( int i = 1; i < argc; ++i )
+    {
+        const std::string arg = argv[i];
+        const bool        hasValue = i + 1 < argc;
+
+        if ( arg == "--help" || arg == "-h" )
+        {
+            options.showHelp = true;
+            return true;
+        }
+        else if ( arg == "--dir" && hasValue )
+            options.dir = argv[++i];
+        else if ( arg == "--recursive" )
+            options.recursive = true;
+        else if ( arg == "--sizes" && hasValue )
+        {
+            if ( !ParseSizes(argv[++i], options.sizes) )
+            {
+                std::cerr << "Invalid sizes '" << argv[i] << "'.\n";
+                return false;
+            }
+        }
+        else if ( arg == "--runs" && hasValue )
+        {
+            options.runCount = std::strtoul(argv[++i], nullptr, 10);
+            if ( options.runCount == 0 )
+            {
+                std::cerr << "Invalid run count '" << argv[i] << "'.\n";
+                return false;
+            }
+        }
+        else if ( arg == "--render-only" )
+            options.renderOnly = true;
+        else if ( arg == "--json" && hasValue )
+            options.jsonPath = argv[++i];
+        else if ( arg == "--csv" && hasValue )
+            options.csvPath = argv[++i];
+        else if ( arg == "--threads" && hasValue )
+        {
+            char* end = nullptr;
+
+            options.maxThreadCount = std::strtoul(argv[++i], &end, 10);
+            if ( end == argv[i] || *end != '\0' )
+            {
+                std::cerr << "Invalid thread count '" << argv[i] << "'.\n";
+                return false;
+            }
+            if ( options.maxThreadCount == 0 )
+                options.maxThreadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+        else if ( arg == "--save-baseline" && hasValue )
+            options.saveBaselinePath = argv[++i];
+        else if ( arg == "--baseline" && hasValue )
+            options.baselinePath = argv[++i];
+        else if ( arg == "--comparison" && hasValue )
+            options.comparisonPath = argv[++i];
+        else if ( (arg == "--alpha" || arg == "--threshold") && hasValue )
+        {
+            char*        end = nullptr;
+            const double value = std::strtod(argv[++i], &end);
+
+            if ( end == argv[i] || *end != '\0' || value < 0 || (arg == "--alpha" && value > 1) )
+            {
+                std::cerr << "Invalid value '" << argv[i] << "' for option '" << arg << "'.\n";
+                return false;
+            }
+            (arg == "--alpha" ? options.alpha : options.threshold) = value;
+        }
+        else if ( arg == "--perf" )
+            options.perf = true;
+        else if ( arg == "--features" )
+            options.features = true;
+        else if ( arg == "--trace" && hasValue )
+            options.tracePath = argv[++i];
+        else if ( arg == "--max-regressions" && hasValue )
+        {
+            char* end = nullptr;
+
+            options.maxRegressions = std::strtoul(argv[++i], &end, 10);
+            if ( end == argv[i] || *end != '\0' )
+            {
+                std::cerr << "Invalid regression count '" << argv[i] << "'.\n";
+                return false;
+            }
+        }
+        else
+        {
+            std::cerr << "Unknown or incomplete option '" << arg << "'.\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// ============================================================================
+// benchmark
+// ============================================================================
+
+// times in nanoseconds for one file and one bitmap size
+using VectorTimes = std::vector<std::int64_t>;
+
+struct Stats
+{
+    std::int64_t min{0};
+    std::int64_t max{0};
+    std::int64_t mdn{0};
+    std::int64_t avg{0};
+};
+
+enum Phase
+{
+    Phase_Parse,
+    Phase_Layout,
+    Phase_Render,
+    Phase_Convert,
+
+    Phase_Count
+};
+
+const char* const PhaseNames[Phase_Count] = { "parse", "layout", "render", "convert" };
+
+// hardware counters for each phase, averaged over the runs
+using PhaseCounts = std::array<PerfCounts, Phase_Count>;
+
+struct FileResult
+{
+    std::string              name; // relative to the benchmarked folder
+    std::vector<VectorTimes> times; // for each size
+    std::vector<Stats>       stats; // ditto
+    std::vector<AllocStats>  allocs; // ditto, for the last run
+    std::vector<PhaseCounts> counts; // ditto, empty without --perf
+    std::vector<FeatureTimes> features; // ditto, averaged over the runs, empty without --features
+};
+
+static Stats CalcStats(VectorTimes times)
+{
+    Stats stats;
+
+    if ( times.empty() )
+        return stats;
+
+    std::sort(times.begin(), times.end());
+
+    const size_t count = times.size();
+
+    stats.min = times.front();
+    stats.max = times.back();
+    stats.mdn = count % 2 ? times[count / 2] : (times[count / 2 - 1] + times[count / 2]) / 2;
+    stats.avg = std::accumulate(times.begin(), times.end(), std::int64_t(0)) / static_cast<std::int64_t>(count);
+
+    return stats;
+}
+
+// returns the counts of the phases which depend on the bitmap size divided by its pixel count
+static double CalcPerPixel(const PhaseCounts& counts, PerfEvent event, const Size& size)
+{
+    const double pixelCount = static_cast<double>(size.width) * size.height;
+
+    return (counts[Phase_Render].values[event] + counts[Phase_Convert].values[event]) / pixelCount;
+}
+
+// rasterizes the data the same as Rasterize() but reads the counters around each phase
+static bool CountPhases(const Options& options, const std::string& data, const Size& size,
+                        const PerfCounters& counters, PhaseCounts& counts)
+{
+    PhaseCounts sums;
+    PerfCounts  previous;
+
+    // every phase accumulates the counts since the previous one ended
+    const auto endPhase = [&](Phase phase, bool first)
+    {
+        const PerfCounts current = counters.Read();
+        const PerfCounts delta = current - previous;
+
+        if ( first )
+            sums[phase] = delta;
+        else
+            sums[phase] += delta;
+        previous = counters.Read();
+    };
+
+    for ( size_t run = 0; run < options.runCount; ++run )
+    {
+        const bool first = run == 0;
+
+        previous = counters.Read();
+
+        std::unique_ptr<lunasvg::Document> document = lunasvg::Document::parseFromData(data.data(), data.size());
+
+        endPhase(Phase_Parse, first);
+        if ( !document )
+            return false;
+
+        document->updateLayout();
+        endPhase(Phase_Layout, first);
+
+        lunasvg::Bitmap bitmap(size.width, size.height);
+
+        if ( !bitmap.valid() )
+            return false;
+
+        const double scale = std::min(size.width / document->width(), size.height / document->height());
+
+        bitmap.clear(0);
+        document->render(bitmap, lunasvg::Matrix::scaled(scale, scale));
+        endPhase(Phase_Render, first);
+
+        bitmap.convertToRGBA();
+        endPhase(Phase_Convert, first);
+    }
+
+    for ( size_t phase = 0; phase < Phase_Count; ++phase )
+    {
+        for ( auto& value : sums[phase].values )
+            value /= options.runCount;
+    }
+
+    counts = sums;
+    return true;
+}
+
+// loads and rasterizes the data runs times at every size while attributing the time to the features
+static bool MeasureFeatures(const Options& options, const std::string& data, FeatureCostRecorder& recorder,
+                            std::vector<FeatureTimes>& features)
+{
+    features.assign(options.sizes.size(), FeatureTimes());
+
+    for ( size_t s = 0; s < options.sizes.size(); ++s )
+    {
+        recorder.Reset();
+        for ( size_t run = 0; run < options.runCount; ++run )
+        {
+            recorder.Start();
+
+            std::unique_ptr<lunasvg::Document> document = lunasvg::Document::loadFromData(data);
+            const bool                         rasterized = document && Rasterize(*document, options.sizes[s]).valid();
+
+            recorder.Stop();
+            if ( !rasterized )
+                return false;
+        }
+
+        for ( size_t f = 0; f < Feature_Count; ++f )
+            features[s][f] = recorder.GetTimes()[f] / static_cast<std::int64_t>(options.runCount);
+    }
+
+    return true;
+}
+
+// ============================================================================
+// render trace
+// ============================================================================
+
+struct TraceEvent
+{
+    std::string  name;
+    std::string  category;
+    std::string  tag; // empty for the events of the file itself
+    std::string  id;
+    bool         begin{true};
+    std::int64_t time{0}; // nanoseconds since the recorder was created
+};
+
+// collects the events reported by LunaSVG between Start() and Stop(),
+// the trace function is set only then so that the timed runs are not affected
+class TraceRecorder
+{
+public:
+    TraceRecorder() : m_start(Clock::now()) {}
+    ~TraceRecorder() { Stop(); }
+
+    // returns false if LunaSVG was built without the trace hooks
+    bool Start() { return lunasvg::setRenderTraceFunction(OnRenderTrace, this); }
+    void Stop() { lunasvg::setRenderTraceFunction(nullptr); }
+
+    void Add(const std::string& name, const std::string& category, bool begin)
+    {
+        m_events.push_back({name, category, std::string(), std::string(), begin, GetTime()});
+    }
+
+    const std::vector<TraceEvent>& GetEvents() const { return m_events; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point       m_start;
+    std::vector<TraceEvent> m_events;
+
+    std::int64_t GetTime() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_start).count();
+    }
+
+    static void OnRenderTrace(const lunasvg::RenderTraceEvent& event, void* userData)
+    {
+        TraceRecorder* recorder = static_cast<TraceRecorder*>(userData);
+        std::string    name = event.name;
+
+        // e.g. "fill path#arrow", Perfetto shows only the name in the timeline
+        if ( *event.tag )
+        {
+            name += ' ';
+            name += event.tag;
+        }
+        if ( *event.id )
+        {
+            name += '#';
+            name += event.id;
+        }
+
+        recorder->m_events.push_back({name, event.name, event.tag, event.id, event.begin, recorder->GetTime()});
+    }
+};
+
+// rasterizes the already loaded document once at every size while recording the trace
+static bool TraceFile(const Options& options, const std::string& name, const lunasvg::Document& document,
+                      TraceRecorder& recorder)
+{
+    for ( const Size& size : options.sizes )
+    {
+        const std::string label = name + " " + std::to_string(size.width) + "x" + std::to_string(size.height);
+
+        recorder.Add(label, "file", true);
+        recorder.Start();
+        const bool rasterized = Rasterize(document, size).valid();
+        recorder.Stop();
+        recorder.Add(label, "file", false);
+
+        if ( !rasterized )
+            return false;
+    }
+
+    return true;
+}
+
+// counters is nullptr if the hardware counters are not collected,
+// featureRecorder is nullptr if the features are not measured,
+// recorder is nullptr if the render trace is not recorded
+static bool BenchmarkFile(const Options& options, const fs::path& path, const std::string& name,
+                          const PerfCounters* counters, FeatureCostRecorder* featureRecorder,
+                          TraceRecorder* recorder, FileResult& result)
+{
+    using Clock = std::chrono::steady_clock;
+
+    std::string data;
+
+    if ( !LoadFile(path, data) )
+    {
+        std::cerr << "Couldn't load file '" << path.string() << "'.\n";
+        return false;
+    }
+
+    std::unique_ptr<lunasvg::Document> document;
+
+    if ( options.renderOnly )
+    {
+        document = lunasvg::Document::loadFromData(data);
+        if ( !document )
+        {
+            std::cerr << "Couldn't parse file '" << path.string() << "'.\n";
+            return false;
+        }
+    }
+
+    result.times.assign(options.sizes.size(), VectorTimes(options.runCount));
+    result.allocs.assign(options.sizes.size(), AllocStats());
+
+    AllocStatsCollector allocCollector;
+
+    for ( size_t run = 0; run < options.runCount; ++run )
+    {
+        for ( size_t s = 0; s < options.sizes.size(); ++s )
+        {
+            const Size& size = options.sizes[s];
+            allocCollector.Reset();
+
+            const auto  start = Clock::now();
+
+            if ( !options.renderOnly )
+                document = lunasvg::Document::loadFromData(data);
+
+            if ( !document || !Rasterize(*document, size).valid() )
+            {
+                std::cerr << "Couldn't rasterize file '" << path.string() << "' at size "
+                          << size.width << "x" << size.height << ".\n";
+                return false;
+            }
+
+            result.times[s][run] = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+
+            // the first run may include allocating caches and such
+            if ( run == options.runCount - 1 )
+                result.allocs[s] = allocCollector.GetStats();
+        }
+    }
+
+    for ( const auto& t : result.times )
+        result.stats.push_back(CalcStats(t));
+
+    if ( counters )
+    {
+        result.counts.resize(options.sizes.size());
+        for ( size_t s = 0; s < options.sizes.size(); ++s )
+        {
+            if ( !CountPhases(options, data, options.sizes[s], *counters, result.counts[s]) )
+            {
+                std::cerr << "Couldn't count events for file '" << path.string() << "'.\n";
+                return false;
+            }
+        }
+    }
+
+    if ( featureRecorder && !MeasureFeatures(options, data, *featureRecorder, result.features) )
+    {
+        std::cerr << "Couldn't measure features of file '" << path.string() << "'.\n";
+        return false;
+    }
+
+    if ( recorder && !TraceFile(options, name, *document, *recorder) )
+    {
+        std::cerr << "Couldn't trace file '" << path.string() << "'.\n";
+        return false;
+    }
+
+    return true;
+}
+
+// ============================================================================
+// throughput
+// ============================================================================
+
+struct ThroughputResult
+{
+    size_t       threadCount{0};
+    size_t       iconCount{0};
+    std::int64_t wallTime{0}; // nanoseconds
+    double       iconsPerSecond{0};
+    double       speedup{0};    // relative to one thread
+    double       efficiency{0}; // speedup / threadCount
+};
+
+// loads the files and checks that they can be parsed, skipping those that cannot
+static void LoadFilesForThroughput(const Options& options, const std::vector<fs::path>& files,
+                                   std::vector<std::string>& names, std::vector<std::string>& data)
+{
+    for ( const auto& path : files )
+    {
+        const std::string name = path.lexically_relative(options.dir).generic_string();
+        std::string       fileData;
+
+        if ( !LoadFile(path, fileData) || !lunasvg::Document::loadFromData(fileData) )
+        {
+            std::cerr << "Couldn't load or parse file '" << path.string() << "'.\n";
+            std::cerr << "Skipping file '" << name << "'.\n";
+            continue;
+        }
+
+        names.push_back(name);
+        data.push_back(std::move(fileData));
+    }
+}
+
+/*
+    Rasterizes every file at every size runCount times with threadCount threads.
+
+    The work items are taken from a shared atomic counter so that all threads
+    stay busy until the very end. Only the time from releasing the threads
+    to the last of them finishing is measured. In render-only mode, every
+    thread parses its own copy of the documents before that, so that
+    no document is shared.
+*/
+static bool MeasureThroughput(const Options& options, const std::vector<std::string>& data,
+                              size_t threadCount, ThroughputResult& result)
+{
+    using Clock = std::chrono::steady_clock;
+
+    const size_t fileCount = data.size();
+    const size_t sizeCount = options.sizes.size();
+    const size_t itemCount = fileCount * sizeCount * options.runCount;
+
+    std::atomic<size_t> nextItem{0};
+    std::atomic<size_t> readyCount{0};
+    std::atomic<bool>   start{false};
+    std::atomic<bool>   failed{false};
+
+    const auto worker = [&]()
+    {
+        std::vector<std::unique_ptr<lunasvg::Document>> documents;
+
+        if ( options.renderOnly )
+        {
+            for ( const auto& fileData : data )
+                documents.push_back(lunasvg::Document::loadFromData(fileData));
+        }
+
+        ++readyCount;
+        while ( !start.load(std::memory_order_acquire) )
+            std::this_thread::yield();
+
+        for ( ;; )
+        {
+            const size_t item = nextItem.fetch_add(1, std::memory_order_relaxed);
+
+            if ( item >= itemCount )
+                break;
+
+            const size_t file = item % fileCount;
+            const Size&  size = options.sizes[(item / fileCount) % sizeCount];
+
+            std::unique_ptr<lunasvg::Document> parsed;
+            const lunasvg::Document*           document = nullptr;
+
+            if ( options.renderOnly )
+                document = documents[file].get();
+            else
+                document = (parsed = lunasvg::Document::loadFromData(data[file])).get();
+
+            if ( !document || !Rasterize(*document, size).valid() )
+                failed = true;
+        }
+    };
+
+    std::vector<std::thread> threads;
+
+    threads.reserve(threadCount);
+    for ( size_t i = 0; i < threadCount; ++i )
+        threads.emplace_back(worker);
+
+    while ( readyCount < threadCount )
+        std::this_thread::yield();
+
+    const auto startTime = Clock::now();
+
+    start.store(true, std::memory_order_release);
+    for ( auto& thread : threads )
+        thread.join();
+
+    const auto wallTime = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - startTime).count();
+
+    if ( failed )
+    {
+        std::cerr << "Couldn't rasterize some files with " << threadCount << " threads.\n";
+        return false;
+    }
+
+    result.threadCount = threadCount;
+    result.iconCount = itemCount;
+    result.wallTime = std::max(wallTime, std::int64_t(1));
+    result.iconsPerSecond = itemCount * 1e9 / result.wallTime;
+
+    return true;
+}
+
+static bool RunThroughput(const Options& options, const std::vector<std::string>& data,
+                          std::vector<ThroughputResult>& results)
+{
+    for ( size_t threadCount = 1; threadCount <= options.maxThreadCount; ++threadCount )
+    {
+        ThroughputResult result;
+
+        std::cerr << "Measuring throughput with " << threadCount << " threads...\n";
+        if ( !MeasureThroughput(options, data, threadCount, result) )
+            return false;
+
+        result.speedup = result.iconsPerSecond / (results.empty() ? result.iconsPerSecond : results.front().iconsPerSecond);
+        result.efficiency = result.speedup / threadCount;
+        results.push_back(result);
+    }
+
+    return true;
+}
+
+// ============================================================================
+// baseline
+// ============================================================================
+
+/*
+    Baseline is a text file, its first line is BaselineSignature, the second
+    one "mode full" or "mode render" and then there is a line for every file
+    and size: name, width and height separated by tabs, followed by a tab
+    and the times in nanoseconds separated by spaces.
+*/
+
+const char* const BaselineSignature = "svgbenchcli baseline 1";
+
+using BaselineKey = std::tuple<std::string, std::uint32_t, std::uint32_t>;
+
+struct Baseline
+{
+    std::string                        mode;
+    std::map<BaselineKey, VectorTimes> times;
+};
+
+static const char* GetModeName(const Options& options)
+{
+    return options.renderOnly ? "render" : "full";
+}
+
+static void WriteBaseline(std::ostream& out, const Options& options, const std::vector<FileResult>& results)
+{
+    out << BaselineSignature << "\n";
+    out << "mode " << GetModeName(options) << "\n";
+
+    for ( const auto& result : results )
+    {
+        for ( size_t s = 0; s < options.sizes.size(); ++s )
+        {
+            out << result.name << "\t" << options.sizes[s].width << "\t" << options.sizes[s].height << "\t";
+            for ( size_t run = 0; run < result.times[s].size(); ++run )
+                out << (run ? " " : "") << result.times[s][run];
+            out << "\n";
+        }
+    }
+}
+
+static bool LoadBaseline(const std::string& path, Baseline& baseline)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::string   line;
+
+    if ( !file )
+    {
+        std::cerr << "Couldn't open baseline file '" << path << "'.\n";
+        return false;
+    }
+
+    if ( !std::getline(file, line) || line != BaselineSignature
+         || !std::getline(file, line) || line.compare(0, 5, "mode ") != 0 )
+    {
+        std::cerr << "File '" << path << "' is not a valid baseline.\n";
+        return false;
+    }
+    baseline.mode = line.substr(5);
+
+    for ( size_t lineNo = 3; std::getline(file, line); ++lineNo )
+    {
+        if ( line.empty() )
+            continue;
+
+        // the name may contain tabs, but not the rest
+        const size_t timesPos = line.rfind('\t');
+        const size_t heightPos = timesPos != std::string::npos && timesPos > 0 ? line.rfind('\t', timesPos - 1) : std::string::npos;
+        const size_t widthPos = heightPos != std::string::npos && heightPos > 0 ? line.rfind('\t', heightPos - 1) : std::string::npos;
+
+        std::istringstream times(widthPos != std::string::npos ? line.substr(timesPos + 1) : std::string());
+        VectorTimes        values;
+        std::int64_t       value = 0;
+
+        while ( times >> value )
+            values.push_back(value);
+
+        if ( widthPos == std::string::npos || values.empty() || !times.eof() )
+        {
+            std::cerr << "Invalid line " << lineNo << " in baseline file '" << path << "'.\n";
+            return false;
+        }
+
+        const BaselineKey key(line.substr(0, widthPos),
+                              static_cast<std::uint32_t>(std::strtoul(line.c_str() + widthPos + 1, nullptr, 10)),
+                              static_cast<std::uint32_t>(std::strtoul(line.c_str() + heightPos + 1, nullptr, 10)));
+
+        baseline.times[key] = std::move(values);
+    }
+
+    return true;
+}
+
+// two-sided p-value of Mann-Whitney U test, using normal approximation
+// with tie and continuity corrections
+static double CalcMannWhitneyPValue(const VectorTimes& a, const VectorTimes& b)
+{
+    const double n1 = static_cast<double>(a.size());
+    const double n2 = static_cast<double>(b.size());
+    const double n = n1 + n2;
+
+    if ( a.empty() || b.empty() )
+        return 1;
+
+    // values with the sample they come from
+    std::vector<std::pair<std::int64_t, bool>> values;
+
+    values.reserve(a.size() + b.size());
+    for ( const auto v : a )
+        values.emplace_back(v, true);
+    for ( const auto v : b )
+        values.emplace_back(v, false);
+    std::sort(values.begin(), values.end());
+
+    double rankSumA = 0;
+    double tieSum = 0;
+
+    for ( size_t i = 0; i < values.size(); )
+    {
+        size_t j = i;
+
+        while ( j < values.size() && values[j].first == values[i].first )
+            ++j;
+
+        // tied values get the average of their ranks, which are 1-based
+        const double tieCount = static_cast<double>(j - i);
+        const double rank = (i + 1 + j) / 2.0;
+
+        for ( size_t k = i; k < j; ++k )
+        {
+            if ( values[k].second )
+                rankSumA += rank;
+        }
+        tieSum += tieCount * tieCount * tieCount - tieCount;
+        i = j;
+    }
+
+    const double u = rankSumA - n1 * (n1 + 1) / 2;
+    const double mean = n1 * n2 / 2;
+    const double variance = n1 * n2 / 12 * ((n + 1) - tieSum / (n * (n - 1)));
+
+    if ( variance <= 0 )
+        return 1;
+
+    const double z = std::max(std::fabs(u - mean) - 0.5, 0.0) / std::sqrt(variance);
+
+    return std::erfc(z / std::sqrt(2.0));
+}
+
+enum class Verdict
+{
+    Unchanged,
+    Improvement,
+    Regression
+};
+
+struct Comparison
+{
+    std::string  name;
+    Size         size;
+    std::int64_t baselineMedian{0};
+    std::int64_t currentMedian{0};
+    double       change{0}; // percent
+    double       pValue{1};
+    Verdict      verdict{Verdict::Unchanged};
+};
+
+static const char* GetVerdictName(Verdict verdict)
+{
+    switch ( verdict )
+    {
+        case Verdict::Improvement: return "improvement";
+        case Verdict::Regression:  return "regression";
+        default:                   return "unchanged";
+    }
+}
+
+// results not in the baseline are not compared but counted in notInBaselineCount
+static std::vector<Comparison> CompareWithBaseline(const Options& options, const Baseline& baseline,
+                                                   const std::vector<FileResult>& results,
+                                                   size_t& notInBaselineCount)
+{
+    std::vector<Comparison> comparisons;
+
+    notInBaselineCount = 0;
+    for ( const auto& result : results )
+    {
+        for ( size_t s = 0; s < options.sizes.size(); ++s )
+        {
+            const Size& size = options.sizes[s];
+            const auto  it = baseline.times.find(BaselineKey(result.name, size.width, size.height));
+
+            if ( it == baseline.times.end() )
+            {
+                ++notInBaselineCount;
+                continue;
+            }
+
+            Comparison comparison;
+
+            comparison.name = result.name;
+            comparison.size = size;
+            comparison.baselineMedian = CalcStats(it->second).mdn;
+            comparison.currentMedian = result.stats[s].mdn;
+            if ( comparison.baselineMedian > 0 )
+            {
+                comparison.change = 100.0 * (comparison.currentMedian - comparison.baselineMedian)
+                                    / comparison.baselineMedian;
+            }
+            comparison.pValue = CalcMannWhitneyPValue(it->second, result.times[s]);
+
+            if ( comparison.pValue < options.alpha && std::fabs(comparison.change) > options.threshold )
+                comparison.verdict = comparison.change > 0 ? Verdict::Regression : Verdict::Improvement;
+
+            comparisons.push_back(std::move(comparison));
+        }
+    }
+
+    return comparisons;
+}
+
+static size_t CountVerdicts(const std::vector<Comparison>& comparisons, Verdict verdict)
+{
+    return std::count_if(comparisons.begin(), comparisons.end(),
+                         [verdict](const Comparison& c) { return c.verdict == verdict; });
+}
+
+// ============================================================================
+// output
+// ============================================================================
+
+static std::string EscapeJSON(const std::string& text)
+{
+    std::string escaped;
+
+    for ( const char c : text )
+    {
+        switch ( c )
+        {
+            case '"':  escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n";  break;
+            case '\r': escaped += "\\r";  break;
+            case '\t': escaped += "\\t";  break;
+            default:
+                if ( static_cast<unsigned char>(c) < 0x20 )
+                {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+                    escaped += buf;
+                }
+                else
+                {
+                    escaped += c;
+                }
+        }
+    }
+
+    return escaped;
+}
+
+static std::string EscapeCSV(const std::string& text)
+{
+    if ( text.find_first_of(",\"\n\r") == std::string::npos )
+        return text;
+
+    std::string escaped = "\"";
+
+    for ( const char c : text )
+    {
+        if ( c == '"' )
+            escaped += '"';
+        escaped += c;
+    }
+
+    return escaped + "\"";
+}
+
+// writes the opening brace and the members common to both modes
+static void WriteJSONHeader(std::ostream& out, const Options& options)
+{
+    out << "{\n";
+    out << "  \"lunasvgVersion\": \"" << LUNASVG_VERSION_MAJOR << "." << LUNASVG_VERSION_MINOR
+        << "." << LUNASVG_VERSION_MICRO << "\",\n";
+    out << "  \"dir\": \"" << EscapeJSON(options.dir.generic_string()) << "\",\n";
+    out << "  \"mode\": \"" << (options.renderOnly ? "render" : "full") << "\",\n";
+    out << "  \"runs\": " << options.runCount << ",\n";
+    out << "  \"unit\": \"ns\",\n";
+    out << "  \"memoryUnit\": \"bytes\",\n";
+
+    out << "  \"sizes\": [";
+    for ( size_t s = 0; s < options.sizes.size(); ++s )
+    {
+        out << (s ? ", " : "") << "{\"width\": " << options.sizes[s].width
+            << ", \"height\": " << options.sizes[s].height << "}";
+    }
+    out << "],\n";
+}
+
+// converts the camel case name of the event or feature to the snake case used by the CSV columns
+static std::string GetCSVName(const char* camelCaseName)
+{
+    std::string name;
+
+    for ( const char* c = camelCaseName; *c; ++c )
+    {
+        if ( std::isupper(static_cast<unsigned char>(*c)) )
+            name += '_';
+        name += static_cast<char>(std::tolower(static_cast<unsigned char>(*c)));
+    }
+
+    return name;
+}
+
+// writes the counters member, the unavailable events are null
+static void WriteCountsJSON(std::ostream& out, const PhaseCounts& counts, const Size& size)
+{
+    out << ", \"counters\": {";
+    for ( size_t phase = 0; phase < Phase_Count; ++phase )
+    {
+        const PerfCounts& phaseCounts = counts[phase];
+
+        out << (phase ? ", " : "") << "\"" << PhaseNames[phase] << "\": {";
+        for ( size_t e = 0; e < PerfEvent_Count; ++e )
+        {
+            out << (e ? ", " : "") << "\"" << GetPerfEventName(static_cast<PerfEvent>(e)) << "\": ";
+            if ( phaseCounts.available[e] )
+                out << phaseCounts.values[e];
+            else
+                out << "null";
+        }
+        out << ", \"ipc\": " << phaseCounts.GetIPC() << "}";
+    }
+
+    for ( const PerfEvent event : { PerfEvent_L1DMisses, PerfEvent_LLCMisses, PerfEvent_BranchMisses } )
+    {
+        out << ", \"" << GetPerfEventName(event) << "PerPixel\": ";
+        if ( counts[Phase_Render].available[event] )
+            out << CalcPerPixel(counts, event, size);
+        else
+            out << "null";
+    }
+    out << "}";
+}
+
+struct FeatureCost
+{
+    Feature      feature;
+    std::int64_t time; // nanoseconds
+};
+
+// returns the features with non-zero time, the most costly first
+static std::vector<FeatureCost> RankFeatures(const FeatureTimes& times)
+{
+    std::vector<FeatureCost> ranking;
+
+    for ( size_t f = 0; f < Feature_Count; ++f )
+    {
+        if ( times[f] > 0 )
+            ranking.push_back({static_cast<Feature>(f), times[f]});
+    }
+
+    std::stable_sort(ranking.begin(), ranking.end(),
+                     [](const FeatureCost& a, const FeatureCost& b) { return a.time > b.time; });
+    return ranking;
+}
+
+// the times of the features summed over the sizes
+static FeatureTimes SumFeatures(const FileResult& result)
+{
+    FeatureTimes sum{};
+
+    for ( const FeatureTimes& times : result.features )
+    {
+        for ( size_t f = 0; f < Feature_Count; ++f )
+            sum[f] += times[f];
+    }
+
+    return sum;
+}
+
+// ditto, summed also over the files
+static FeatureTimes SumFeatures(const std::vector<FileResult>& results)
+{
+    FeatureTimes total{};
+
+    for ( const auto& result : results )
+    {
+        const FeatureTimes sum = SumFeatures(result);
+
+        for ( size_t f = 0; f < Feature_Count; ++f )
+            total[f] += sum[f];
+    }
+
+    return total;
+}
+
+static void WriteFeaturesJSON(std::ostream& out, const FeatureTimes& times)
+{
+    out << ", \"features\": {";
+    for ( size_t f = 0; f < Feature_Count; ++f )
+        out << (f ? ", " : "") << "\"" << GetFeatureName(static_cast<Feature>(f)) << "\": " << times[f];
+    out << "}";
+}
+
+static void WriteFeatureRankingJSON(std::ostream& out, const FeatureTimes& times)
+{
+    const std::vector<FeatureCost> ranking = RankFeatures(times);
+
+    out << "\"featureRanking\": [";
+    for ( size_t i = 0; i < ranking.size(); ++i )
+    {
+        out << (i ? ", " : "") << "{\"feature\": \"" << GetFeatureName(ranking[i].feature)
+            << "\", \"time\": " << ranking[i].time << "}";
+    }
+    out << "]";
+}
+
+static void WriteJSON(std::ostream& out, const Options& options, const std::vector<FileResult>& results)
+{
+    WriteJSONHeader(out, options);
+
+    out << "  \"files\": [\n";
+    for ( size_t f = 0; f < results.size(); ++f )
+    {
+        const FileResult& result = results[f];
+
+        out << "    {\"name\": \"" << EscapeJSON(result.name) << "\", \"results\": [\n";
+        for ( size_t s = 0; s < options.sizes.size(); ++s )
+        {
+            const Stats&      stats = result.stats[s];
+            const AllocStats& allocs = result.allocs[s];
+
+            out << "      {\"width\": " << options.sizes[s].width << ", \"height\": " << options.sizes[s].height
+                << ", \"min\": " << stats.min << ", \"max\": " << stats.max
+                << ", \"median\": " << stats.mdn << ", \"mean\": " << stats.avg
+                << ", \"allocations\": " << allocs.count << ", \"allocatedBytes\": " << allocs.bytes
+                << ", \"peakBytes\": " << allocs.peakLive;
+            if ( !result.counts.empty() )
+                WriteCountsJSON(out, result.counts[s], options.sizes[s]);
+            if ( !result.features.empty() )
+                WriteFeaturesJSON(out, result.features[s]);
+            out << ", \"times\": [";
+            for ( size_t run = 0; run < result.times[s].size(); ++run )
+                out << (run ? ", " : "") << result.times[s][run];
+            out << "]}" << (s + 1 < options.sizes.size() ? "," : "") << "\n";
+        }
+        out << "    ]";
+        if ( !result.features.empty() )
+        {
+            out << ", ";
+            WriteFeatureRankingJSON(out, SumFeatures(result));
+        }
+        out << "}" << (f + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]";
+
+    if ( !results.empty() && !results.front().features.empty() )
+    {
+        out << ",\n  ";
+        WriteFeatureRankingJSON(out, SumFeatures(results));
+    }
+    out << "\n}\n";
+}
+
+static void WriteCSV(std::ostream& out, const Options& options, const std::vector<FileResult>& results)
+{
+    const PerfEvent perPixelEvents[] = { PerfEvent_L1DMisses, PerfEvent_LLCMisses, PerfEvent_BranchMisses };
+    const bool      hasCounts = !results.empty() && !results.front().counts.empty();
+    const bool      hasFeatures = !results.empty() && !results.front().features.empty();
+
+    out << "file,width,height,runs,min_ns,max_ns,median_ns,mean_ns,allocations,allocated_bytes,peak_bytes";
+    if ( hasCounts )
+    {
+        for ( size_t phase = 0; phase < Phase_Count; ++phase )
+        {
+            for ( size_t e = 0; e < PerfEvent_Count; ++e )
+                out << "," << PhaseNames[phase] << "_" << GetCSVName(GetPerfEventName(static_cast<PerfEvent>(e)));
+            out << "," << PhaseNames[phase] << "_ipc";
+        }
+        for ( const PerfEvent event : perPixelEvents )
+            out << "," << GetCSVName(GetPerfEventName(event)) << "_per_pixel";
+    }
+    if ( hasFeatures )
+    {
+        for ( size_t f = 0; f < Feature_Count; ++f )
+            out << ",feature_" << GetCSVName(GetFeatureName(static_cast<Feature>(f))) << "_ns";
+    }
+    out << "\n";
+
+    for ( const auto& result : results )
+    {
+        for ( size_t s = 0; s < options.sizes.size(); ++s )
+        {
+            const Stats&      stats = result.stats[s];
+            const AllocStats& allocs = result.allocs[s];
+
+            out << EscapeCSV(result.name) << "," << options.sizes[s].width << "," << options.sizes[s].height
+                << "," << options.runCount << "," << stats.min << "," << stats.max
+                << "," << stats.mdn << "," << stats.avg
+                << "," << allocs.count << "," << allocs.bytes << "," << allocs.peakLive;
+
+            // the unavailable events are empty
+            if ( hasCounts )
+            {
+                const PhaseCounts& counts = result.counts[s];
+
+                for ( const PerfCounts& phaseCounts : counts )
+                {
+                    for ( size_t e = 0; e < PerfEvent_Count; ++e )
+                    {
+                        out << ",";
+                        if ( phaseCounts.available[e] )
+                            out << phaseCounts.values[e];
+                    }
+                    out << "," << phaseCounts.GetIPC();
+                }
+                for ( const PerfEvent event : perPixelEvents )
+                {
+                    out << ",";
+                    if ( counts[Phase_Render].available[event] )
+                        out << CalcPerPixel(counts, event, options.sizes[s]);
+                }
+            }
+            if ( hasFeatures )
+            {
+                for ( const std::int64_t time : result.features[s] )
+                    out << "," << time;
+            }
+            out << "\n";
+        }
+    }
+}
+
+static void WriteThroughputJSON(std::ostream& out, const Options& options, const std::vector<std::string>& names,
+                                const std::vector<ThroughputResult>& results)
+{
+    WriteJSONHeader(out, options);
+
+    out << "  \"files\": [";
+    for ( size_t f = 0; f < names.size(); ++f )
+        out << (f ? ", " : "") << "\"" << EscapeJSON(names[f]) << "\"";
+    out << "],\n";
+
+    out << "  \"throughput\": [\n";
+    for ( size_t i = 0; i < results.size(); ++i )
+    {
+        const ThroughputResult& result = results[i];
+
+        out << "    {\"threads\": " << result.threadCount << ", \"icons\": " << result.iconCount
+            << ", \"wallTime\": " << result.wallTime << ", \"iconsPerSecond\": " << result.iconsPerSecond
+            << ", \"speedup\": " << result.speedup << ", \"efficiency\": " << result.efficiency
+            << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+static void WriteThroughputCSV(std::ostream& out, const std::vector<ThroughputResult>& results)
+{
+    out << "threads,icons,wall_ns,icons_per_second,speedup,efficiency\n";
+    for ( const auto& result : results )
+    {
+        out << result.threadCount << "," << result.iconCount << "," << result.wallTime
+            << "," << result.iconsPerSecond << "," << result.speedup << "," << result.efficiency << "\n";
+    }
+}
+
+// Chrome trace event format, the times are in microseconds
+static void WriteTrace(std::ostream& out, const std::vector<TraceEvent>& events)
+{
+    out << "{\n";
+    out << "  \"displayTimeUnit\": \"ns\",\n";
+    out << "  \"traceEvents\": [\n";
+
+    for ( size_t i = 0; i < events.size(); ++i )
+    {
+        const TraceEvent& e = events[i];
+        char              ts[32];
+
+        std::snprintf(ts, sizeof(ts), "%.3f", e.time / 1000.0);
+        out << "    {\"name\": \"" << EscapeJSON(e.name) << "\", \"cat\": \"" << EscapeJSON(e.category)
+            << "\", \"ph\": \"" << (e.begin ? "B" : "E") << "\", \"ts\": " << ts << ", \"pid\": 1, \"tid\": 1";
+        if ( e.begin && !e.tag.empty() )
+        {
+            out << ", \"args\": {\"tag\": \"" << EscapeJSON(e.tag) << "\", \"id\": \"" << EscapeJSON(e.id) << "\"}";
+        }
+        out << "}" << (i + 1 < events.size() ? "," : "") << "\n";
+    }
+
+    out << "  ]\n";
+    out << "}\n";
+}
+
+// writes to the file at path or to stdout if path is "-"
+template <typename WriteFn>
+static bool WriteOutput(const std::string& path, WriteFn write)
+{
+    if ( path == "-" )
+    {
+        write(std::cout);
+        return static_cast<bool>(std::cout);
+    }
+
+    std::ofstream file(path, std::ios::binary);
+
+    if ( !file )
+    {
+        std::cerr << "Couldn't create file '" << path << "'.\n";
+        return false;
+    }
+
+    write(file);
+    return static_cast<bool>(file);
+}
+
+// the sums of medians for each size, as in the GUI report
+static void WriteSummary(std::ostream& out, const Options& options, const std::vector<FileResult>& results)
+{
+    out << "Benchmarked " << results.size() << " files from folder '" << options.dir.string()
+        << "' (" << options.runCount << " runs, " << (options.renderOnly ? "render only" : "full") << ")\n";
+
+    for ( size_t s = 0; s < options.sizes.size(); ++s )
+    {
+        double        sum = 0;
+        std::uint64_t maxPeak = 0;
+
+        for ( const auto& result : results )
+        {
+            sum += static_cast<double>(result.stats[s].mdn);
+            maxPeak = std::max(maxPeak, result.allocs[s].peakLive);
+        }
+
+        char line[128];
+
+        std::snprintf(line, sizeof(line), "%5ux%-5u sum of medians: %10.2f ms, max peak memory: %10.1f KiB\n",
+                      options.sizes[s].width, options.sizes[s].height, sum / 1e6, maxPeak / 1024.);
+        out << line;
+    }
+
+    if ( results.empty() || results.front().counts.empty() )
+        return;
+
+    out << "Hardware counters of all files (IPC for each phase, misses per pixel when rendering)\n";
+    out << "Size          Parse  Layout  Render Convert   L1D miss/px   LLC miss/px  Branch miss/px\n";
+    for ( size_t s = 0; s < options.sizes.size(); ++s )
+    {
+        PhaseCounts counts = results.front().counts[s];
+
+        for ( size_t f = 1; f < results.size(); ++f )
+        {
+            for ( size_t phase = 0; phase < Phase_Count; ++phase )
+                counts[phase] += results[f].counts[s][phase];
+        }
+
+        char line[160];
+
+        std::snprintf(line, sizeof(line), "%5ux%-5u %7.2f %7.2f %7.2f %7.2f %13.3f %13.3f %15.3f\n",
+                      options.sizes[s].width, options.sizes[s].height,
+                      counts[Phase_Parse].GetIPC(), counts[Phase_Layout].GetIPC(),
+                      counts[Phase_Render].GetIPC(), counts[Phase_Convert].GetIPC(),
+                      CalcPerPixel(counts, PerfEvent_L1DMisses, options.sizes[s]) / results.size(),
+                      CalcPerPixel(counts, PerfEvent_LLCMisses, options.sizes[s]) / results.size(),
+                      CalcPerPixel(counts, PerfEvent_BranchMisses, options.sizes[s]) / results.size());
+        out << line;
+    }
+
+    for ( size_t e = 0; e < PerfEvent_Count; ++e )
+    {
+        if ( !results.front().counts.front()[Phase_Parse].available[e] )
+            out << "Event '" << GetPerfEventName(static_cast<PerfEvent>(e)) << "' is not available, reported as 0.\n";
+    }
+}
+
+// the features ranked by their time in all the files and sizes
+static void WriteFeatureSummary(std::ostream& out, const std::vector<FileResult>& results)
+{
+    double medianSum = 0;
+
+    for ( const auto& result : results )
+    {
+        for ( const Stats& stats : result.stats )
+            medianSum += static_cast<double>(stats.mdn);
+    }
+
+    out << "Features of all files ranked by time (average per run, all sizes)\n";
+    out << "Rank Feature          Time [ms]  Share  Files  Most costly file\n";
+
+    const std::vector<FeatureCost> ranking = RankFeatures(SumFeatures(results));
+
+    for ( size_t i = 0; i < ranking.size(); ++i )
+    {
+        const Feature feature = ranking[i].feature;
+        size_t        fileCount = 0;
+        std::int64_t  maxTime = 0;
+        std::string   maxName;
+
+        for ( const auto& result : results )
+        {
+            const std::int64_t time = SumFeatures(result)[feature];
+
+            if ( time > 0 )
+                ++fileCount;
+            if ( time > maxTime )
+            {
+                maxTime = time;
+                maxName = result.name;
+            }
+        }
+
+        char line[128];
+
+        // share of the sum of the medians of all files and sizes
+        std::snprintf(line, sizeof(line), "%4zu %-14s %11.3f %5.1f%% %6zu  ", i + 1, GetFeatureName(feature),
+                      ranking[i].time / 1e6, medianSum > 0 ? ranking[i].time * 100. / medianSum : 0., fileCount);
+        out << line << maxName << "\n";
+    }
+
+    if ( ranking.empty() )
+        out << "No time was attributed to any feature.\n";
+}
+
+static void WriteComparisonCSV(std::ostream& out, const std::vector<Comparison>& comparisons)
+{
+    out << "file,width,height,baseline_median_ns,median_ns,change_percent,p_value,verdict\n";
+    for ( const auto& c : comparisons )
+    {
+        out << EscapeCSV(c.name) << "," << c.size.width << "," << c.size.height
+            << "," << c.baselineMedian << "," << c.currentMedian << "," << c.change
+            << "," << c.pValue << "," << GetVerdictName(c.verdict) << "\n";
+    }
+}
+
+// lists the regressions and improvements, the worst first
+static void WriteComparisonReport(std::ostream& out, const Options& options, const Baseline& baseline,
+                                  std::vector<Comparison> comparisons, size_t notInBaselineCount)
+{
+    const size_t comparedCount = comparisons.size();
+    const size_t regressionCount = CountVerdicts(comparisons, Verdict::Regression);
+    const size_t improvementCount = CountVerdicts(comparisons, Verdict::Improvement);
+
+    out << "Compared " << comparedCount << " results with baseline '" << options.baselinePath
+        << "' (alpha " << options.alpha << ", threshold " << options.threshold << "%)\n";
+
+    if ( baseline.mode != GetModeName(options) )
+    {
+        out << "Warning: baseline mode is '" << baseline.mode << "' but the current one is '"
+            << GetModeName(options) << "'.\n";
+    }
+
+    comparisons.erase(std::remove_if(comparisons.begin(), comparisons.end(),
+                        [](const Comparison& c) { return c.verdict == Verdict::Unchanged; }),
+                      comparisons.end());
+    std::sort(comparisons.begin(), comparisons.end(),
+              [](const Comparison& a, const Comparison& b) { return a.change > b.change; });
+
+    for ( const auto& c : comparisons )
+    {
+        char line[128];
+
+        std::snprintf(line, sizeof(line), "%-11s %+8.1f%%  p=%-8.2g %5ux%-5u %10.1f -> %10.1f us  ",
+                      c.verdict == Verdict::Regression ? "REGRESSION" : "improvement",
+                      c.change, c.pValue, c.size.width, c.size.height,
+                      c.baselineMedian / 1e3, c.currentMedian / 1e3);
+        out << line << c.name << "\n";
+    }
+
+    out << regressionCount << " regressions, " << improvementCount << " improvements, "
+        << comparedCount - regressionCount - improvementCount << " unchanged";
+    if ( notInBaselineCount )
+        out << ", " << notInBaselineCount << " results not in baseline";
+    out << "\n";
+}
+
+static void WriteThroughputSummary(std::ostream& out, const Options& options, size_t fileCount,
+                                   const std::vector<ThroughputResult>& results)
+{
+    out << "Measured throughput for " << fileCount << " files from folder '" << options.dir.string()
+        << "' (" << options.sizes.size() << " sizes, " << options.runCount << " runs, "
+        << (options.renderOnly ? "render only" : "full") << ")\n";
+    out << "Threads   Icons/second   Speedup   Efficiency\n";
+
+    for ( const auto& result : results )
+    {
+        char line[128];
+
+        std::snprintf(line, sizeof(line), "%7zu %14.1f %9.2f %11.1f%%\n",
+                      result.threadCount, result.iconsPerSecond, result.speedup, result.efficiency * 100);
+        out << line;
+    }
+}
+
+// ============================================================================
+// main
+// ============================================================================
+
+int main(int argc, char** argv)
+{
+    Options options;
+
+    if ( !ParseCommandLine(argc, argv, options) )
+    {
+        PrintUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if ( options.showHelp )
+    {
+        PrintUsage(argv[0]);
+        return EXIT_SUCCESS;
+    }
+
+    const std::vector<fs::path> files = FindSVGFiles(options.dir, options.recursive);
+
+    if ( files.empty() )
+    {
+        std::cerr << "No SVG files found in folder '" << options.dir.string() << "'.\n";
+        return EXIT_FAILURE;
+    }
+
+    // do not mix the summary with the results written to stdout
+    const bool resultsToStdout = options.jsonPath == "-" || options.csvPath == "-" || options.tracePath == "-";
+    bool       ok = true;
+
+    Baseline baseline;
+
+    if ( !options.baselinePath.empty() && !LoadBaseline(options.baselinePath, baseline) )
+        return EXIT_FAILURE;
+
+    if ( options.maxThreadCount > 0 )
+    {
+        if ( !options.baselinePath.empty() || !options.saveBaselinePath.empty() )
+        {
+            std::cerr << "Baselines are not supported when measuring throughput.\n";
+            return EXIT_FAILURE;
+        }
+        if ( options.perf )
+        {
+            std::cerr << "Hardware counters are not supported when measuring throughput.\n";
+            return EXIT_FAILURE;
+        }
+        if ( options.features || !options.tracePath.empty() )
+        {
+            std::cerr << "Features and render trace are not supported when measuring throughput.\n";
+            return EXIT_FAILURE;
+        }
+
+        std::vector<std::string>      names, data;
+        std::vector<ThroughputResult> results;
+
+        LoadFilesForThroughput(options, files, names, data);
+        if ( data.empty() || !RunThroughput(options, data, results) )
+            return EXIT_FAILURE;
+
+        if ( !options.jsonPath.empty() )
+        {
+            ok = WriteOutput(options.jsonPath, [&](std::ostream& out) { WriteThroughputJSON(out, options, names, results); }) && ok;
+        }
+        if ( !options.csvPath.empty() )
+        {
+            ok = WriteOutput(options.csvPath, [&](std::ostream& out) { WriteThroughputCSV(out, results); }) && ok;
+        }
+
+        WriteThroughputSummary(resultsToStdout ? std::cerr : std::cout, options, names.size(), results);
+
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    std::unique_ptr<PerfCounters> counters;
+
+    if ( options.perf )
+    {
+        counters.reset(new PerfCounters());
+        if ( !counters->IsAvailable() )
+        {
+            std::cerr << "Hardware counters are not available (" << counters->GetError()
+                      << "), continuing without them.\n";
+            counters.reset();
+        }
+    }
+
+    std::unique_ptr<FeatureCostRecorder> featureRecorder;
+
+    if ( options.features )
+    {
+        featureRecorder.reset(new FeatureCostRecorder());
+        if ( featureRecorder->Start() )
+            featureRecorder->Stop();
+        else
+        {
+            std::cerr << "LunaSVG was built without the render trace hooks, continuing without features.\n";
+            featureRecorder.reset();
+        }
+    }
+
+    std::unique_ptr<TraceRecorder> recorder;
+
+    if ( !options.tracePath.empty() )
+    {
+        recorder.reset(new TraceRecorder());
+        if ( recorder->Start() )
+            recorder->Stop();
+        else
+        {
+            std::cerr << "LunaSVG was built without the render trace hooks, continuing without the trace.\n";
+            recorder.reset();
+        }
+    }
+
+    std::vector<FileResult> results;
+
+    results.reserve(files.size());
+    for ( const auto& path : files )
+    {
+        FileResult result;
+
+        result.name = path.lexically_relative(options.dir).generic_string();
+        if ( !BenchmarkFile(options, path, result.name, counters.get(), featureRecorder.get(),
+                            recorder.get(), result) )
+        {
+            // the reason was already reported
+            std::cerr << "Skipping file '" << result.name << "'.\n";
+            continue;
+        }
+
+        results.push_back(std::move(result));
+    }
+
+    if ( results.empty() )
+        return EXIT_FAILURE;
+
+    if ( !options.jsonPath.empty() )
+    {
+        ok = WriteOutput(options.jsonPath, [&](std::ostream& out) { WriteJSON(out, options, results); }) && ok;
+    }
+    if ( !options.csvPath.empty() )
+    {
+        ok = WriteOutput(options.csvPath, [&](std::ostream& out) { WriteCSV(out, options, results); }) && ok;
+    }
+
+    if ( recorder )
+    {
+        ok = WriteOutput(options.tracePath, [&](std::ostream& out) { WriteTrace(out, recorder->GetEvents()); }) && ok;
+    }
+
+    if ( !options.saveBaselinePath.empty() )
+    {
+        ok = WriteOutput(options.saveBaselinePath, [&](std::ostream& out) { WriteBaseline(out, options, results); }) && ok;
+    }
+
+    std::ostream& summaryOut = resultsToStdout || options.comparisonPath == "-" ? std::cerr : std::cout;
+
+    WriteSummary(summaryOut, options, results);
+    if ( featureRecorder )
+        WriteFeatureSummary(summaryOut, results);
+
+    if ( options.baselinePath.empty() )
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    size_t                        notInBaselineCount = 0;
+    const std::vector<Comparison> comparisons = CompareWithBaseline(options, baseline, results, notInBaselineCount);
+
+    if ( !options.comparisonPath.empty() )
+    {
+        ok = WriteOutput(options.comparisonPath, [&](std::ostream& out) { WriteComparisonCSV(out, comparisons); }) && ok;
+    }
+
+    WriteComparisonReport(summaryOut, options, baseline, comparisons, notInBaselineCount);
+
+    if ( !ok )
+        return EXIT_FAILURE;
+
+    return CountVerdicts(comparisons, Verdict::Regression) > options.maxRegressions ? ExitRegressions : EXIT_SUCCESS;
+}
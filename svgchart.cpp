@@ -0,0 +1,295 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        svgchart.cpp
+// Purpose:     Writing simple line charts as SVG
+// Author:      PB
+// Created:     2024-01-18
+// Copyright:   (c) 2024 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "svgchart.h"
+
+// the size of a chart and its margins in the SVG units
+const double ChartWidth = 400;
+const double ChartHeight = 260;
+const double MarginLeft = 64;
+const double MarginRight = 16;
+const double MarginTop = 28;
+const double MarginBottom = 44;
+const double TitleHeight = 32;
+
+const size_t YTickCount = 5;
+
+static std::string EscapeXML(const std::string& text)
+{
+    std::string result;
+
+    for ( const char c : text )
+    {
+        switch ( c )
+        {
+            case '<':  result += "&lt;"; break;
+            case '>':  result += "&gt;"; break;
+            case '&':  result += "&amp;"; break;
+            case '"':  result += "&quot;"; break;
+            default:   result += c;
+        }
+    }
+
+    return result;
+}
+
+static std::string FormatNumber(double value)
+{
+    char buf[32];
+
+    std::snprintf(buf, sizeof(buf), "%g", value);
+    return buf;
+}
+
+// returns 1, 2 or 5 times a power of 10 so that count steps cover maxValue
+static double CalcNiceStep(double maxValue, size_t count)
+{
+    if ( maxValue <= 0 )
+        return 1;
+
+    const double rawStep = maxValue / count;
+    const double magnitude = std::pow(10, std::floor(std::log10(rawStep)));
+
+    for ( const double m : { 1.0, 2.0, 5.0 } )
+    {
+        if ( m * magnitude >= rawStep )
+            return m * magnitude;
+    }
+
+    return 10 * magnitude;
+}
+
+static bool IsDrawn(double value, bool logScale)
+{
+    return !std::isnan(value) && (!logScale || value > 0);
+}
+
+static void WriteChart(std::ostream& out, const Chart& chart, double left, double top)
+{
+    const double plotLeft = left + MarginLeft;
+    const double plotTop = top + MarginTop;
+    const double plotWidth = ChartWidth - MarginLeft - MarginRight;
+    const double plotHeight = ChartHeight - MarginTop - MarginBottom;
+
+    double minValue = 0, maxValue = 0;
+
+    for ( const auto& s : chart.series )
+    {
+        for ( const double v : s.values )
+        {
+            if ( !IsDrawn(v, chart.logY) )
+                continue;
+            minValue = minValue > 0 ? std::min(minValue, v) : v;
+            maxValue = std::max(maxValue, v);
+        }
+    }
+
+    std::vector<double> yTicks;
+
+    if ( chart.logY )
+    {
+        const int minDecade = minValue > 0 ? static_cast<int>(std::floor(std::log10(minValue))) : 0;
+        const int maxDecade = std::max(maxValue > 0 ? static_cast<int>(std::ceil(std::log10(maxValue))) : 0,
+                                       minDecade + 1);
+
+        for ( int d = minDecade; d <= maxDecade; ++d )
+            yTicks.push_back(std::pow(10, d));
+    }
+    else
+    {
+        const double yStep = CalcNiceStep(maxValue, YTickCount);
+        const double yMax = yStep * std::max(std::ceil(maxValue / yStep), 1.0);
+
+        for ( size_t i = 0; i <= YTickCount; ++i )
+            yTicks.push_back(yMax * i / YTickCount);
+    }
+
+    const auto transformX = [&](double x) { return chart.logX ? std::log(x) : x; };
+    const double xMin = chart.x.empty() ? 0 : transformX(chart.x.front());
+    const double xMax = chart.x.empty() ? 1 : transformX(chart.x.back());
+
+    const auto mapX = [&](double x)
+    {
+        return xMax > xMin ? plotLeft + (transformX(x) - xMin) / (xMax - xMin) * plotWidth
+                           : plotLeft + plotWidth / 2;
+    };
+    const auto transformY = [&](double y) { return chart.logY ? std::log(y) : y; };
+    const double yMin = transformY(yTicks.front());
+    const double yMax = transformY(yTicks.back());
+
+    const auto mapY = [&](double y) { return plotTop + plotHeight - (transformY(y) - yMin) / (yMax - yMin) * plotHeight; };
+
+    out << "<g>\n"
+        << "<text x=\"" << left + ChartWidth / 2 << "\" y=\"" << top + 18
+        << "\" text-anchor=\"middle\" font-weight=\"bold\">" << EscapeXML(chart.title) << "</text>\n";
+
+    // horizontal grid lines with the y values
+    for ( const double value : yTicks )
+    {
+        const double y = mapY(value);
+
+        out << "<line x1=\"" << plotLeft << "\" y1=\"" << y << "\" x2=\"" << plotLeft + plotWidth
+            << "\" y2=\"" << y << "\" stroke=\"#ddd\"/>\n"
+            << "<text x=\"" << plotLeft - 4 << "\" y=\"" << y + 4 << "\" text-anchor=\"end\">"
+            << FormatNumber(value) << "</text>\n";
+    }
+
+    for ( const double x : chart.x )
+    {
+        out << "<text x=\"" << mapX(x) << "\" y=\"" << plotTop + plotHeight + 14
+            << "\" text-anchor=\"middle\">" << FormatNumber(x) << "</text>\n";
+    }
+
+    out << "<rect x=\"" << plotLeft << "\" y=\"" << plotTop << "\" width=\"" << plotWidth
+        << "\" height=\"" << plotHeight << "\" fill=\"none\" stroke=\"#888\"/>\n"
+        << "<text x=\"" << plotLeft + plotWidth / 2 << "\" y=\"" << top + ChartHeight - 8
+        << "\" text-anchor=\"middle\">" << EscapeXML(chart.xLabel) << "</text>\n"
+        << "<text transform=\"translate(" << left + 14 << " " << plotTop + plotHeight / 2
+        << ") rotate(-90)\" text-anchor=\"middle\">" << EscapeXML(chart.yLabel) << "</text>\n";
+
+    for ( size_t i = 0; i < chart.series.size(); ++i )
+    {
+        const ChartSeries& s = chart.series[i];
+        const size_t       count = std::min(s.values.size(), chart.x.size());
+
+        out << "<polyline fill=\"none\" stroke-width=\"1.5\" stroke=\"" << s.color << "\" points=\"";
+        for ( size_t p = 0; p < count; ++p )
+        {
+            if ( IsDrawn(s.values[p], chart.logY) )
+                out << mapX(chart.x[p]) << "," << mapY(s.values[p]) << " ";
+        }
+        out << "\"/>\n";
+
+        for ( size_t p = 0; p < count; ++p )
+        {
+            if ( !IsDrawn(s.values[p], chart.logY) )
+                continue;
+
+            out << "<circle r=\"2.5\" fill=\"" << s.color << "\" cx=\"" << mapX(chart.x[p])
+                << "\" cy=\"" << mapY(s.values[p]) << "\"/>\n";
+        }
+
+        // legend in the top left corner of the plot
+        const double legendY = plotTop + 14 + i * 14;
+
+        out << "<line x1=\"" << plotLeft + 8 << "\" y1=\"" << legendY - 4 << "\" x2=\"" << plotLeft + 24
+            << "\" y2=\"" << legendY - 4 << "\" stroke-width=\"2\" stroke=\"" << s.color << "\"/>\n"
+            << "<text x=\"" << plotLeft + 28 << "\" y=\"" << legendY << "\">" << EscapeXML(s.name) << "</text>\n";
+    }
+
+    out << "</g>\n";
+}
+
+std::string CreateChartsSVG(const std::string& title, const std::vector<Chart>& charts, size_t columnCount)
+{
+    std::ostringstream out;
+
+    columnCount = std::max<size_t>(1, std::min(columnCount, charts.size()));
+
+    const size_t rowCount = (charts.size() + columnCount - 1) / columnCount;
+    const double titleHeight = title.empty() ? 0 : TitleHeight;
+    const double width = columnCount * ChartWidth;
+    const double height = titleHeight + rowCount * ChartHeight;
+
+    out << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << width << "\" height=\"" << height
+        << "\" viewBox=\"0 0 " << width << " " << height << "\" font-family=\"sans-serif\" font-size=\"11\">\n"
+        << "<rect width=\"100%\" height=\"100%\" fill=\"white\"/>\n";
+
+    if ( !title.empty() )
+    {
+        out << "<text x=\"" << width / 2 << "\" y=\"22\" text-anchor=\"middle\" font-size=\"16\">"
+            << EscapeXML(title) << "</text>\n";
+    }
+
+    for ( size_t i = 0; i < charts.size(); ++i )
+        WriteChart(out, charts[i], (i % columnCount) * ChartWidth, titleHeight + (i / columnCount) * ChartHeight);
+
+    out << "</svg>\n";
+
+    return out.str();
+}
+
+bool WriteChartsSVG(const std::string& fileName, const std::string& title,
+                    const std::vector<Chart>& charts, size_t columnCount)
+{
+    std::ofstream out(fileName, std::ios::binary);
+
+    if ( !out )
+        return false;
+
+    out << CreateChartsSVG(title, charts, columnCount);
+
+    return static_cast<bool>(out);
+}
+
+std::string CreateSparklineSVG(const std::vector<ChartSeries>& series, double width, double height)
+{
+    const double margin = 2; // so that the markers are not clipped
+
+    std::ostringstream out;
+    size_t             pointCount = 0;
+    double             minValue = 0, maxValue = 0;
+    bool               hasValue = false;
+
+    // all the series share the scale, so that their values can be compared
+    for ( const auto& s : series )
+    {
+        pointCount = std::max(pointCount, s.values.size());
+
+        for ( const double v : s.values )
+        {
+            if ( !IsDrawn(v, false) )
+                continue;
+            minValue = hasValue ? std::min(minValue, v) : v;
+            maxValue = hasValue ? std::max(maxValue, v) : v;
+            hasValue = true;
+        }
+    }
+
+    const auto mapX = [&](size_t p)
+    {
+        return pointCount > 1 ? margin + p * (width - 2 * margin) / (pointCount - 1) : width / 2;
+    };
+    const auto mapY = [&](double v)
+    {
+        return maxValue > minValue ? height - margin - (v - minValue) / (maxValue - minValue) * (height - 2 * margin)
+                                   : height / 2;
+    };
+
+    out << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << width << "\" height=\"" << height
+        << "\" viewBox=\"0 0 " << width << " " << height << "\">";
+
+    for ( const auto& s : series )
+    {
+        out << "<polyline fill=\"none\" stroke=\"" << s.color << "\" points=\"";
+        for ( size_t p = 0; p < s.values.size(); ++p )
+        {
+            if ( IsDrawn(s.values[p], false) )
+                out << mapX(p) << "," << mapY(s.values[p]) << " ";
+        }
+        out << "\"/>";
+
+        // the last value is the most interesting one
+        if ( !s.values.empty() && IsDrawn(s.values.back(), false) )
+        {
+            out << "<circle r=\"1.5\" fill=\"" << s.color << "\" cx=\"" << mapX(s.values.size() - 1)
+                << "\" cy=\"" << mapY(s.values.back()) << "\"/>";
+        }
+    }
+
+    out << "</svg>";
+
+    return out.str();
+}
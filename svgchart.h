@@ -0,0 +1,50 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        svgchart.h
+// Purpose:     Writing simple line charts as SVG
+// Author:      PB
+// Created:     2024-01-18
+// Copyright:   (c) 2024 PB
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef SVGCHART_H_DEFINED
+#define SVGCHART_H_DEFINED
+
+// Does not depend on wxWidgets
+
+#include <string>
+#include <vector>
+
+struct ChartSeries
+{
+    std::string         name;
+    std::string         color; // any SVG color, e.g. "#1f77b4"
+    std::vector<double> values; // for each x of the chart, NaN values are not drawn
+};
+
+struct Chart
+{
+    std::string              title;
+    std::string              xLabel;
+    std::string              yLabel;
+    std::vector<double>      x;    // ascending, must be positive with logX
+    bool                     logX{false};
+    bool                     logY{false}; // the values which are not positive are not drawn
+    std::vector<ChartSeries> series;
+};
+
+// returns SVG document with the charts arranged in a grid with columnCount
+// columns and the title above them, if any; the linear y axes start at 0,
+// the logarithmic ones span whole decades
+std::string CreateChartsSVG(const std::string& title, const std::vector<Chart>& charts, size_t columnCount);
+
+// writes the document returned by CreateChartsSVG() to a file
+bool WriteChartsSVG(const std::string& fileName, const std::string& title,
+                    const std::vector<Chart>& charts, size_t columnCount);
+
+// returns a small SVG document with the series drawn without any axes or labels,
+// for showing the trend of values inline; the values of all series are scaled
+// together to fill the height
+std::string CreateSparklineSVG(const std::vector<ChartSeries>& series, double width, double height);
+
+#endif // #ifndef SVGCHART_H_DEFINED
@@ -115,6 +115,8 @@ wxTestSVG2Frame::wxTestSVG2Frame()
 
     m_lastSVGFolder = config->Read("lastSVGFolder", m_lastSVGFolder);
     m_lastRunCount  = config->Read("lastRunCount", m_lastRunCount);
+    m_lastModes     = config->Read("lastBenchmarkModes", wxString::Format("%d", wxTestSVGRasterizationBenchmark::Mode_Full));
+    m_lastBackends  = config->Read("lastBenchmarkBackends", "Nano,Luna");
 
     SetIcon(wxICON(wxICON_AAA)); // from wx.rc
 
@@ -141,6 +143,10 @@ wxTestSVG2Frame::wxTestSVG2Frame()
     benchmarkFolderBtn->Bind(wxEVT_BUTTON, &wxTestSVG2Frame::OnBenchmarkFolder, this);
     controlPanelSizer->Add(benchmarkFolderBtn, wxSizerFlags().Expand().Border());
 
+    wxButton* benchmarkFolderToFileBtn = new wxButton(controlPanel, wxID_ANY, "Benchmark Current Folder to Fi&le...");
+    benchmarkFolderToFileBtn->Bind(wxEVT_BUTTON, &wxTestSVG2Frame::OnBenchmarkFolderToFile, this);
+    controlPanelSizer->Add(benchmarkFolderToFileBtn, wxSizerFlags().Expand().Border());
+
     wxButton* changeFolderBtn = new wxButton(controlPanel, wxID_ANY, "Change &Folder...");
     changeFolderBtn->Bind(wxEVT_BUTTON, &wxTestSVG2Frame::OnChangeFolder, this);
     controlPanelSizer->Add(changeFolderBtn, wxSizerFlags().Expand().Border());
@@ -185,6 +191,8 @@ wxTestSVG2Frame::~wxTestSVG2Frame()
 
     config->Write("lastSVGFolder", m_fileCtrl->GetDirectory());
     config->Write("lastRunCount", m_lastRunCount);
+    config->Write("lastBenchmarkModes", m_lastModes);
+    config->Write("lastBenchmarkBackends", m_lastBackends);
 }
 
 void wxTestSVG2Frame::OnFileSelected(wxFileCtrlEvent& event)
@@ -202,20 +210,23 @@ void wxTestSVG2Frame::OnFileActivated(wxFileCtrlEvent& event)
    wxLaunchDefaultApplication(fileName.GetFullPath());
 }
 
-void wxTestSVG2Frame::OnBenchmarkFolder(wxCommandEvent&)
+bool wxTestSVG2Frame::GetBenchmarkSettings(wxString& dirName, wxArrayString& files,
+                                           std::vector<wxSize>& sizes, long& runCount,
+                                           std::vector<wxTestSVGRasterizationBenchmark::Mode>& modes,
+                                           std::vector<wxTestSVGRasterizationBenchmark::Backend>& backends)
 {
 #ifndef NDEBUG
     if ( wxMessageBox("It appears you are running the debug version of the application, "
                       "which is much slower than the release one. Continue anyway?",
                       "Warning", wxYES_NO | wxNO_DEFAULT) != wxYES )
     {
-        return;
+        return false;
     }
 #endif
-    const wxString dirName = m_fileCtrl->GetDirectory();
-    wxArrayString  dirFiles;
-    wxArrayString  files;
-    wxArrayInt     selections;
+    wxArrayString dirFiles;
+    wxArrayInt    selections;
+
+    dirName = m_fileCtrl->GetDirectory();
 
     {
         wxBusyCursor bc;
@@ -225,7 +236,7 @@ void wxTestSVG2Frame::OnBenchmarkFolder(wxCommandEvent&)
     if ( dirFiles.empty() )
     {
         wxLogMessage("No SVG files found in the current folder.");
-        return;
+        return false;
     }
 
     for ( auto& f : dirFiles )
@@ -241,7 +252,7 @@ void wxTestSVG2Frame::OnBenchmarkFolder(wxCommandEvent&)
                               "Benchmark Rasterization", dirFiles, this) == -1
          || selections.empty() )
     {
-        return;
+        return false;
     }
 
     for ( const auto& s : selections )
@@ -271,34 +282,151 @@ void wxTestSVG2Frame::OnBenchmarkFolder(wxCommandEvent&)
 
     if ( wxGetSelectedChoices(selections, "Select Bitmap Sizes", "Benchmark Rasterization", bitmapSizesStrings, this) == -1
          || selections.empty() )
-        return;
+        return false;
 
-    const long runCount = wxGetNumberFromUser("Number of runs (between 10 and 100)", "Number", "Benchmark Rasterization", m_lastRunCount, 10, 100);
+    runCount = wxGetNumberFromUser("Number of runs (between 10 and 100)", "Number", "Benchmark Rasterization", m_lastRunCount, 10, 100);
 
     if ( runCount == -1 )
-        return;
+        return false;
     m_lastRunCount = runCount;
 
+    for ( const auto& s : selections )
+        sizes.push_back(bitmapSizes[s]);
+
+    wxArrayString modeStrings;
+
+    for ( int m = 0; m < wxTestSVGRasterizationBenchmark::Mode_Count; ++m )
+        modeStrings.push_back(wxTestSVGRasterizationBenchmark::GetModeName(static_cast<wxTestSVGRasterizationBenchmark::Mode>(m)));
+
+    selections.clear();
+    for ( const auto& m : wxSplit(m_lastModes, ',') )
+    {
+        long mode = 0;
+
+        if ( m.ToLong(&mode) && mode >= 0 && mode < wxTestSVGRasterizationBenchmark::Mode_Count )
+            selections.push_back(mode);
+    }
+
+    if ( wxGetSelectedChoices(selections, "Select Modes", "Benchmark Rasterization", modeStrings, this) == -1
+         || selections.empty() )
+        return false;
+
+    m_lastModes.clear();
+    for ( const auto& s : selections )
+    {
+        modes.push_back(static_cast<wxTestSVGRasterizationBenchmark::Mode>(s));
+        m_lastModes += wxString::Format("%d,", s);
+    }
+    m_lastModes.RemoveLast();
+
+    const auto&         registeredBackends = wxTestSVGRasterizationBenchmark::GetRegisteredBackends();
+    const wxArrayString lastBackends = wxSplit(m_lastBackends, ',');
+    wxArrayString       backendStrings;
+
+    selections.clear();
+    for ( size_t i = 0; i < registeredBackends.size(); ++i )
+    {
+        backendStrings.push_back(wxString::Format("%s: %s", registeredBackends[i].name, registeredBackends[i].description));
+        if ( lastBackends.Index(registeredBackends[i].name) != wxNOT_FOUND )
+            selections.push_back(i);
+    }
+
+    if ( wxGetSelectedChoices(selections, "Select Backends", "Benchmark Rasterization", backendStrings, this) == -1
+         || selections.empty() )
+        return false;
+
+    bool hasPlainLunaSVG = false;
+
+    m_lastBackends.clear();
+    for ( const auto& s : selections )
+    {
+        backends.push_back(registeredBackends[s]);
+        hasPlainLunaSVG = hasPlainLunaSVG || registeredBackends[s].isPlainLunaSVG;
+        m_lastBackends += registeredBackends[s].name + ",";
+    }
+    m_lastBackends.RemoveLast();
+
+    for ( const auto& mode : modes )
+    {
+        if ( wxTestSVGRasterizationBenchmark::IsLunaSVGOnlyMode(mode) && !hasPlainLunaSVG )
+        {
+            wxLogMessage("Mode '%s' requires the plain LunaSVG backend.", wxTestSVGRasterizationBenchmark::GetModeName(mode));
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void wxTestSVG2Frame::OnBenchmarkFolder(wxCommandEvent&)
+{
+    wxString            dirName;
+    wxArrayString       files;
+    std::vector<wxSize> sizes;
+    long                runCount = 0;
+    std::vector<wxTestSVGRasterizationBenchmark::Mode> modes;
+    std::vector<wxTestSVGRasterizationBenchmark::Backend> backends;
+
+    if ( IsBenchmarkRunning() || !GetBenchmarkSettings(dirName, files, sizes, runCount, modes, backends) )
+        return;
+
     wxTestSVGRasterizationBenchmark benchmark;
 
+    benchmark.Setup(dirName, files, sizes, modes, backends);
+    benchmark.SetHistoryFileName(wxTestSVGBenchmarkHistory::GetDefaultFileName());
+
+    // runs the benchmark when the application is idle and shows the report
+    m_benchmarkProgressFrame = new wxTestSVGBenchmarkProgressFrame(this, benchmark, runCount);
+}
+
+void wxTestSVG2Frame::OnBenchmarkFolderToFile(wxCommandEvent&)
+{
+    wxString            dirName;
+    wxArrayString       files;
     std::vector<wxSize> sizes;
+    long                runCount = 0;
+    std::vector<wxTestSVGRasterizationBenchmark::Mode> modes;
+    std::vector<wxTestSVGRasterizationBenchmark::Backend> backends;
 
-    for ( const auto& s : selections )
-        sizes.push_back(bitmapSizes[s]);
+    if ( IsBenchmarkRunning() || !GetBenchmarkSettings(dirName, files, sizes, runCount, modes, backends) )
+        return;
 
-    benchmark.Setup(dirName, files, sizes);
+    const wxString resultsFileName = wxFileSelector("Select file name for the results",
+        dirName, "wxTestSVG Benchmark - " + dirName.AfterLast(wxFileName::GetPathSeparator()),
+        "txt", "Tab-separated text files (*.txt)|*.txt", wxFD_SAVE | wxFD_OVERWRITE_PROMPT, this);
+
+    if ( resultsFileName.empty() )
+        return;
 
-    wxString report, detailedReport;
+    wxTestSVGRasterizationBenchmark benchmark;
+
+    benchmark.Setup(dirName, files, sizes, modes, backends);
+
+    wxString report;
     bool result = false;
 
     {
-        wxBusyInfo info(wxString::Format("Benchmarking %zu files at %zu sizes (%ld runs each, %zu runs total), please wait...",
-            files.size(), sizes.size(), runCount, files.size() * sizes.size() * runCount), this);
-        result = benchmark.Run(runCount, report, detailedReport);
+        wxBusyInfo info(wxString::Format("Benchmarking %zu files at %zu sizes in %zu modes with %zu backends (%ld runs each, %zu runs total), "
+            "writing the results to '%s', please wait...",
+            files.size(), sizes.size(), modes.size(), backends.size(), runCount,
+            files.size() * sizes.size() * modes.size() * backends.size() * runCount, resultsFileName), this);
+        result = benchmark.RunStreaming(runCount, resultsFileName, report);
     }
 
     if ( result )
-        new wxTestSVGBenchmarkReportFrame(this, dirName, report, detailedReport);
+        new wxTestSVGBenchmarkReportFrame(this, dirName, report, wxString());
+    else
+        wxLogError("Couldn't write the results to '%s'.", resultsFileName);
+}
+
+bool wxTestSVG2Frame::IsBenchmarkRunning()
+{
+    if ( !m_benchmarkProgressFrame || !m_benchmarkProgressFrame->IsRunning() )
+        return false;
+
+    wxLogMessage("Another benchmark is running, stop it or wait until it finishes.");
+    m_benchmarkProgressFrame->Raise();
+    return true;
 }
 
 void wxTestSVG2Frame::OnChangeFolder(wxCommandEvent&)
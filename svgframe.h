@@ -10,7 +10,12 @@
 #ifndef TEST_SVG_FRAME_H_DEFINED
 #define TEST_SVG_FRAME_H_DEFINED
 
+#include <vector>
+
 #include <wx/wx.h>
+#include <wx/weakref.h>
+
+#include "svgbench.h"
 
 class wxFileCtrl;
 class wxFileCtrlEvent;
@@ -25,6 +30,8 @@ public:
 private:
     wxString m_lastSVGFolder;
     long     m_lastRunCount{25};
+    wxString m_lastModes; // comma-separated indices of wxTestSVGRasterizationBenchmark::Mode
+    wxString m_lastBackends; // comma-separated names of wxTestSVGRasterizationBenchmark::Backend
 
     wxSize               m_bitmapSize{128, 128};
 
@@ -33,7 +40,20 @@ private:
     wxBitmapBundlePanel* m_panelNano{nullptr};
     wxBitmapBundlePanel* m_panelLuna{nullptr};
 
+    wxWeakRef<wxTestSVGBenchmarkProgressFrame> m_benchmarkProgressFrame;
+
+    // only one benchmark can run at a time, so that they do not affect
+    // each other; shows a message when one is running
+    bool IsBenchmarkRunning();
+
+    // asks the user for the files, sizes, run count, and modes
+    bool GetBenchmarkSettings(wxString& dirName, wxArrayString& files,
+                              std::vector<wxSize>& sizes, long& runCount,
+                              std::vector<wxTestSVGRasterizationBenchmark::Mode>& modes,
+                              std::vector<wxTestSVGRasterizationBenchmark::Backend>& backends);
+
     void OnBenchmarkFolder(wxCommandEvent&);
+    void OnBenchmarkFolderToFile(wxCommandEvent&);
     void OnChangeFolder(wxCommandEvent&);
     void OnFileSelected(wxFileCtrlEvent& event);
     void OnFileActivated(wxFileCtrlEvent& event);
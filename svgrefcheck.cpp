@@ -0,0 +1,628 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgrefcheck.cpp
+// Purpose:     Checks that LunaSVG renders the same as a saved reference
+// Author:      PB
+// Created:     2024-01-18
+// Copyright:   (c) 2024 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+    Guards changes to LunaSVG rendering (e.g., optimizations in plutovg)
+    against changing the output.
+
+    With --update, every SVG file is rasterized at every size the same as
+    wxBitmapBundleImplLunaSVG does it and the hashes of the straight RGBA
+    pixels are saved to the reference folder, with --images also the images
+    themselves (as uncompressed PAM files, so that they can be read without
+    any image library).
+
+    Without --update, the files are rasterized again and compared with the
+    reference. By default, the comparison is exact, i.e., the hashes must
+    match. When the reference images were saved, --tolerance and --max-pixels
+    allow small differences: a pixel differs when any of its channels differs
+    by more than tolerance and the image matches when at most max-pixels
+    pixels differ. For every mismatch, a PNG image can be written to the diff
+    folder, with the reference, the new rendering and the differing pixels
+    in red side by side.
+
+    The exit status is 2 when any image does not match the reference.
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <lunasvg.h>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+#include "clicommon.h"
+
+namespace fs = std::filesystem;
+
+// ============================================================================
+// command line options
+// ============================================================================
+
+struct Options
+{
+    fs::path          dir{"SVGs"};
+    bool              recursive{false};
+    std::vector<Size> sizes{ {16, 16}, {24, 24}, {32, 32}, {48, 48}, {64, 64}, {128, 128} };
+    fs::path          referenceDir{"reference"};
+    bool              update{false};
+    bool              saveImages{false};
+    unsigned          tolerance{0};     // maximum difference of a channel, 0-255
+    size_t            maxPixelCount{0}; // maximum number of differing pixels
+    fs::path          diffDir;          // empty means no diff images
+    bool              showHelp{false};
+};
+
+// exit status when some images do not match the reference
+const int ExitMismatches = 2;
+
+static void PrintUsage(const char* programName)
+{
+    std::cerr
+        << "Usage: " << programName << " [options]\n"
+        << "  --dir <folder>        folder with SVG files (default: SVGs)\n"
+        << "  --recursive           include SVG files from subfolders\n"
+        << "  --sizes <list>        comma separated sizes, e.g. 16,24,32x16 (default: 16,24,32,48,64,128)\n"
+        << "  --reference <folder>  folder with the reference (default: reference)\n"
+        << "  --update              create the reference instead of checking against it\n"
+        << "  --images              with --update, save also the images needed for\n"
+        << "                        --tolerance, --max-pixels and --diff\n"
+        << "  --tolerance <value>   maximum difference of a pixel channel, 0-255 (default: 0)\n"
+        << "  --max-pixels <count>  maximum number of differing pixels in an image (default: 0)\n"
+        << "  --diff <folder>       write a PNG image for every mismatch to the folder\n"
+        << "  --help                show this help\n";
+}
+
+static bool ParseCommandLine(int argc, char** argv, Options& options)
+{
+    for ( int i = 1; i < argc; ++i )
+    {
+        const std::string arg = argv[i];
+        const bool        hasValue = i + 1 < argc;
+
+        if ( arg == "--help" || arg == "-h" )
+        {
+            options.showHelp = true;
+            return true;
+        }
+        else if ( arg == "--dir" && hasValue )
+            options.dir = argv[++i];
+        else if ( arg == "--recursive" )
+            options.recursive = true;
+        else if ( arg == "--sizes" && hasValue )
+        {
+            if ( !ParseSizes(argv[++i], options.sizes) )
+            {
+                std::cerr << "Invalid sizes '" << argv[i] << "'.\n";
+                return false;
+            }
+        }
+        else if ( arg == "--reference" && hasValue )
+            options.referenceDir = argv[++i];
+        else if ( arg == "--update" )
+            options.update = true;
+        else if ( arg == "--images" )
+            options.saveImages = true;
+        else if ( arg == "--tolerance" && hasValue )
+        {
+            char* end = nullptr;
+
+            options.tolerance = std::strtoul(argv[++i], &end, 10);
+            if ( end == argv[i] || *end != '\0' || options.tolerance > 255 )
+            {
+                std::cerr << "Invalid tolerance '" << argv[i] << "'.\n";
+                return false;
+            }
+        }
+        else if ( arg == "--max-pixels" && hasValue )
+        {
+            char* end = nullptr;
+
+            options.maxPixelCount = std::strtoul(argv[++i], &end, 10);
+            if ( end == argv[i] || *end != '\0' )
+            {
+                std::cerr << "Invalid pixel count '" << argv[i] << "'.\n";
+                return false;
+            }
+        }
+        else if ( arg == "--diff" && hasValue )
+            options.diffDir = argv[++i];
+        else
+        {
+            std::cerr << "Unknown or incomplete option '" << arg << "'.\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// ============================================================================
+// images
+// ============================================================================
+
+// straight RGBA pixels without any padding, empty if rendering failed
+struct Image
+{
+    std::uint32_t             width{0};
+    std::uint32_t             height{0};
+    std::vector<std::uint8_t> pixels;
+};
+
+static Image RenderImage(const std::string& data, const Size& size)
+{
+    Image image;
+
+    image.width = size.width;
+    image.height = size.height;
+
+    std::unique_ptr<lunasvg::Document> document = lunasvg::Document::loadFromData(data);
+
+    if ( !document )
+        return image;
+
+    const lunasvg::Bitmap bitmap = Rasterize(*document, size);
+
+    if ( !bitmap.valid() )
+        return image;
+
+    const size_t rowSize = size_t(bitmap.width()) * 4;
+
+    image.pixels.resize(rowSize * bitmap.height());
+    for ( std::uint32_t y = 0; y < bitmap.height(); ++y )
+        std::copy_n(bitmap.data() + size_t(y) * bitmap.stride(), rowSize, image.pixels.data() + y * rowSize);
+
+    return image;
+}
+
+// 64-bit FNV-1a
+static std::uint64_t CalcHash(const std::vector<std::uint8_t>& data)
+{
+    std::uint64_t hash = 14695981039346656037ULL;
+
+    for ( const std::uint8_t byte : data )
+    {
+        hash ^= byte;
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+static std::string HashToString(std::uint64_t hash)
+{
+    char text[17];
+
+    std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(hash));
+    return text;
+}
+
+// the file name is unique even when the SVG files come from subfolders
+static fs::path GetImagePath(const fs::path& dir, const std::string& name, const Size& size)
+{
+    std::string fileName = fs::path(name).replace_extension().generic_string();
+
+    std::replace(fileName.begin(), fileName.end(), '/', '_');
+    fileName += "_" + std::to_string(size.width) + "x" + std::to_string(size.height);
+
+    return dir / fileName;
+}
+
+static bool WritePAM(const fs::path& path, const Image& image)
+{
+    std::ofstream file(path, std::ios::binary);
+
+    file << "P7\nWIDTH " << image.width << "\nHEIGHT " << image.height
+         << "\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n";
+    file.write(reinterpret_cast<const char*>(image.pixels.data()), image.pixels.size());
+
+    return file.good();
+}
+
+// reads only the files written by WritePAM
+static bool ReadPAM(const fs::path& path, Image& image)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::string   line, key;
+    unsigned      value = 0, depth = 0, maxValue = 0;
+
+    image = Image();
+    if ( !std::getline(file, line) || line != "P7" )
+        return false;
+
+    while ( std::getline(file, line) && line != "ENDHDR" )
+    {
+        std::istringstream stream(line);
+
+        stream >> key >> value;
+        if ( key == "WIDTH" )
+            image.width = value;
+        else if ( key == "HEIGHT" )
+            image.height = value;
+        else if ( key == "DEPTH" )
+            depth = value;
+        else if ( key == "MAXVAL" )
+            maxValue = value;
+    }
+
+    if ( line != "ENDHDR" || depth != 4 || maxValue != 255 || image.width == 0 || image.height == 0 )
+        return false;
+
+    image.pixels.resize(size_t(image.width) * image.height * 4);
+    file.read(reinterpret_cast<char*>(image.pixels.data()), image.pixels.size());
+
+    return file.gcount() == static_cast<std::streamsize>(image.pixels.size());
+}
+
+// returns the number of pixels differing by more than tolerance in any channel,
+// the images must have the same size
+static size_t CountDifferentPixels(const Image& reference, const Image& image, unsigned tolerance,
+                                   std::vector<bool>* differs = nullptr)
+{
+    size_t count = 0;
+
+    if ( differs )
+        differs->assign(reference.pixels.size() / 4, false);
+
+    for ( size_t i = 0; i < reference.pixels.size(); i += 4 )
+    {
+        for ( size_t c = 0; c < 4; ++c )
+        {
+            if ( static_cast<unsigned>(std::abs(reference.pixels[i + c] - image.pixels[i + c])) > tolerance )
+            {
+                ++count;
+                if ( differs )
+                    (*differs)[i / 4] = true;
+                break;
+            }
+        }
+    }
+
+    return count;
+}
+
+/*
+    Writes the reference, the new image and their difference side by side.
+    The differing pixels are red, the others are the reference pixels
+    faded to gray, so that it can be seen where in the image they are.
+    A missing image (reference not saved or rendering failed) is transparent.
+*/
+static bool WriteDiffPNG(const fs::path& path, const Image& reference, const Image& image, unsigned tolerance)
+{
+    const std::uint32_t width = std::max(reference.width, image.width);
+    const std::uint32_t height = std::max(reference.height, image.height);
+    const bool          canCompare = !reference.pixels.empty() && !image.pixels.empty()
+                                     && reference.width == image.width && reference.height == image.height;
+    const size_t        stride = size_t(width) * 3 * 4;
+
+    std::vector<std::uint8_t> pixels(stride * height, 0);
+    std::vector<bool>         differs;
+
+    if ( canCompare )
+        CountDifferentPixels(reference, image, tolerance, &differs);
+
+    for ( std::uint32_t y = 0; y < height; ++y )
+    {
+        std::uint8_t* row = pixels.data() + y * stride;
+
+        for ( std::uint32_t x = 0; x < width; ++x )
+        {
+            if ( y < reference.height && x < reference.width && !reference.pixels.empty() )
+                std::copy_n(&reference.pixels[(size_t(y) * reference.width + x) * 4], 4, row + x * 4);
+
+            if ( y < image.height && x < image.width && !image.pixels.empty() )
+                std::copy_n(&image.pixels[(size_t(y) * image.width + x) * 4], 4, row + (width + x) * 4);
+
+            if ( !canCompare )
+                continue;
+
+            std::uint8_t*      out = row + (2 * width + x) * 4;
+            const size_t       index = size_t(y) * width + x;
+            const std::uint8_t* in = &reference.pixels[index * 4];
+
+            if ( differs[index] )
+            {
+                out[0] = 255; out[1] = 0; out[2] = 0; out[3] = 255;
+            }
+            else
+            {
+                const std::uint8_t gray = static_cast<std::uint8_t>((in[0] + in[1] + in[2]) / 3);
+
+                out[0] = out[1] = out[2] = gray;
+                out[3] = in[3] / 4;
+            }
+        }
+    }
+
+    return stbi_write_png(path.string().c_str(), int(width * 3), int(height), 4, pixels.data(), int(stride)) != 0;
+}
+
+// ============================================================================
+// reference
+// ============================================================================
+
+/*
+    The reference folder contains the text file hashes.txt and optionally
+    the folder images. hashes.txt starts with the signature line followed
+    by a line for every file and size: name, width, height and hash
+    (or '-' when rendering failed), separated with tabs.
+*/
+
+const char ReferenceSignature[] = "svgrefcheck reference 1";
+const char ReferenceHashesFileName[] = "hashes.txt";
+const char ReferenceImagesDirName[] = "images";
+const char FailedHash[] = "-";
+
+// key is name, width and height
+using ReferenceKey = std::tuple<std::string, std::uint32_t, std::uint32_t>;
+using ReferenceHashes = std::map<ReferenceKey, std::string>;
+
+static bool LoadReferenceHashes(const fs::path& path, ReferenceHashes& hashes)
+{
+    std::ifstream file(path);
+    std::string   line;
+
+    if ( !file )
+    {
+        std::cerr << "Couldn't open reference '" << path.string() << "'.\n";
+        return false;
+    }
+
+    if ( !std::getline(file, line) || line != ReferenceSignature )
+    {
+        std::cerr << "'" << path.string() << "' is not a svgrefcheck reference.\n";
+        return false;
+    }
+
+    hashes.clear();
+    while ( std::getline(file, line) )
+    {
+        std::istringstream stream(line);
+        std::string        name, hash;
+        std::uint32_t      width = 0, height = 0;
+
+        if ( line.empty() )
+            continue;
+
+        if ( !std::getline(stream, name, '\t') || !(stream >> width >> height >> hash) )
+        {
+            std::cerr << "Invalid line in reference '" << path.string() << "': '" << line << "'.\n";
+            return false;
+        }
+
+        hashes[ReferenceKey(name, width, height)] = hash;
+    }
+
+    return true;
+}
+
+static bool CreateFolder(const fs::path& dir)
+{
+    std::error_code ec;
+
+    fs::create_directories(dir, ec);
+    if ( ec )
+    {
+        std::cerr << "Couldn't create folder '" << dir.string() << "': " << ec.message() << ".\n";
+        return false;
+    }
+
+    return true;
+}
+
+// ============================================================================
+// update and check
+// ============================================================================
+
+static int Update(const Options& options, const std::vector<fs::path>& files)
+{
+    const fs::path imagesDir = options.referenceDir / ReferenceImagesDirName;
+
+    if ( !CreateFolder(options.referenceDir) || (options.saveImages && !CreateFolder(imagesDir)) )
+        return EXIT_FAILURE;
+
+    const fs::path hashesPath = options.referenceDir / ReferenceHashesFileName;
+    std::ofstream  hashesFile(hashesPath);
+
+    if ( !hashesFile )
+    {
+        std::cerr << "Couldn't create file '" << hashesPath.string() << "'.\n";
+        return EXIT_FAILURE;
+    }
+
+    size_t imageCount = 0, failedCount = 0;
+
+    hashesFile << ReferenceSignature << "\n";
+    for ( const auto& path : files )
+    {
+        const std::string name = path.lexically_relative(options.dir).generic_string();
+        std::string       data;
+
+        if ( !LoadFile(path, data) )
+        {
+            std::cerr << "Couldn't load file '" << path.string() << "', skipping it.\n";
+            continue;
+        }
+
+        for ( const auto& size : options.sizes )
+        {
+            const Image image = RenderImage(data, size);
+
+            if ( image.pixels.empty() )
+            {
+                ++failedCount;
+                hashesFile << name << "\t" << size.width << "\t" << size.height << "\t" << FailedHash << "\n";
+                continue;
+            }
+
+            hashesFile << name << "\t" << size.width << "\t" << size.height << "\t" << HashToString(CalcHash(image.pixels)) << "\n";
+
+            if ( options.saveImages
+                 && !WritePAM(GetImagePath(imagesDir, name, size).concat(".pam"), image) )
+            {
+                std::cerr << "Couldn't save image for '" << name << "'.\n";
+                return EXIT_FAILURE;
+            }
+
+            ++imageCount;
+        }
+    }
+
+    if ( !hashesFile.flush() )
+    {
+        std::cerr << "Couldn't write file '" << hashesPath.string() << "'.\n";
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Saved reference for " << imageCount << " images to '" << options.referenceDir.string() << "'";
+    if ( failedCount )
+        std::cout << ", " << failedCount << " failed to render";
+    std::cout << "\n";
+
+    return EXIT_SUCCESS;
+}
+
+static int Check(const Options& options, const std::vector<fs::path>& files)
+{
+    ReferenceHashes hashes;
+
+    if ( !LoadReferenceHashes(options.referenceDir / ReferenceHashesFileName, hashes) )
+        return EXIT_FAILURE;
+
+    if ( !options.diffDir.empty() && !CreateFolder(options.diffDir) )
+        return EXIT_FAILURE;
+
+    const bool     exact = options.tolerance == 0 && options.maxPixelCount == 0;
+    const fs::path imagesDir = options.referenceDir / ReferenceImagesDirName;
+
+    size_t matchCount = 0, toleratedCount = 0, mismatchCount = 0, notInReferenceCount = 0;
+
+    for ( const auto& path : files )
+    {
+        const std::string name = path.lexically_relative(options.dir).generic_string();
+        std::string       data;
+
+        if ( !LoadFile(path, data) )
+        {
+            std::cerr << "Couldn't load file '" << path.string() << "', skipping it.\n";
+            continue;
+        }
+
+        for ( const auto& size : options.sizes )
+        {
+            const auto it = hashes.find(ReferenceKey(name, size.width, size.height));
+
+            if ( it == hashes.end() )
+            {
+                ++notInReferenceCount;
+                continue;
+            }
+
+            const Image       image = RenderImage(data, size);
+            const std::string hash = image.pixels.empty() ? FailedHash : HashToString(CalcHash(image.pixels));
+
+            if ( hash == it->second )
+            {
+                ++matchCount;
+                continue;
+            }
+
+            // the hashes differ, compare the pixels if possible
+            Image  reference;
+            size_t differentCount = 0;
+            bool   haveReference = false;
+
+            if ( !image.pixels.empty() && it->second != FailedHash )
+            {
+                haveReference = ReadPAM(GetImagePath(imagesDir, name, size).concat(".pam"), reference)
+                                && reference.width == image.width && reference.height == image.height;
+                if ( haveReference )
+                    differentCount = CountDifferentPixels(reference, image, options.tolerance);
+            }
+
+            if ( haveReference && !exact && differentCount <= options.maxPixelCount )
+            {
+                ++toleratedCount;
+                continue;
+            }
+
+            ++mismatchCount;
+
+            std::cout << "MISMATCH " << name << " " << size.width << "x" << size.height;
+            if ( image.pixels.empty() )
+                std::cout << ": rendering failed";
+            else if ( it->second == FailedHash )
+                std::cout << ": rendering failed in reference";
+            else if ( haveReference )
+                std::cout << ": " << differentCount << " pixels differ";
+            else
+                std::cout << ": hash differs";
+            std::cout << "\n";
+
+            if ( !options.diffDir.empty()
+                 && !WriteDiffPNG(GetImagePath(options.diffDir, name, size).concat(".png"), reference, image, options.tolerance) )
+            {
+                std::cerr << "Couldn't write diff image for '" << name << "'.\n";
+            }
+        }
+    }
+
+    std::cout << "Checked " << matchCount + toleratedCount + mismatchCount << " images against '"
+              << options.referenceDir.string() << "': " << matchCount << " identical";
+    if ( !exact )
+        std::cout << ", " << toleratedCount << " within tolerance";
+    std::cout << ", " << mismatchCount << " mismatches";
+    if ( notInReferenceCount )
+        std::cout << ", " << notInReferenceCount << " not in reference";
+    std::cout << "\n";
+
+    return mismatchCount ? ExitMismatches : EXIT_SUCCESS;
+}
+
+// ============================================================================
+// main
+// ============================================================================
+
+int main(int argc, char** argv)
+{
+    Options options;
+
+    if ( !ParseCommandLine(argc, argv, options) )
+    {
+        PrintUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if ( options.showHelp )
+    {
+        PrintUsage(argv[0]);
+        return EXIT_SUCCESS;
+    }
+
+    const std::vector<fs::path> files = FindSVGFiles(options.dir, options.recursive);
+
+    if ( files.empty() )
+    {
+        std::cerr << "No SVG files found in folder '" << options.dir.string() << "'.\n";
+        return EXIT_FAILURE;
+    }
+
+    return options.update ? Update(options, files) : Check(options, files);
+}
@@ -0,0 +1,710 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        svgscaling.cpp
+// Purpose:     Measures how LunaSVG scales with the complexity of synthetic SVGs
+// Author:      PB
+// Created:     2024-01-18
+// Copyright:   (c) 2024 PB
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+    The real SVG files do not allow varying one dimension of complexity
+    at a time, so this tool generates them. Every parameter (number of paths,
+    segments per path, group nesting depth, number of opacity groups, gradient
+    stop count, clip path and mask nesting depth, dash array length and CSS
+    rule count) is swept over a list of values, while the others keep their
+    base values. For every generated SVG, parsing, layout and rendering
+    are timed separately and their medians of runs are reported.
+
+    For every parameter and phase, the growth exponent of the time between
+    the last two values is reported: 1 means the time grows linearly with
+    the parameter, 2 quadratically. As the time includes also the cost which
+    does not depend on the parameter, the exponent is rather underestimated,
+    so a phase with the exponent above the threshold is reported as
+    super-linear, e.g., CSS rule matching or group traversal.
+
+    With --chart, the times relative to the time for the first value are
+    plotted against every parameter to an SVG file, on logarithmic axes and
+    together with the linear growth, so that the slope of each line shows
+    its growth exponent; with --save-svgs, the generated files are saved, so that they can
+    be benchmarked also with svgbenchcli or in the GUI application.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <lunasvg.h>
+
+#include "clicommon.h"
+#include "svgchart.h"
+
+namespace fs = std::filesystem;
+
+// ============================================================================
+// synthetic SVG
+// ============================================================================
+
+struct Complexity
+{
+    size_t paths{32};
+    size_t segments{8};      // per path
+    size_t depth{1};         // nesting depth of plain groups around the paths
+    size_t opacityGroups{0}; // groups with opacity, the paths are distributed among them
+    size_t stops{2};         // of the gradient filling the paths, 0 means solid fill
+    size_t clips{0};         // nesting depth of groups with clip-path
+    size_t masks{0};         // nesting depth of groups with mask
+    size_t dashes{0};        // length of dash array of the path strokes, 0 means solid stroke
+    size_t rules{0};         // CSS rules, every path matches some
+};
+
+struct Parameter
+{
+    const char*         name;
+    size_t Complexity::* value;
+    const char*         description;
+    const char*         defaultValues;
+};
+
+const Parameter Parameters[] =
+{
+    { "paths",    &Complexity::paths,         "number of paths",              "8,16,32,64,128,256,512" },
+    { "segments", &Complexity::segments,      "segments per path",            "2,4,8,16,32,64,128,256" },
+    { "depth",    &Complexity::depth,         "group nesting depth",          "1,2,4,8,16,32,64" },
+    { "opacity",  &Complexity::opacityGroups, "number of opacity groups",     "1,2,4,8,16,32" },
+    { "stops",    &Complexity::stops,         "gradient stop count",          "2,4,8,16,32,64,128" },
+    { "clips",    &Complexity::clips,         "clip path nesting depth",      "1,2,4,8,16" },
+    { "masks",    &Complexity::masks,         "mask nesting depth",           "1,2,4,8,16" },
+    { "dashes",   &Complexity::dashes,        "dash array length",            "2,4,8,16,32,64,128" },
+    { "rules",    &Complexity::rules,         "CSS rule count",               "1,4,16,64,256,1024" },
+};
+
+static const Parameter* FindParameter(const std::string& name)
+{
+    for ( const auto& p : Parameters )
+    {
+        if ( name == p.name )
+            return &p;
+    }
+
+    return nullptr;
+}
+
+// the generated files must not depend on the standard library implementation,
+// hence a simple linear congruential generator
+class Random
+{
+public:
+    // returns a coordinate inside the 100x100 view box, with some margin
+    double Coordinate()
+    {
+        m_state = m_state * 1664525u + 1013904223u;
+        return 5 + 90 * (m_state >> 8) / static_cast<double>(1 << 24);
+    }
+
+private:
+    std::uint32_t m_state{1};
+};
+
+static std::string FormatCoordinate(double value)
+{
+    char buf[16];
+
+    std::snprintf(buf, sizeof(buf), "%.1f", value);
+    return buf;
+}
+
+static std::string GenerateSVG(const Complexity& c)
+{
+    static const char* const colors[] = { "#3465a4", "#cc0000", "#73d216", "#f57900", "#75507b", "#edd400" };
+    const size_t colorCount = sizeof(colors) / sizeof(colors[0]);
+
+    std::ostringstream svg;
+    Random             random;
+
+    svg << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"100\" height=\"100\" viewBox=\"0 0 100 100\">\n";
+
+    if ( c.rules )
+    {
+        // different selectors, some of them requiring to match the ancestors
+        static const char* const selectors[] = { ".r%zu", "path.r%zu", "g > .r%zu", "svg g .r%zu" };
+
+        svg << "<style>\n";
+        for ( size_t i = 0; i < c.rules; ++i )
+        {
+            char selector[64];
+
+            std::snprintf(selector, sizeof(selector), selectors[i % 4], i);
+            svg << selector << " { stroke-width: " << 0.5 + (i % 4) * 0.25 << "; }\n";
+        }
+        svg << "</style>\n";
+    }
+
+    svg << "<defs>\n";
+    if ( c.stops )
+    {
+        svg << "<linearGradient id=\"g\" x1=\"0\" y1=\"0\" x2=\"1\" y2=\"1\">\n";
+        for ( size_t i = 0; i < c.stops; ++i )
+        {
+            svg << "<stop offset=\"" << (c.stops > 1 ? static_cast<double>(i) / (c.stops - 1) : 0)
+                << "\" stop-color=\"" << colors[i % colorCount] << "\"/>\n";
+        }
+        svg << "</linearGradient>\n";
+    }
+    for ( size_t i = 0; i < c.clips; ++i )
+        svg << "<clipPath id=\"c" << i << "\"><circle cx=\"50\" cy=\"50\" r=\"" << 50 - i * 0.5 << "\"/></clipPath>\n";
+    for ( size_t i = 0; i < c.masks; ++i )
+    {
+        svg << "<mask id=\"m" << i << "\"><rect x=\"" << i * 0.5 << "\" y=\"0\" width=\"100\" height=\"100\" "
+               "fill=\"white\" fill-opacity=\"0.95\"/></mask>\n";
+    }
+    svg << "</defs>\n";
+
+    size_t groupCount = 0;
+
+    for ( size_t i = 0; i < c.clips; ++i, ++groupCount )
+        svg << "<g clip-path=\"url(#c" << i << ")\">\n";
+    for ( size_t i = 0; i < c.masks; ++i, ++groupCount )
+        svg << "<g mask=\"url(#m" << i << ")\">\n";
+    for ( size_t i = 0; i < c.depth; ++i, ++groupCount )
+        svg << "<g transform=\"translate(0.1 0.1)\">\n";
+
+    std::string dashArray;
+
+    for ( size_t i = 0; i < c.dashes; ++i )
+        dashArray += (i ? " " : "") + std::to_string(1 + i % 4);
+
+    // every opacity group gets at least one path
+    const size_t opacityGroupCount = std::min(c.opacityGroups, c.paths);
+
+    for ( size_t g = 0; g < std::max<size_t>(opacityGroupCount, 1); ++g )
+    {
+        if ( opacityGroupCount )
+            svg << "<g opacity=\"0.8\">\n";
+
+        for ( size_t p = g; p < c.paths; p += std::max<size_t>(opacityGroupCount, 1) )
+        {
+            svg << "<path";
+            if ( c.rules )
+                svg << " class=\"r" << p % c.rules << "\"";
+
+            svg << " d=\"M" << FormatCoordinate(random.Coordinate()) << " " << FormatCoordinate(random.Coordinate());
+            for ( size_t s = 0; s < c.segments; ++s )
+            {
+                // alternate lines and cubic curves
+                const size_t coordinateCount = s % 2 ? 6 : 2;
+
+                svg << (s % 2 ? " C" : " L");
+                for ( size_t i = 0; i < coordinateCount; ++i )
+                    svg << (i ? " " : "") << FormatCoordinate(random.Coordinate());
+            }
+            svg << "Z\"";
+
+            if ( c.stops )
+                svg << " fill=\"url(#g)\"";
+            else
+                svg << " fill=\"" << colors[p % colorCount] << "\"";
+            svg << " fill-opacity=\"0.5\" stroke=\"#2e3436\"";
+            if ( !dashArray.empty() )
+                svg << " stroke-dasharray=\"" << dashArray << "\"";
+            svg << "/>\n";
+        }
+
+        if ( opacityGroupCount )
+            svg << "</g>\n";
+    }
+
+    for ( size_t i = 0; i < groupCount; ++i )
+        svg << "</g>\n";
+    svg << "</svg>\n";
+
+    return svg.str();
+}
+
+// ============================================================================
+// command line options
+// ============================================================================
+
+struct Sweep
+{
+    const Parameter*    parameter;
+    std::vector<size_t> values; // ascending
+};
+
+struct Options
+{
+    Size               size{128, 128};
+    size_t             runCount{10};
+    std::vector<Sweep> sweeps; // empty means all parameters with their default values
+    double             threshold{1.2};
+    std::string        csvPath; // "-" means stdout
+    fs::path           chartPath;
+    fs::path           svgDir;
+    bool               showHelp{false};
+};
+
+static void PrintUsage(const char* programName)
+{
+    std::cerr
+        << "Usage: " << programName << " [options]\n"
+        << "  --size <size>         bitmap size, e.g. 128 or 128x64 (default: 128)\n"
+        << "  --runs <count>        number of runs for each generated SVG (default: 10)\n"
+        << "  --sweep <name[=list]> sweep only the parameter, over the comma separated values if given;\n"
+        << "                        can be used more times (default: all parameters)\n"
+        << "  --threshold <value>   growth exponent reported as super-linear (default: 1.2)\n"
+        << "  --csv <file>          write results as CSV, '-' for standard output\n"
+        << "  --chart <file>        plot the times against the parameters to an SVG file\n"
+        << "  --save-svgs <folder>  save the generated SVG files to the folder\n"
+        << "  --help                show this help\n"
+        << "Parameters (base value, default values):\n";
+
+    const Complexity base;
+
+    for ( const auto& p : Parameters )
+    {
+        char line[128];
+
+        std::snprintf(line, sizeof(line), "  %-10s %-26s (%zu; %s)\n", p.name, p.description,
+                      base.*p.value, p.defaultValues);
+        std::cerr << line;
+    }
+}
+
+// parses comma separated positive counts, sorted ascending
+static bool ParseValues(const std::string& text, std::vector<size_t>& values)
+{
+    std::istringstream stream(text);
+    std::string        item;
+
+    values.clear();
+    while ( std::getline(stream, item, ',') )
+    {
+        char* end = nullptr;
+        const unsigned long value = std::strtoul(item.c_str(), &end, 10);
+
+        if ( end == item.c_str() || *end != '\0' || value == 0 )
+            return false;
+        values.push_back(value);
+    }
+
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+
+    return !values.empty();
+}
+
+static bool ParseCommandLine(int argc, char** argv, Options& options)
+{
+    for ( int i = 1; i < argc; ++i )
+    {
+        const std::string arg = argv[i];
+        const bool        hasValue = i + 1 < argc;
+
+        if ( arg == "--help" || arg == "-h" )
+        {
+            options.showHelp = true;
+            return true;
+        }
+        else if ( arg == "--size" && hasValue )
+        {
+            std::vector<Size> sizes;
+
+            if ( !ParseSizes(argv[++i], sizes) || sizes.size() != 1 )
+            {
+                std::cerr << "Invalid size '" << argv[i] << "'.\n";
+                return false;
+            }
+            options.size = sizes[0];
+        }
+        else if ( arg == "--runs" && hasValue )
+        {
+            char* end = nullptr;
+
+            options.runCount = std::strtoul(argv[++i], &end, 10);
+            if ( end == argv[i] || *end != '\0' || options.runCount == 0 )
+            {
+                std::cerr << "Invalid run count '" << argv[i] << "'.\n";
+                return false;
+            }
+        }
+        else if ( arg == "--sweep" && hasValue )
+        {
+            const std::string text = argv[++i];
+            const size_t      equals = text.find('=');
+            Sweep             sweep;
+
+            sweep.parameter = FindParameter(text.substr(0, equals));
+            if ( !sweep.parameter )
+            {
+                std::cerr << "Unknown parameter '" << text.substr(0, equals) << "'.\n";
+                return false;
+            }
+
+            if ( !ParseValues(equals == std::string::npos ? sweep.parameter->defaultValues : text.substr(equals + 1),
+                              sweep.values) )
+            {
+                std::cerr << "Invalid values '" << text.substr(equals + 1) << "'.\n";
+                return false;
+            }
+            options.sweeps.push_back(sweep);
+        }
+        else if ( arg == "--threshold" && hasValue )
+        {
+            char* end = nullptr;
+
+            options.threshold = std::strtod(argv[++i], &end);
+            if ( end == argv[i] || *end != '\0' || options.threshold <= 0 )
+            {
+                std::cerr << "Invalid threshold '" << argv[i] << "'.\n";
+                return false;
+            }
+        }
+        else if ( arg == "--csv" && hasValue )
+            options.csvPath = argv[++i];
+        else if ( arg == "--chart" && hasValue )
+            options.chartPath = argv[++i];
+        else if ( arg == "--save-svgs" && hasValue )
+            options.svgDir = argv[++i];
+        else
+        {
+            std::cerr << "Unknown or incomplete option '" << arg << "'.\n";
+            return false;
+        }
+    }
+
+    if ( options.sweeps.empty() )
+    {
+        for ( const auto& p : Parameters )
+        {
+            Sweep sweep;
+
+            sweep.parameter = &p;
+            ParseValues(p.defaultValues, sweep.values);
+            options.sweeps.push_back(sweep);
+        }
+    }
+
+    return true;
+}
+
+// ============================================================================
+// benchmark
+// ============================================================================
+
+enum Phase
+{
+    Phase_Parse,
+    Phase_Layout,
+    Phase_Render,
+
+    Phase_Count
+};
+
+const char* const PhaseNames[Phase_Count] = { "parse", "layout", "render" };
+
+// medians of the phases in nanoseconds
+struct PointResult
+{
+    size_t       value{0};
+    std::int64_t times[Phase_Count]{};
+
+    std::int64_t GetTotal() const { return times[Phase_Parse] + times[Phase_Layout] + times[Phase_Render]; }
+};
+
+struct SweepResult
+{
+    const Parameter*         parameter;
+    std::vector<PointResult> points;
+
+    // of the phase time between the last two values, 0 if not available
+    double GetGrowthExponent(Phase phase) const
+    {
+        if ( points.size() < 2 )
+            return 0;
+
+        const PointResult& a = points[points.size() - 2];
+        const PointResult& b = points.back();
+
+        if ( a.times[phase] <= 0 || b.times[phase] <= 0 )
+            return 0;
+
+        return std::log(static_cast<double>(b.times[phase]) / a.times[phase])
+               / std::log(static_cast<double>(b.value) / a.value);
+    }
+};
+
+static std::int64_t CalcMedian(std::vector<std::int64_t> times)
+{
+    std::sort(times.begin(), times.end());
+
+    const size_t count = times.size();
+
+    return count % 2 ? times[count / 2] : (times[count / 2 - 1] + times[count / 2]) / 2;
+}
+
+static bool MeasurePoint(const Options& options, const std::string& data, PointResult& result)
+{
+    using Clock = std::chrono::steady_clock;
+
+    const auto elapsed = [](Clock::time_point start)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    };
+
+    std::vector<std::int64_t> times[Phase_Count];
+
+    // the first run may include allocating caches and such
+    for ( size_t run = 0; run <= options.runCount; ++run )
+    {
+        auto start = Clock::now();
+        std::unique_ptr<lunasvg::Document> document = lunasvg::Document::parseFromData(data.data(), data.size());
+        const std::int64_t parseTime = elapsed(start);
+
+        if ( !document )
+            return false;
+
+        start = Clock::now();
+        document->updateLayout();
+        const std::int64_t layoutTime = elapsed(start);
+
+        start = Clock::now();
+        const bool rendered = Rasterize(*document, options.size).valid();
+        const std::int64_t renderTime = elapsed(start);
+
+        if ( !rendered )
+            return false;
+
+        if ( run > 0 )
+        {
+            times[Phase_Parse].push_back(parseTime);
+            times[Phase_Layout].push_back(layoutTime);
+            times[Phase_Render].push_back(renderTime);
+        }
+    }
+
+    for ( size_t p = 0; p < Phase_Count; ++p )
+        result.times[p] = CalcMedian(times[p]);
+
+    return true;
+}
+
+static bool RunSweep(const Options& options, const Sweep& sweep, SweepResult& result)
+{
+    result.parameter = sweep.parameter;
+
+    for ( const size_t value : sweep.values )
+    {
+        Complexity complexity;
+
+        complexity.*sweep.parameter->value = value;
+
+        const std::string data = GenerateSVG(complexity);
+        const std::string name = std::string(sweep.parameter->name) + "-" + std::to_string(value);
+
+        if ( !options.svgDir.empty() )
+        {
+            std::ofstream file(options.svgDir / (name + ".svg"), std::ios::binary);
+
+            if ( !file.write(data.data(), data.size()) )
+            {
+                std::cerr << "Couldn't save file '" << (options.svgDir / (name + ".svg")).string() << "'.\n";
+                return false;
+            }
+        }
+
+        PointResult point;
+
+        point.value = value;
+        if ( !MeasurePoint(options, data, point) )
+        {
+            std::cerr << "Couldn't rasterize generated SVG '" << name << "'.\n";
+            return false;
+        }
+        result.points.push_back(point);
+    }
+
+    return true;
+}
+
+// ============================================================================
+// output
+// ============================================================================
+
+static void WriteSummary(std::ostream& out, const Options& options, const std::vector<SweepResult>& results)
+{
+    char line[256];
+
+    for ( const auto& r : results )
+    {
+        out << r.parameter->name << " (" << r.parameter->description << "), medians in microseconds:\n";
+        std::snprintf(line, sizeof(line), "  %8s %10s %10s %10s %10s\n", "value", "parse", "layout", "render", "total");
+        out << line;
+
+        for ( const auto& p : r.points )
+        {
+            std::snprintf(line, sizeof(line), "  %8zu %10.1f %10.1f %10.1f %10.1f\n", p.value,
+                          p.times[Phase_Parse] / 1000.0, p.times[Phase_Layout] / 1000.0,
+                          p.times[Phase_Render] / 1000.0, p.GetTotal() / 1000.0);
+            out << line;
+        }
+
+        out << "  growth exponents:";
+        for ( size_t ph = 0; ph < Phase_Count; ++ph )
+        {
+            const double exponent = r.GetGrowthExponent(static_cast<Phase>(ph));
+
+            std::snprintf(line, sizeof(line), " %s %.2f%s", PhaseNames[ph], exponent,
+                          exponent > options.threshold ? " (super-linear)" : "");
+            out << (ph ? "," : "") << line;
+        }
+        out << "\n\n";
+    }
+}
+
+static bool WriteCSV(std::ostream& out, const std::vector<SweepResult>& results)
+{
+    out << "parameter,value,parse_ns,layout_ns,render_ns,total_ns\n";
+
+    for ( const auto& r : results )
+    {
+        for ( const auto& p : r.points )
+        {
+            out << r.parameter->name << "," << p.value << "," << p.times[Phase_Parse] << ","
+                << p.times[Phase_Layout] << "," << p.times[Phase_Render] << "," << p.GetTotal() << "\n";
+        }
+    }
+
+    return static_cast<bool>(out);
+}
+
+static bool WriteChart(const Options& options, const std::vector<SweepResult>& results)
+{
+    static const char* const phaseColors[Phase_Count] = { "#3465a4", "#73d216", "#f57900" };
+
+    std::vector<Chart> charts;
+
+    for ( const auto& r : results )
+    {
+        Chart chart;
+
+        chart.title = r.parameter->description;
+        chart.xLabel = r.parameter->name;
+        chart.yLabel = "time relative to the first value";
+        chart.logX = true;
+        chart.logY = true;
+
+        // the phases take very different times, relative times show how they scale
+        ChartSeries linear{"linear", "#babdb6", {}};
+
+        for ( size_t p = 0; p < Phase_Count; ++p )
+            chart.series.push_back({PhaseNames[p], phaseColors[p], {}});
+
+        for ( const auto& p : r.points )
+        {
+            const PointResult& first = r.points.front();
+
+            chart.x.push_back(static_cast<double>(p.value));
+            for ( size_t ph = 0; ph < Phase_Count; ++ph )
+            {
+                chart.series[ph].values.push_back(first.times[ph] > 0
+                                                  ? static_cast<double>(p.times[ph]) / first.times[ph] : 0);
+            }
+            linear.values.push_back(static_cast<double>(p.value) / first.value);
+        }
+        chart.series.push_back(linear);
+
+        charts.push_back(chart);
+    }
+
+    char title[128];
+
+    std::snprintf(title, sizeof(title), "LunaSVG scaling with synthetic SVG complexity (%ux%u, median of %zu runs)",
+                  options.size.width, options.size.height, options.runCount);
+
+    return WriteChartsSVG(options.chartPath.string(), title, charts, 3);
+}
+
+// ============================================================================
+// main
+// ============================================================================
+
+int main(int argc, char** argv)
+{
+    Options options;
+
+    if ( !ParseCommandLine(argc, argv, options) )
+    {
+        PrintUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if ( options.showHelp )
+    {
+        PrintUsage(argv[0]);
+        return EXIT_SUCCESS;
+    }
+
+    if ( !options.svgDir.empty() )
+    {
+        std::error_code ec;
+
+        fs::create_directories(options.svgDir, ec);
+        if ( ec )
+        {
+            std::cerr << "Couldn't create folder '" << options.svgDir.string() << "'.\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<SweepResult> results;
+
+    for ( const auto& sweep : options.sweeps )
+    {
+        SweepResult result;
+
+        if ( !RunSweep(options, sweep, result) )
+            return EXIT_FAILURE;
+        results.push_back(result);
+    }
+
+    // keep the standard output clean for the CSV
+    WriteSummary(options.csvPath == "-" ? std::cerr : std::cout, options, results);
+
+    if ( !options.csvPath.empty() )
+    {
+        bool written = false;
+
+        if ( options.csvPath == "-" )
+            written = WriteCSV(std::cout, results);
+        else
+        {
+            std::ofstream file(options.csvPath);
+
+            written = file && WriteCSV(file, results);
+        }
+
+        if ( !written )
+        {
+            std::cerr << "Couldn't write CSV to '" << options.csvPath << "'.\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    if ( !options.chartPath.empty() && !WriteChart(options, results) )
+    {
+        std::cerr << "Couldn't write chart to '" << options.chartPath.string() << "'.\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}